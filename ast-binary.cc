@@ -0,0 +1,719 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////////
+//
+//  ast-binary.cc
+//
+//  Writing the abstract syntax tree in the binary form of ast-binary.h,
+//  and reading it back.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include <stdlib.h>
+#include <string.h>
+#include "cool-io.h"
+#include "cool-lex.h"
+#include "ast-binary.h"
+#include "tree-walk.h"
+
+static void put_varint(std::string &s, unsigned long v)
+{
+  for (; v >= 0x80; v >>= 7)
+    s += (char) (v | 0x80);
+  s += (char) v;
+}
+
+void Ast_Writer::node(Ast_Kind kind, tree_node *t)
+{
+  int l = t->get_line_number();
+  long d = (long) l - line;
+  body += (char) kind;
+  put_varint(body, ((unsigned long) d << 1) ^ (unsigned long) (d >> 63));
+  line = l;
+}
+
+void Ast_Writer::symbol(Ast_Table table, Symbol s)
+{
+  if (s == NULL) {
+    body += (char) 0;
+    return;
+  }
+  std::unordered_map<Symbol, unsigned>::iterator i = index.find(s);
+  if (i == index.end()) {
+    unsigned n = index.size();
+    i = index.insert(std::make_pair(s, n)).first;
+    symbols += (char) table;
+    put_varint(symbols, s->get_len());
+    symbols.append(s->get_string(), s->get_len());
+    symbols += '\0';
+  }
+  put_varint(body, i->second + 1);
+}
+
+void Ast_Writer::count(int n)
+{
+  put_varint(body, n);
+}
+
+void Ast_Writer::boolean(Boolean b)
+{
+  body += (char) b;
+}
+
+void Ast_Writer::finish(std::string *out)
+{
+  *out = AST_MAGIC;
+  put_varint(*out, AST_FORMAT_VERSION);
+  put_varint(*out, index.size());
+  *out += symbols;
+  *out += body;
+}
+
+//
+// Writing is a walk of the tree (tree-walk.h), in which each node writes
+// its fields in the parts around its subtrees.
+//
+
+struct Ast_Write_Walk {
+  Ast_Writer &w;
+  Ast_Write_Walk(Ast_Writer &writer) : w(writer) { }
+  int part(tree_node *t, int i, int) { t->write_ast_part(w, i); return 0; }
+};
+
+void write_ast(Program p, std::string *out)
+{
+  Ast_Writer w;
+  Ast_Write_Walk walk(w);
+  walk_tree(p, walk, 0);
+  w.finish(out);
+}
+
+void write_ast(Classes c, std::string *out)
+{
+  Ast_Writer w;
+  Ast_Write_Walk walk(w);
+  w.boolean(false);             // not a program
+  walk_tree(c, walk, 0);
+  w.finish(out);
+}
+
+void tree_node::write_ast_part(Ast_Writer &w, int i)
+{
+  if (i == 0)                   // a list: its length, then the elements
+    w.count(children());
+}
+
+//
+// The write_ast_part method of each kind of node.
+//
+
+void program_class::write_ast_part(Ast_Writer &w, int i)
+{
+  if (i == 0)
+    w.node(AST_PROGRAM, this);
+}
+
+void class__class::write_ast_part(Ast_Writer &w, int i)
+{
+  if (i == 0) {
+    w.node(AST_CLASS, this);
+    w.symbol(AST_ID, name);
+    w.symbol(AST_ID, parent);
+  } else {                      // after the features
+    w.symbol(AST_STR, filename);
+  }
+}
+
+void method_class::write_ast_part(Ast_Writer &w, int i)
+{
+  if (i == 0) {
+    w.node(AST_METHOD, this);
+    w.symbol(AST_ID, name);
+  } else if (i == 1) {          // after the formals
+    w.symbol(AST_ID, return_type);
+  }
+}
+
+void attr_class::write_ast_part(Ast_Writer &w, int i)
+{
+  if (i == 0) {
+    w.node(AST_ATTR, this);
+    w.symbol(AST_ID, name);
+    w.symbol(AST_ID, type_decl);
+  }
+}
+
+void formal_class::write_ast_part(Ast_Writer &w, int)
+{
+  w.node(AST_FORMAL, this);
+  w.symbol(AST_ID, name);
+  w.symbol(AST_ID, type_decl);
+}
+
+void branch_class::write_ast_part(Ast_Writer &w, int i)
+{
+  if (i == 0) {
+    w.node(AST_BRANCH, this);
+    w.symbol(AST_ID, name);
+    w.symbol(AST_ID, type_decl);
+  }
+}
+
+void assign_class::write_ast_part(Ast_Writer &w, int i)
+{
+  if (i == 0) {
+    w.node(AST_ASSIGN, this);
+    w.symbol(AST_ID, type);
+    w.symbol(AST_ID, name);
+  }
+}
+
+void static_dispatch_class::write_ast_part(Ast_Writer &w, int i)
+{
+  if (i == 0) {
+    w.node(AST_STATIC_DISPATCH, this);
+    w.symbol(AST_ID, type);
+  } else if (i == 1) {          // after the expr
+    w.symbol(AST_ID, type_name);
+    w.symbol(AST_ID, name);
+  }
+}
+
+void dispatch_class::write_ast_part(Ast_Writer &w, int i)
+{
+  if (i == 0) {
+    w.node(AST_DISPATCH, this);
+    w.symbol(AST_ID, type);
+  } else if (i == 1) {          // after the expr
+    w.symbol(AST_ID, name);
+  }
+}
+
+void let_class::write_ast_part(Ast_Writer &w, int i)
+{
+  if (i == 0) {
+    w.node(AST_LET, this);
+    w.symbol(AST_ID, type);
+    w.symbol(AST_ID, identifier);
+    w.symbol(AST_ID, type_decl);
+  }
+}
+
+// Expressions whose fields are all subtrees.
+#define WRITE_SUBTREES(cls, kind)               \
+void cls::write_ast_part(Ast_Writer &w, int i)  \
+{                                               \
+  if (i == 0) {                                 \
+    w.node(kind, this);                         \
+    w.symbol(AST_ID, type);                     \
+  }                                             \
+}
+
+WRITE_SUBTREES(cond_class, AST_COND)
+WRITE_SUBTREES(loop_class, AST_LOOP)
+WRITE_SUBTREES(typcase_class, AST_TYPCASE)
+WRITE_SUBTREES(block_class, AST_BLOCK)
+WRITE_SUBTREES(plus_class, AST_PLUS)
+WRITE_SUBTREES(sub_class, AST_SUB)
+WRITE_SUBTREES(mul_class, AST_MUL)
+WRITE_SUBTREES(divide_class, AST_DIVIDE)
+WRITE_SUBTREES(neg_class, AST_NEG)
+WRITE_SUBTREES(lt_class, AST_LT)
+WRITE_SUBTREES(eq_class, AST_EQ)
+WRITE_SUBTREES(leq_class, AST_LEQ)
+WRITE_SUBTREES(comp_class, AST_COMP)
+WRITE_SUBTREES(isvoid_class, AST_ISVOID)
+
+void int_const_class::write_ast_part(Ast_Writer &w, int)
+{
+  w.node(AST_INT_CONST, this);
+  w.symbol(AST_ID, type);
+  w.symbol(AST_INT, token);
+}
+
+void bool_const_class::write_ast_part(Ast_Writer &w, int)
+{
+  w.node(AST_BOOL_CONST, this);
+  w.symbol(AST_ID, type);
+  w.boolean(val);
+}
+
+void string_const_class::write_ast_part(Ast_Writer &w, int)
+{
+  w.node(AST_STRING_CONST, this);
+  w.symbol(AST_ID, type);
+  w.symbol(AST_STR, token);
+}
+
+void new__class::write_ast_part(Ast_Writer &w, int)
+{
+  w.node(AST_NEW, this);
+  w.symbol(AST_ID, type);
+  w.symbol(AST_ID, type_name);
+}
+
+void no_expr_class::write_ast_part(Ast_Writer &w, int)
+{
+  w.node(AST_NO_EXPR, this);
+  w.symbol(AST_ID, type);
+}
+
+void object_class::write_ast_part(Ast_Writer &w, int)
+{
+  w.node(AST_OBJECT, this);
+  w.symbol(AST_ID, type);
+  w.symbol(AST_ID, name);
+}
+
+//////////////////////////////////////////////////////////////////////////
+//
+//  Reading
+//
+//  The reader checks every byte it takes against the end of the buffer
+//  and every kind against the phylum expected where it is found.  Once
+//  anything is wrong, bad is set and no more of the tree is read; the
+//  nodes made by then are left for the caller to throw away.
+//
+//////////////////////////////////////////////////////////////////////////
+
+struct Ast_Reader {
+  const unsigned char *pos, *end;
+  std::vector<Symbol> symbols;
+  Symbol filename;              // for each class, if not NULL
+  int line;
+  bool bad;
+
+  unsigned long varint();
+  int byte();
+  Symbol symbol();
+  int count();
+  int node();                   // the kind of the next node; sets line
+  bool read_symbols();
+};
+
+int Ast_Reader::byte()
+{
+  if (pos == end) {
+    bad = true;
+    return 0;
+  }
+  return *pos++;
+}
+
+unsigned long Ast_Reader::varint()
+{
+  unsigned long v = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    int b = byte();
+    v |= (unsigned long) (b & 0x7f) << shift;
+    if (!(b & 0x80))
+      return v;
+  }
+  bad = true;
+  return 0;
+}
+
+Symbol Ast_Reader::symbol()
+{
+  unsigned long i = varint();
+  if (i == 0)
+    return NULL;
+  if (i > symbols.size()) {
+    bad = true;
+    return NULL;
+  }
+  return symbols[i - 1];
+}
+
+int Ast_Reader::count()
+{
+  unsigned long n = varint();
+  // Every element takes at least two bytes.
+  if (n > (unsigned long) (end - pos) / 2) {
+    bad = true;
+    return 0;
+  }
+  return n;
+}
+
+int Ast_Reader::node()
+{
+  int kind = byte();
+  unsigned long d = varint();
+  line += (int) (d & 1 ? ~(d >> 1) : d >> 1);
+  return kind;
+}
+
+bool Ast_Reader::read_symbols()
+{
+  if (end - pos < 4 || memcmp(pos, AST_MAGIC, 4) != 0)
+    return false;
+  pos += 4;
+  if (varint() != AST_FORMAT_VERSION)
+    return false;
+
+  unsigned long n = varint();
+  if (n > (unsigned long) (end - pos) / 3)
+    return false;
+  symbols.reserve(n);
+  for (unsigned long i = 0; i < n && !bad; i++) {
+    int table = byte();
+    unsigned long len = varint();
+    if (bad || len >= (unsigned long) (end - pos) || pos[len] != '\0' ||
+        memchr(pos, '\0', len) != NULL)
+      return false;
+    const char *s = (const char *) pos;
+    pos += len + 1;
+    switch (table) {
+    case AST_ID:  symbols.push_back(idtable.add_string(s, len)); break;
+    case AST_INT: symbols.push_back(inttable.add_string(s, len)); break;
+    case AST_STR: symbols.push_back(stringtable.add_string(s, len)); break;
+    default:      return false;
+    }
+  }
+  return !bad;
+}
+
+//
+// The fields of each kind of node, in the order they are written after
+// its kind, its line and (for an expression) its type: 's' a symbol, 'b'
+// a Boolean, a capital a node of a phylum, and '*' followed by a phylum
+// a list of them.  The phyla are P program, K class, F feature, f
+// formal, C case and E expression.
+//
+static const char *const layouts[] = {
+  NULL,
+  "*K",                         // program: classes
+  "ss*Fs",                      // class_: name, parent, features, filename
+  "s*fsE",                      // method: name, formals, return_type, expr
+  "ssE",                        // attr: name, type_decl, init
+  "ss",                         // formal: name, type_decl
+  "ssE",                        // branch: name, type_decl, expr
+  "sE",                         // assign: name, expr
+  "Ess*E",                      // static_dispatch: expr, type_name, name, actual
+  "Es*E",                       // dispatch: expr, name, actual
+  "EEE",                        // cond: pred, then_exp, else_exp
+  "EE",                         // loop: pred, body
+  "E*C",                        // typcase: expr, cases
+  "*E",                         // block: body
+  "ssEE",                       // let: identifier, type_decl, init, body
+  "EE", "EE", "EE", "EE",       // plus, sub, mul, divide: e1, e2
+  "E",                          // neg: e1
+  "EE", "EE", "EE",             // lt, eq, leq: e1, e2
+  "E",                          // comp: e1
+  "s",                          // int_const: token
+  "b",                          // bool_const: val
+  "s",                          // string_const: token
+  "s",                          // new_: type_name
+  "E",                          // isvoid: e1
+  "",                           // no_expr
+  "s",                          // object: name
+};
+
+static char phylum(int kind)
+{
+  switch (kind) {
+  case AST_PROGRAM: return 'P';
+  case AST_CLASS:   return 'K';
+  case AST_METHOD:
+  case AST_ATTR:    return 'F';
+  case AST_FORMAL:  return 'f';
+  case AST_BRANCH:  return 'C';
+  default:
+    return kind >= AST_ASSIGN && kind <= AST_OBJECT ? 'E' : 0;
+  }
+}
+
+//
+// A node being read, or (at the bottom of the reader's stack) the field
+// the whole record holds.  Its subtrees, once read, wait on a stack of
+// their own until the node is made.
+//
+struct Read_Frame {
+  int kind;
+  int line;
+  Symbol type;
+  const char *field;            // the next field of its layout
+  Symbol syms[3];
+  int nsyms;
+  Boolean val;
+  size_t subtrees;              // where its subtrees start
+  int left;                     // elements of the list at field still to
+                                //   read, or -1 if not in a list
+  size_t elems;                 // where the elements of that list start
+};
+
+static tree_node *make_list(char elem, tree_node **e, int n)
+{
+  switch (elem) {
+  case 'K': {
+    Classes l = nil_Classes();
+    for (int i = 0; i < n; i++)
+      l = append_Classes(l, single_Classes((Class_) e[i]));
+    return l;
+  }
+  case 'F': {
+    Features l = nil_Features();
+    for (int i = 0; i < n; i++)
+      l = append_Features(l, single_Features((Feature) e[i]));
+    return l;
+  }
+  case 'f': {
+    Formals l = nil_Formals();
+    for (int i = 0; i < n; i++)
+      l = append_Formals(l, single_Formals((Formal) e[i]));
+    return l;
+  }
+  case 'C': {
+    Cases l = nil_Cases();
+    for (int i = 0; i < n; i++)
+      l = append_Cases(l, single_Cases((Case) e[i]));
+    return l;
+  }
+  default: {
+    Expressions l = nil_Expressions();
+    for (int i = 0; i < n; i++)
+      l = append_Expressions(l, single_Expressions((Expression) e[i]));
+    return l;
+  }
+  }
+}
+
+static tree_node *make_node(Ast_Reader &r, Read_Frame &f, tree_node **t)
+{
+  Symbol *s = f.syms;
+  Expression e1 = (Expression) t[0], e2 = (Expression) t[1];
+  Expression e;
+
+  node_lineno = f.line;
+  switch (f.kind) {
+  case AST_PROGRAM:
+    return program((Classes) t[0]);
+  case AST_CLASS:
+    return class_(s[0], s[1], (Features) t[0], r.filename ? r.filename : s[2]);
+  case AST_METHOD:
+    return method(s[0], (Formals) t[0], s[1], e2);
+  case AST_ATTR:
+    return attr(s[0], s[1], e1);
+  case AST_FORMAL:
+    return formal(s[0], s[1]);
+  case AST_BRANCH:
+    return branch(s[0], s[1], e1);
+  case AST_ASSIGN:          e = assign(s[0], e1); break;
+  case AST_STATIC_DISPATCH: e = static_dispatch(e1, s[0], s[1],
+                                                (Expressions) t[1]); break;
+  case AST_DISPATCH:        e = dispatch(e1, s[0], (Expressions) t[1]); break;
+  case AST_COND:            e = cond(e1, e2, (Expression) t[2]); break;
+  case AST_LOOP:            e = loop(e1, e2); break;
+  case AST_TYPCASE:         e = typcase(e1, (Cases) t[1]); break;
+  case AST_BLOCK:           e = block((Expressions) t[0]); break;
+  case AST_LET:             e = let(s[0], s[1], e1, e2); break;
+  case AST_PLUS:            e = plus(e1, e2); break;
+  case AST_SUB:             e = sub(e1, e2); break;
+  case AST_MUL:             e = mul(e1, e2); break;
+  case AST_DIVIDE:          e = divide(e1, e2); break;
+  case AST_NEG:             e = neg(e1); break;
+  case AST_LT:              e = lt(e1, e2); break;
+  case AST_EQ:              e = eq(e1, e2); break;
+  case AST_LEQ:             e = leq(e1, e2); break;
+  case AST_COMP:            e = comp(e1); break;
+  case AST_INT_CONST:       e = int_const(s[0]); break;
+  case AST_BOOL_CONST:      e = bool_const(f.val); break;
+  case AST_STRING_CONST:    e = string_const(s[0]); break;
+  case AST_NEW:             e = new_(s[0]); break;
+  case AST_ISVOID:          e = isvoid(e1); break;
+  case AST_NO_EXPR:         e = no_expr(); break;
+  default:                  e = object(s[0]); break;
+  }
+  return e->set_type(f.type);
+}
+
+//
+// Read what the layout top describes, "P" or "*K", and return it, or
+// NULL if the record is bad.  The tree is read with a stack of the nodes
+// part way through, not by recursion, so it may be of any depth.
+//
+static tree_node *read_tree(Ast_Reader &r, const char *top)
+{
+  Walk_Stack<Read_Frame> stack;
+  Walk_Stack<tree_node *> done;
+  Read_Frame f = Read_Frame();
+
+  f.field = top;
+  f.left = -1;
+  for (;;) {
+    if (r.bad)
+      return NULL;
+    const char *p = f.field;
+    if (f.left == 0) {          // the end of the list at p
+      tree_node **e = done.base + f.elems;
+      tree_node *l = make_list(p[1], e, done.top - e);
+      done.top = e;
+      done.push(l);
+      f.left = -1;
+      f.field += 2;
+      continue;
+    }
+
+    char want = *p;
+    if (f.left > 0) {
+      want = p[1];
+      f.left--;
+    }
+    switch (want) {
+    case 's':
+      f.syms[f.nsyms++] = r.symbol();
+      f.field++;
+      break;
+    case 'b':
+      f.val = r.byte() != 0;
+      f.field++;
+      break;
+    case '*':
+      f.left = r.count();
+      f.elems = done.top - done.base;
+      break;
+    case '\0': {                // all of f has been read
+      if (stack.empty())
+        return done.base[0];
+      tree_node *t[3] = { NULL, NULL, NULL };   // no node has more
+      tree_node **sub = done.base + f.subtrees;
+      for (int i = 0; sub + i < done.top; i++)
+        t[i] = sub[i];
+      done.top = sub;
+      done.push(make_node(r, f, t));
+      f = stack.pop();
+      break;
+    }
+    default: {                  // a node of the phylum want
+      int kind = r.node();
+      if (r.bad || phylum(kind) != want) {
+        r.bad = true;
+        return NULL;
+      }
+      if (f.left < 0)
+        f.field++;
+      stack.push(f);
+      f = Read_Frame();
+      f.kind = kind;
+      f.line = r.line;
+      if (want == 'E')
+        f.type = r.symbol();
+      f.field = layouts[kind];
+      f.subtrees = done.top - done.base;
+      f.left = -1;
+    }
+    }
+  }
+}
+
+static void start_reader(Ast_Reader &r, const char *buf, size_t len)
+{
+  r.pos = (const unsigned char *) buf;
+  r.end = r.pos + len;
+  r.filename = NULL;
+  r.line = 0;
+  r.bad = false;
+  if (!r.read_symbols())
+    r.bad = true;
+}
+
+//
+// Read the record at the front of buf, which may be followed by others,
+// and set *used to its length.
+//
+static bool read_record(const char *buf, size_t len, Program *p, size_t *used)
+{
+  Ast_Reader r;
+  start_reader(r, buf, len);
+  if (r.bad)
+    return false;
+  tree_node *t = read_tree(r, "P");
+  if (t == NULL)
+    return false;
+  *p = (Program) t;
+  *used = (const char *) r.pos - buf;
+  return true;
+}
+
+static bool read_record(const char *buf, size_t len, Classes *c,
+                        Symbol filename, size_t *used)
+{
+  Ast_Reader r;
+  start_reader(r, buf, len);
+  r.filename = filename;
+  if (r.bad || r.byte() != 0)
+    return false;
+  tree_node *t = read_tree(r, "*K");
+  if (t == NULL)
+    return false;
+  *c = (Classes) t;
+  *used = (const char *) r.pos - buf;
+  return true;
+}
+
+bool read_ast(const char *buf, size_t len, Program *p)
+{
+  size_t used;
+  return read_record(buf, len, p, &used) && used == len;
+}
+
+bool read_ast(const char *buf, size_t len, Classes *c, Symbol filename)
+{
+  size_t used;
+  return read_record(buf, len, c, filename, &used) && used == len;
+}
+
+void write_ast_file(Program p, FILE *f)
+{
+  std::string record;
+  write_ast(p, &record);
+  if (fwrite(record.data(), 1, record.size(), f) != record.size() ||
+      fflush(f) != 0) {
+    cerr << "Could not write the tree" << endl;
+    exit(1);
+  }
+}
+
+static void damaged_tree(const char *filename)
+{
+  cerr << "The tree in " << filename << " is damaged" << endl;
+  exit(1);
+}
+
+Program read_ast_file(FILE *f, const char *filename)
+{
+  Source_Text src = Source_Text();
+  Program p;
+
+  load_source(f, filename, &src);
+  if (src.len < 5 || memcmp(src.text, AST_MAGIC, 4) != 0) {
+    cerr << filename << " does not hold a binary tree" << endl;
+    exit(1);
+  }
+  if (src.text[4] != AST_FORMAT_VERSION) {
+    cerr << filename << " holds a tree of version " << (int) src.text[4]
+         << ", not " << AST_FORMAT_VERSION << endl;
+    exit(1);
+  }
+  size_t used, n;
+  if (!read_record(src.text, src.len, &p, &used))
+    damaged_tree(filename);
+  if (used < src.len) {         // a stream, with the classes still to come
+    Classes classes = p->get_classes();
+    for (; used < src.len; used += n) {
+      Classes c;
+      if (!read_record(src.text + used, src.len - used, &c, NULL, &n))
+        damaged_tree(filename);
+      classes = append_Classes(classes, c);
+    }
+    node_lineno = p->get_line_number();
+    p = program(classes);
+  }
+  free_source(&src);
+  return p;
+}
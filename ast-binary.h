@@ -0,0 +1,100 @@
+#ifndef AST_BINARY_H
+#define AST_BINARY_H
+
+//
+// ast-binary.h
+//
+//  A compact binary form of the abstract syntax tree, which can be read
+//  back into cool-tree nodes without scanning any text.  It is how the
+//  parser hands the tree to the later phases (parser -B), in place of
+//  the text printed by dump_with_types, and how --cache-dir keeps the
+//  classes of a file.
+//
+//  The format is versioned: a reader refuses a record of any version
+//  but its own, so AST_FORMAT_VERSION must change whenever the layout of
+//  a record or the fields of a node do.
+//
+//  A record is
+//
+//      magic           "\177AST"
+//      version         varint, AST_FORMAT_VERSION
+//      symbols         varint count, then for each symbol its table
+//                      (a byte, Ast_Table), a varint length, and that
+//                      many bytes followed by a '\0'
+//      tree            a program node, or for a list of classes a 0
+//                      byte and the list
+//
+//  and a node is its kind (a byte, Ast_Kind), its line as a zigzag varint
+//  difference from the line of the node before it, for an expression
+//  its type, and then its fields in the order of cool-tree.h.  A symbol
+//  field is a varint: 0 for none, otherwise 1 + its index in the symbol
+//  section.  A list is a varint count followed by its elements, and a
+//  Boolean is a byte.
+//
+//  A stream of classes (parser --stream -B) is a program record with no
+//  classes, followed by a record for each list of classes as it was
+//  parsed.
+//
+
+#include <stdio.h>
+#include <stddef.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "cool-tree.h"
+
+#define AST_MAGIC "\177AST"
+#define AST_FORMAT_VERSION 1
+
+enum Ast_Table { AST_ID, AST_INT, AST_STR };
+
+enum Ast_Kind {
+  AST_PROGRAM = 1, AST_CLASS, AST_METHOD, AST_ATTR, AST_FORMAL, AST_BRANCH,
+  AST_ASSIGN, AST_STATIC_DISPATCH, AST_DISPATCH, AST_COND, AST_LOOP,
+  AST_TYPCASE, AST_BLOCK, AST_LET, AST_PLUS, AST_SUB, AST_MUL, AST_DIVIDE,
+  AST_NEG, AST_LT, AST_EQ, AST_LEQ, AST_COMP, AST_INT_CONST, AST_BOOL_CONST,
+  AST_STRING_CONST, AST_NEW, AST_ISVOID, AST_NO_EXPR, AST_OBJECT,
+};
+
+//
+// Ast_Writer collects the nodes given to it by the write_ast_part methods
+// of the tree, numbering the symbols as they are first seen.
+//
+class Ast_Writer {
+  std::string body;
+  std::string symbols;
+  std::unordered_map<Symbol, unsigned> index;
+  int line;                     // of the last node written
+public:
+  Ast_Writer() : line(0) { }
+  void node(Ast_Kind kind, tree_node *t);
+  void symbol(Ast_Table table, Symbol s);
+  void count(int n);
+  void boolean(Boolean b);
+  void finish(std::string *out);        // the record of what was written
+};
+
+// Write the record of a whole program, or of a list of classes.
+void write_ast(Program p, std::string *out);
+void write_ast(Classes c, std::string *out);
+
+//
+// Read a record back.  The nodes are made in the current thread's arena
+// and given the recorded line numbers.  Returns false if buf does not
+// hold exactly one well-formed record of the right kind; some nodes may
+// have been made by then.  If filename is given, the classes read are
+// given it as their file instead of the one recorded.
+//
+bool read_ast(const char *buf, size_t len, Program *p);
+bool read_ast(const char *buf, size_t len, Classes *c,
+              Symbol filename = NULL);
+
+//
+// For passing a program between phases.  read_ast_file maps f if it is
+// a regular file, and reads it otherwise; it takes a program or a stream
+// of classes.  If f holds neither, it prints a message and exits.
+//
+void write_ast_file(Program p, FILE *f);
+Program read_ast_file(FILE *f, const char *filename);
+
+#endif
@@ -0,0 +1,189 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////////
+//
+//  ast-cache.cc
+//
+//  The cache of parsed files; see ast-cache.h.
+//
+//  An entry is the file <cache-dir>/<hex of the key>.ast, holding
+//
+//      magic           "\177ACE"
+//      key             the SHA-256 that names the entry
+//      lineno          4 bytes, little endian
+//      classes         a record of ast-binary.h
+//
+//  Entries are written to a temporary file and renamed into place, so a
+//  reader (another compiler running at the same time, say) only ever sees
+//  whole entries.  An entry that cannot be read is treated as missing.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
+#include "cool-io.h"
+#include "handle_flags.h"
+#include "input-map.h"
+#include "ast-binary.h"
+#include "ast-cache.h"
+
+#define ENTRY_MAGIC "\177ACE"
+#define ENTRY_HEADER (4 + SHA256_SIZE + 4)
+
+static std::atomic<bool> stored(false);  // there may be entries to trim
+static std::atomic<int> temp_number(0);
+
+void ast_cache_key(const char *text, size_t len, Ast_Cache_Key *key)
+{
+  Sha256 s;
+  char version[] = COOL_PARSER_VERSION;
+  unsigned format = AST_FORMAT_VERSION;
+
+  sha256_init(&s);
+  sha256_update(&s, version, sizeof(version));
+  sha256_update(&s, &format, sizeof(format));
+  sha256_update(&s, text, len);
+  sha256_final(&s, key->hash);
+}
+
+static std::string entry_name(const Ast_Cache_Key *key)
+{
+  static const char hex[] = "0123456789abcdef";
+  std::string name = cache_dir;
+  name += '/';
+  for (int i = 0; i < SHA256_SIZE; i++) {
+    name += hex[key->hash[i] >> 4];
+    name += hex[key->hash[i] & 15];
+  }
+  return name + ".ast";
+}
+
+bool ast_cache_lookup(const Ast_Cache_Key *key, const char *filename,
+                      Classes *classes, int *lineno)
+{
+  std::string name = entry_name(key);
+  FILE *f = fopen(name.c_str(), "r");
+  if (f == NULL)
+    return false;
+
+  Input_Map map = Input_Map();
+  bool hit = map_input(f, &map) && map.len > ENTRY_HEADER &&
+             memcmp(map.base, ENTRY_MAGIC, 4) == 0 &&
+             memcmp(map.base + 4, key->hash, SHA256_SIZE) == 0;
+  fclose(f);
+
+  if (hit) {
+    // Read into an arena of our own, so a bad entry leaves nothing behind.
+    // Reading sets node_lineno, which lineno may be.
+    int saved_lineno = node_lineno;
+    Tree_Arena nodes = swap_tree_nodes(Tree_Arena());
+    hit = read_ast(map.base + ENTRY_HEADER, map.len - ENTRY_HEADER, classes,
+                   stringtable.add_string((char *) filename));
+    Tree_Arena entry = swap_tree_nodes(nodes);
+    node_lineno = saved_lineno;
+    if (hit) {
+      const unsigned char *p =
+        (const unsigned char *) map.base + 4 + SHA256_SIZE;
+      *lineno = p[0] | p[1] << 8 | p[2] << 16 | p[3] << 24;
+      adopt_tree_arena(&entry);
+    }
+    else
+      release_tree_arena(&entry);
+  }
+  unmap_input(&map);
+
+  if (hit)
+    utimes(name.c_str(), NULL);         // recently used
+  return hit;
+}
+
+void ast_cache_store(const Ast_Cache_Key *key, Classes classes, int lineno)
+{
+  std::string record;
+  write_ast(classes, &record);
+
+  unsigned char header[ENTRY_HEADER];
+  memcpy(header, ENTRY_MAGIC, 4);
+  memcpy(header + 4, key->hash, SHA256_SIZE);
+  for (int i = 0; i < 4; i++)
+    header[4 + SHA256_SIZE + i] = (unsigned) lineno >> (8 * i);
+
+  mkdir(cache_dir, 0777);
+  std::string name = entry_name(key);
+  char suffix[64];
+  snprintf(suffix, sizeof(suffix), ".%d.%d.tmp", (int) getpid(),
+           temp_number++);
+  std::string temp = name + suffix;
+
+  // The cache is only an aid: if it cannot be written, do without it.
+  FILE *f = fopen(temp.c_str(), "w");
+  if (f == NULL)
+    return;
+  bool ok = fwrite(header, 1, ENTRY_HEADER, f) == ENTRY_HEADER &&
+            fwrite(record.data(), 1, record.size(), f) == record.size();
+  if (fclose(f) != 0 || !ok || rename(temp.c_str(), name.c_str()) != 0) {
+    unlink(temp.c_str());
+    return;
+  }
+  stored = true;
+}
+
+struct Cache_Entry {
+  std::string name;
+  off_t size;
+  time_t used;
+};
+
+static bool used_before(const Cache_Entry &a, const Cache_Entry &b)
+{
+  return a.used < b.used;
+}
+
+void ast_cache_trim()
+{
+  if (!stored)
+    return;
+  stored = false;
+
+  DIR *dir = opendir(cache_dir);
+  if (dir == NULL)
+    return;
+
+  std::vector<Cache_Entry> entries;
+  off_t total = 0;
+  for (struct dirent *d; (d = readdir(dir)) != NULL; ) {
+    size_t len = strlen(d->d_name);
+    if (len < 4 || strcmp(d->d_name + len - 4, ".ast") != 0)
+      continue;
+    Cache_Entry e;
+    struct stat st;
+    e.name = std::string(cache_dir) + "/" + d->d_name;
+    if (stat(e.name.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+      continue;
+    e.size = st.st_size;
+    e.used = st.st_mtime;
+    total += e.size;
+    entries.push_back(e);
+  }
+  closedir(dir);
+
+  off_t limit = (off_t) cache_size << 20;
+  if (total <= limit)
+    return;
+  std::sort(entries.begin(), entries.end(), used_before);
+  for (size_t i = 0; i < entries.size() && total > limit; i++)
+    if (unlink(entries[i].name.c_str()) == 0)
+      total -= entries[i].size;
+}
@@ -0,0 +1,41 @@
+#ifndef AST_CACHE_H
+#define AST_CACHE_H
+
+//
+// ast-cache.h
+//
+//  An on-disk cache of parsed files (--cache-dir).  An entry holds the
+//  classes of one source file, in the form of ast-binary.h, and is named
+//  by the SHA-256 of the parser version and the file's bytes, so a file
+//  that has not changed is not scanned or parsed again, whatever its
+//  name.  Only files that parse without errors are kept.
+//
+//  The cache is kept within --cache-size megabytes by removing the
+//  entries used least recently; a hit touches its entry.
+//
+
+#include <stddef.h>
+#include "cool-tree.h"
+#include "sha256.h"
+
+// Change this whenever the scanner, the grammar or its actions change
+// the tree some input parses to.
+#define COOL_PARSER_VERSION "cool-parse 1"
+
+struct Ast_Cache_Key {
+  unsigned char hash[SHA256_SIZE];
+};
+
+void ast_cache_key(const char *text, size_t len, Ast_Cache_Key *key);
+
+// If key has an entry, make its classes, with filename as their file, and
+// return the line the parse of the file would have left in node_lineno.
+bool ast_cache_lookup(const Ast_Cache_Key *key, const char *filename,
+                      Classes *classes, int *lineno);
+
+void ast_cache_store(const Ast_Cache_Key *key, Classes classes, int lineno);
+
+// Remove the least recently used entries, if the cache is over its size.
+void ast_cache_trim();
+
+#endif
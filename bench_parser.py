@@ -0,0 +1,213 @@
+#!/usr/bin/env python3
+
+# Benchmark the parser on the synthetic workloads of gen_cool.py.
+#
+#   python3 bench_parser.py [--parser ./parser] [--scale N] [--repeat N]
+#                           [--engine E ...] [WORKLOAD ...]
+#
+# Each workload is run through the phases the parser can be stopped at:
+#
+#   scan    parser -E file            (the scanner alone)
+#   parse   parser -B file            (scan and parse; the tree in binary)
+#   dump    parser -d < tree          (print the binary tree as text)
+#   total   parser file               (all of it, as the later phases see it)
+#
+# and for each the best wall and CPU time of --repeat runs, the throughput
+# and the peak RSS are printed.  With --engine (which may be given more
+# than once, e.g. --engine bison --engine descent) parse and total are
+# run with each of the parser's engines in turn, to compare them.  Tokens are counted from the -E stream,
+# nodes from the text dump.  The programs are written by gen_cool.py, so
+# the numbers of one build can be compared with those of another.
+
+import argparse
+import os
+import re
+import resource
+import subprocess
+import sys
+import tempfile
+import time
+
+import gen_cool                         # for the names of the workloads
+
+TS_MAGIC = b"\177CTK\001"
+TS_TOKEN_BASE = 0x80
+TS_FILE = 0xF0
+TS_SYMBOL = 0xF1
+
+def token_numbers():
+    # The token numbers, as bison assigned them.
+    here = os.path.dirname(os.path.abspath(__file__))
+    with open(os.path.join(here, "cool-parse.hh")) as f:
+        text = f.read()
+    return dict((m.group(1), int(m.group(2)))
+                for m in re.finditer(r"^\s+(\w+) = (\d+),?", text, re.M))
+
+class Stream:
+    # The bytes of a file, read a piece at a time so that this script
+    # stays small (see run).
+    def __init__(self, f):
+        self.f, self.buf, self.i = f, b"", 0
+
+    def byte(self):
+        if self.i == len(self.buf):
+            self.buf, self.i = self.f.read(1 << 16), 0
+            if not self.buf:
+                return None
+        self.i += 1
+        return self.buf[self.i - 1]
+
+    def skip(self, n):
+        while n > 0:
+            if self.i == len(self.buf):
+                self.buf, self.i = self.f.read(1 << 16), 0
+            k = min(n, len(self.buf) - self.i)
+            self.i += k
+            n -= k
+
+    def varint(self):
+        n = shift = 0
+        while True:
+            b = self.byte()
+            n |= (b & 0x7F) << shift
+            shift += 7
+            if not b & 0x80:
+                return n
+
+def count_tokens(path):
+    # The number of tokens in a binary token stream (token-stream.h).
+    tok = token_numbers()
+    kind = lambda t: TS_TOKEN_BASE + tok[t] - tok["CLASS"]
+    indexed = set(kind(t) for t in ("TYPEID", "OBJECTID", "INT_CONST", "STR_CONST"))
+    boolean, error = kind("BOOL_CONST"), kind("ERROR")
+
+    with open(path, "rb") as f:
+        if f.read(len(TS_MAGIC)) != TS_MAGIC:
+            sys.exit("parser -E did not write a token stream")
+        s, count = Stream(f), 0
+        while True:
+            k = s.byte()
+            if k is None:
+                return count
+            if k == TS_FILE:
+                s.skip(s.varint())
+                continue
+            if k == TS_SYMBOL:
+                s.byte()
+                s.skip(s.varint())
+                continue
+            count += 1
+            s.varint()                      # line delta
+            if k in indexed:
+                s.varint()
+            elif k == boolean:
+                s.byte()
+            elif k == error:
+                s.skip(s.varint())
+
+def count_nodes(path):
+    # Every node of the text dump begins with its "#line".
+    node = re.compile(rb"^ *#\d+$")
+    with open(path, "rb") as f:
+        return sum(1 for line in f if node.match(line))
+
+# ru_maxrss of a child counts the memory of the process that forked it, so
+# this script keeps to a few megabytes: the programs, the token streams
+# and the dumps go to files and are never read in whole.
+def run(cmd, stdin_path=None, stdout_path=None):
+    # Run cmd once; return its wall time, CPU time and peak RSS (KB).
+    stdin = open(stdin_path, "rb") if stdin_path else subprocess.DEVNULL
+    out = open(stdout_path, "wb") if stdout_path else subprocess.DEVNULL
+    start = time.perf_counter()
+    proc = subprocess.Popen(cmd, stdin=stdin, stdout=out, stderr=subprocess.PIPE)
+    err = proc.stderr.read()
+    _, status, usage = os.wait4(proc.pid, 0)
+    wall = time.perf_counter() - start
+    proc.returncode = os.waitstatus_to_exitcode(status)
+    proc.stderr.close()
+    for f in (stdin, out):
+        if f is not subprocess.DEVNULL:
+            f.close()
+    if proc.returncode != 0:
+        sys.exit("%s failed:\n%s" % (" ".join(cmd), err.decode("utf-8", "replace")))
+    return wall, usage.ru_utime + usage.ru_stime, usage.ru_maxrss
+
+def best(cmd, repeat, stdin_path=None):
+    runs = [run(cmd, stdin_path) for i in range(repeat)]
+    return min(r[0] for r in runs), min(r[1] for r in runs), max(r[2] for r in runs)
+
+def rate(n, seconds):
+    n = n / seconds if seconds > 0 else 0
+    for unit in ("", "K", "M", "G"):
+        if n < 1000:
+            return "%.1f%s" % (n, unit)
+        n /= 1000
+    return "%.1fT" % n
+
+def bench(parser, name, scale, repeat, engines, tmp):
+    source = os.path.join(tmp, name + ".cl")
+    tokens = os.path.join(tmp, name + ".tokens")
+    tree = os.path.join(tmp, name + ".ast")
+    dump = os.path.join(tmp, name + ".dump")
+    here = os.path.dirname(os.path.abspath(__file__))
+    run([sys.executable, os.path.join(here, "gen_cool.py"), name, str(scale)],
+        stdout_path=source)
+
+    # One run of each phase to count what it does.
+    run([parser, "-E", source], stdout_path=tokens)
+    run([parser, "-B", source], stdout_path=tree)
+    run([parser, "-d"], stdin_path=tree, stdout_path=dump)
+    ntokens = count_tokens(tokens)
+    nodes = count_nodes(dump)
+    dumped = os.path.getsize(dump)
+    os.remove(tokens)
+    os.remove(dump)
+
+    def each_engine(phase, args):
+        if not engines:
+            return [(phase, [parser] + args)]
+        return [(phase + "/" + e, [parser, "--engine", e] + args) for e in engines]
+
+    phases = [
+        ("scan", [parser, "-E", source], None, ntokens, "tokens")
+    ] + [
+        (phase, cmd, None, nodes, "nodes")
+        for phase, cmd in each_engine("parse", ["-B", source])
+    ] + [
+        ("dump", [parser, "-d"], tree, dumped, "bytes")
+    ] + [
+        (phase, cmd, None, os.path.getsize(source), "src bytes")
+        for phase, cmd in each_engine("total", [source])
+    ]
+    print("%s: %d bytes of source, %d tokens, %d nodes, %d bytes dumped"
+          % (name, os.path.getsize(source), ntokens, nodes, dumped))
+    for phase, cmd, stdin_path, n, what in phases:
+        wall, cpu, rss = best(cmd, repeat, stdin_path)
+        print("  %-14s %8.3fs wall %8.3fs cpu %10s %s/s %8d KB peak"
+              % (phase, wall, cpu, rate(n, wall), what, rss))
+    sys.stdout.flush()
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    ap = argparse.ArgumentParser(description="Benchmark the Cool parser.")
+    ap.add_argument("--parser", default=os.path.join(here, "parser"))
+    ap.add_argument("--scale", type=int, default=1)
+    ap.add_argument("--repeat", type=int, default=3)
+    ap.add_argument("--engine", action="append", choices=["bison", "descent"],
+                    help="parse with this engine (may be repeated)")
+    ap.add_argument("workloads", nargs="*", metavar="WORKLOAD",
+                    help="one of " + " ".join(sorted(gen_cool.WORKLOADS)))
+    args = ap.parse_args()
+
+    names = args.workloads or sorted(gen_cool.WORKLOADS)
+    for name in names:
+        if name not in gen_cool.WORKLOADS:
+            ap.error("no workload " + name)
+    with tempfile.TemporaryDirectory() as tmp:
+        for name in names:
+            bench(args.parser, name, args.scale, args.repeat, args.engine, tmp)
+    print("(a peak below %d KB is this script's, not the parser's)"
+          % resource.getrusage(resource.RUSAGE_SELF).ru_maxrss)
+
+if __name__ == "__main__":
+    main()
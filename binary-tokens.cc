@@ -0,0 +1,362 @@
+//
+// binary-tokens.cc
+//
+//  Writer and reader for the binary token stream described in
+//  token-stream.h.  The writer runs the Cool scanner over its input files
+//  (parser -E); the reader is the cool_yylex backend selected with -b.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+#include <unordered_map>
+#include "cool-tree.h"
+#include "stringtab.h"
+#include "utilities.h"
+#include "handle_flags.h"
+#include "token-stream.h"
+#include "input-map.h"
+#include "cool-parse.hh"
+
+extern FILE *token_file;
+extern int curr_lineno;
+extern char *curr_filename;
+extern YYSTYPE cool_yylval;
+extern int cool_yylex();
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  Writer
+//
+/////////////////////////////////////////////////////////////////////////
+
+static FILE *ts_out;
+static unsigned char out_buf[65536];
+static size_t out_len;
+
+static void flush_out()
+{
+  if (out_len && fwrite(out_buf, 1, out_len, ts_out) != out_len) {
+    cerr << "write() of token stream failed" << endl;
+    exit(1);
+  }
+  out_len = 0;
+}
+
+static void put_bytes(const void *p, size_t n)
+{
+  if (out_len + n > sizeof(out_buf)) {
+    flush_out();
+    if (n > sizeof(out_buf)) {
+      if (fwrite(p, 1, n, ts_out) != n) {
+	cerr << "write() of token stream failed" << endl;
+	exit(1);
+      }
+      return;
+    }
+  }
+  memcpy(out_buf + out_len, p, n);
+  out_len += n;
+}
+
+static inline void put_byte(unsigned char b)
+{
+  if (out_len == sizeof(out_buf))
+    flush_out();
+  out_buf[out_len++] = b;
+}
+
+static void put_varint(unsigned long v)
+{
+  while (v >= 0x80) {
+    put_byte((v & 0x7F) | 0x80);
+    v >>= 7;
+  }
+  put_byte(v);
+}
+
+static void put_text(const char *s, size_t len)
+{
+  put_varint(len);
+  put_bytes(s, len);
+}
+
+//
+// Stream index of each symbol already sent, one map per table.
+//
+static std::unordered_map<Symbol, int> sent[3];
+
+static int symbol_index(TS_Table table, Symbol sym)
+{
+  std::unordered_map<Symbol, int>::iterator it = sent[table].find(sym);
+  if (it != sent[table].end())
+    return it->second;
+
+  int index = sent[table].size();
+  sent[table][sym] = index;
+  put_byte(TS_SYMBOL);
+  put_byte(table);
+  put_text(sym->get_string(), sym->get_len());
+  return index;
+}
+
+static void emit_file(const char *filename)
+{
+  put_byte(TS_FILE);
+  put_text(filename, strlen(filename));
+
+  int line = curr_lineno = 1;
+  int token;
+  while ((token = cool_yylex()) != 0) {
+    int index = 0;
+    switch (token) {
+    case TYPEID:
+    case OBJECTID:
+      index = symbol_index(TS_IDTABLE, cool_yylval.symbol);
+      break;
+    case INT_CONST:
+      index = symbol_index(TS_INTTABLE, cool_yylval.symbol);
+      break;
+    case STR_CONST:
+      index = symbol_index(TS_STRINGTABLE, cool_yylval.symbol);
+      break;
+    }
+
+    put_byte(token < 256 ? token : TS_TOKEN_BASE + (token - CLASS));
+    put_varint(curr_lineno - line);
+    line = curr_lineno;
+
+    switch (token) {
+    case TYPEID:
+    case OBJECTID:
+    case INT_CONST:
+    case STR_CONST:
+      put_varint(index);
+      break;
+    case BOOL_CONST:
+      put_byte(cool_yylval.boolean ? 1 : 0);
+      break;
+    case ERROR:
+      put_text(cool_yylval.error_msg, strlen(cool_yylval.error_msg));
+      break;
+    }
+  }
+}
+
+void emit_token_stream(int argc, const char *argv[], FILE *out)
+{
+  ts_out = out;
+  put_bytes(TS_MAGIC, TS_MAGIC_LEN);
+
+  if (optind == argc) {
+    token_file = stdin;
+    curr_filename = "<stdin>";
+    emit_file(curr_filename);
+  }
+  for (int i = optind; i < argc; i++) {
+    token_file = fopen(argv[i], "r");
+    if (token_file == NULL) {
+      cerr << "Could not open input file " << argv[i] << endl;
+      exit(1);
+    }
+    curr_filename = (char *) argv[i];
+    emit_file(argv[i]);
+    fclose(token_file);
+  }
+  flush_out();
+  fflush(out);
+}
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  Reader
+//
+/////////////////////////////////////////////////////////////////////////
+
+static FILE *in_file;          // the token_file being read
+static Input_Map in_map;       // in_file, if it could be mapped
+static unsigned char in_buf[65536];
+static const unsigned char *in_pos;
+static const unsigned char *in_end;
+static bool in_eof;
+
+static std::vector<Symbol> symbols[3];
+
+static void bad_stream(const char *what)
+{
+  cerr << "binary token stream: " << what << endl;
+  exit(1);
+}
+
+// Refill in_buf; returns false at end of input.
+static bool fill()
+{
+  if (in_eof)
+    return false;
+  size_t got = fread(in_buf, 1, sizeof(in_buf), token_file);
+  if (got == 0) {
+    if (ferror(token_file))
+      bad_stream("read() failed");
+    in_eof = true;
+    return false;
+  }
+  in_pos = in_buf;
+  in_end = in_buf + got;
+  return true;
+}
+
+static inline int get_byte()
+{
+  if (in_pos == in_end && !fill())
+    return EOF;
+  return *in_pos++;
+}
+
+static inline int need_byte()
+{
+  int b = get_byte();
+  if (b == EOF)
+    bad_stream("unexpected end of stream");
+  return b;
+}
+
+static unsigned long get_varint()
+{
+  unsigned long v = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    int b = need_byte();
+    v |= (unsigned long) (b & 0x7F) << shift;
+    if (!(b & 0x80))
+      return v;
+  }
+  bad_stream("malformed varint");
+  return 0;
+}
+
+// Read a length-prefixed string into a '\0' terminated buffer.
+static char *get_text(int *lenp)
+{
+  static char *text;
+  static size_t cap;
+
+  size_t len = get_varint();
+  if (len + 1 > cap) {
+    cap = len + 1 > 2 * cap ? len + 1 : 2 * cap;
+    text = (char *) realloc(text, cap);
+    if (text == NULL)
+      bad_stream("out of memory");
+  }
+  for (size_t n = 0; n < len; ) {
+    if (in_pos == in_end && !fill())
+      bad_stream("unexpected end of stream");
+    size_t chunk = in_end - in_pos;
+    if (chunk > len - n)
+      chunk = len - n;
+    memcpy(text + n, in_pos, chunk);
+    in_pos += chunk;
+    n += chunk;
+  }
+  text[len] = '\0';
+  *lenp = len;
+  return text;
+}
+
+static void start_stream()
+{
+  in_file = token_file;
+  for (int i = 0; i < 3; i++)
+    symbols[i].clear();     // symbol indices are per stream
+  unmap_input(&in_map);
+  if (map_input(token_file, &in_map)) {
+    in_pos = (const unsigned char *) in_map.base;
+    in_end = in_pos + in_map.len;
+    in_eof = true;
+  } else {
+    in_pos = in_end = in_buf;
+    in_eof = false;
+  }
+
+  for (int i = 0; i < TS_MAGIC_LEN; i++)
+    if (get_byte() != (unsigned char) TS_MAGIC[i])
+      bad_stream("bad magic number (not produced by parser -E?)");
+}
+
+static Symbol get_symbol(TS_Table table)
+{
+  unsigned long index = get_varint();
+  if (index >= symbols[table].size())
+    bad_stream("symbol index out of range");
+  return symbols[table][index];
+}
+
+int binary_yylex()
+{
+  if (in_file != token_file)
+    start_stream();
+
+  for (;;) {
+    int kind = get_byte();
+    if (kind == EOF) {
+      in_file = NULL;   // the next token_file may reuse the same FILE
+      return 0;
+    }
+
+    if (kind == TS_FILE) {
+      int len;
+      curr_filename = strdup(get_text(&len));
+      curr_lineno = 1;
+      continue;
+    }
+    if (kind == TS_SYMBOL) {
+      int table = need_byte();
+      int len;
+      char *text = get_text(&len);
+      switch (table) {
+      case TS_IDTABLE:
+	symbols[table].push_back(idtable.add_string(text, len));
+	break;
+      case TS_INTTABLE:
+	symbols[table].push_back(inttable.add_string(text, len));
+	break;
+      case TS_STRINGTABLE:
+	symbols[table].push_back(stringtable.add_string(text, len));
+	break;
+      default:
+	bad_stream("bad symbol table");
+      }
+      continue;
+    }
+
+    int token = kind;
+    if (kind >= TS_TOKEN_BASE) {
+      token = CLASS + (kind - TS_TOKEN_BASE);
+      if (token > ERROR)
+	bad_stream("bad token kind");
+    }
+    curr_lineno += get_varint();
+
+    switch (token) {
+    case TYPEID:
+    case OBJECTID:
+      cool_yylval.symbol = get_symbol(TS_IDTABLE);
+      break;
+    case INT_CONST:
+      cool_yylval.symbol = get_symbol(TS_INTTABLE);
+      break;
+    case STR_CONST:
+      cool_yylval.symbol = get_symbol(TS_STRINGTABLE);
+      break;
+    case BOOL_CONST:
+      cool_yylval.boolean = need_byte() != 0;
+      break;
+    case ERROR: {
+      int len;
+      cool_yylval.error_msg = strdup(get_text(&len));
+      break;
+    }
+    }
+    return token;
+  }
+}
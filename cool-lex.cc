@@ -0,0 +1,600 @@
+//
+// cool-lex.cc
+//
+//  A scanner for Cool source text that is linked into the parser, so
+//  that cool_yylex() reads .cl files directly instead of re-scanning the
+//  "#<line> TOKEN lexeme" stream printed by a separate ./lexer process.
+//  The tokens, line numbers and error messages are the same ones the
+//  lexer prints; the token-stream readers in text-tokens.cc and
+//  tokens-lex.cc are still available with -k so output can be checked
+//  against the reference.
+//
+//  All scanner state is in a Lex_State (cool-lex.h), so any number of
+//  inputs can be scanned at once.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cool-tree.h"
+#include "stringtab.h"
+#include "utilities.h"
+#include "handle_flags.h"
+#include "token-stream.h"
+#include "cool-lex.h"
+#include "parse-stats.h"
+#include "string-scan.h"
+
+extern FILE *token_file;   /* the token readers and -E read this file */
+extern char *curr_filename;
+
+/* The token and line of the non-reentrant cool_yylex() below, which the
+   token-stream readers also use. */
+YYSTYPE cool_yylval;
+int curr_lineno;
+
+/* tokens-lex.cc, compiled with -Dcool_yylex=tokens_yylex */
+extern int tokens_yylex();
+typedef struct yy_buffer_state *YY_BUFFER_STATE;
+extern YY_BUFFER_STATE yy_scan_buffer(char *base, size_t size);
+extern void yy_delete_buffer(YY_BUFFER_STATE b);
+extern void yyrestart(FILE *input_file);
+extern FILE *yyin;
+/* text-tokens.cc, which reads the same stream faster */
+extern int text_yylex();
+
+//
+// The input being scanned.  A source file is small next to the AST that
+// is built from it, so the whole of it is mapped (or, for a pipe, read
+// in) before the first token; this keeps the scanner free of
+// buffer-boundary cases.
+//
+
+// Read a file that cannot be mapped, such as a pipe.
+static void read_source(FILE *f, const char *filename, Source_Text *src)
+{
+  size_t n = 0;
+
+  for (;;) {
+    if (src->cap - n < 4096) {
+      src->cap = src->cap ? 2 * src->cap : 65536;
+      src->buf = (char *) realloc(src->buf, src->cap);
+      if (src->buf == NULL) {
+	cerr << "out of memory reading " << filename << endl;
+	exit(1);
+      }
+    }
+    size_t got = fread(src->buf + n, 1, src->cap - n - 1, f);
+    if (got == 0)
+      break;
+    n += got;
+  }
+  if (ferror(f)) {
+    cerr << "read() in Cool scanner failed" << endl;
+    exit(1);
+  }
+  src->buf[n] = '\0';
+  src->text = src->buf;
+  src->len = n;
+}
+
+void load_source(FILE *f, const char *filename, Source_Text *src)
+{
+  Stats_Phase was = parse_stats.phase;
+
+  STATS_BEGIN(PHASE_READ);      // a mapped file is read as it is scanned
+  unmap_input(&src->map);
+  if (map_input(f, &src->map)) {
+    src->text = src->map.base;
+    src->len = src->map.len;
+  } else
+    read_source(f, filename, src);
+  STATS_BEGIN(was);
+}
+
+void free_source(Source_Text *src)
+{
+  unmap_input(&src->map);
+  free(src->buf);
+  src->buf = NULL;
+  src->cap = 0;
+  src->text = NULL;
+  src->len = 0;
+}
+
+void start_lex(Lex_State *lex, const char *buf, size_t len)
+{
+  lex->pos = buf;
+  lex->end = buf + len;
+  lex->lineno = lex->last_token_line = 1;
+  lex->done = false;
+  lex->skip_string = false;
+}
+
+void finish_lex(Lex_State *lex)
+{
+  free(lex->lexeme_buf);
+  lex->lexeme_buf = NULL;
+  lex->lexeme_cap = 0;
+}
+
+//
+// The string tables expect '\0' terminated strings, so lexemes are
+// copied out of the input before they are added.
+//
+static char *lexeme(Lex_State *lex, const char *s, int len)
+{
+  if (len >= lex->lexeme_cap) {
+    lex->lexeme_cap = len + 64 > 2 * lex->lexeme_cap ? len + 64 : 2 * lex->lexeme_cap;
+    lex->lexeme_buf = (char *) realloc(lex->lexeme_buf, lex->lexeme_cap);
+  }
+  memcpy(lex->lexeme_buf, s, len);
+  lex->lexeme_buf[len] = '\0';
+  return lex->lexeme_buf;
+}
+
+static int error(YYSTYPE *lval, const char *msg)
+{
+  lval->error_msg = msg;
+  return ERROR;
+}
+
+//
+// Error token for a character that cannot start any token; the message
+// is the character itself.
+//
+static int bad_char(Lex_State *lex, YYSTYPE *lval, unsigned char c)
+{
+  lex->bad_char[0] = c;
+  lex->bad_char[1] = '\0';
+  return error(lval, lex->bad_char);
+}
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  Keywords
+//
+//  Keywords are case insensitive, except that the boolean constants
+//  true and false must begin with a lower-case letter.
+//
+/////////////////////////////////////////////////////////////////////////
+
+static struct { const char *name; int len; int token; } keywords[] = {
+  { "class",    5, CLASS    },
+  { "else",     4, ELSE     },
+  { "fi",       2, FI       },
+  { "if",       2, IF       },
+  { "in",       2, IN       },
+  { "inherits", 8, INHERITS },
+  { "isvoid",   6, ISVOID   },
+  { "let",      3, LET      },
+  { "loop",     4, LOOP     },
+  { "pool",     4, POOL     },
+  { "then",     4, THEN     },
+  { "while",    5, WHILE    },
+  { "case",     4, CASE     },
+  { "esac",     4, ESAC     },
+  { "new",      3, NEW      },
+  { "of",       2, OF       },
+  { "not",      3, NOT      },
+};
+
+static int keyword(YYSTYPE *lval, const char *s, int len)
+{
+  for (size_t i = 0; i < sizeof(keywords) / sizeof(keywords[0]); i++)
+    if (keywords[i].len == len && strncasecmp(s, keywords[i].name, len) == 0)
+      return keywords[i].token;
+
+  if (s[0] == 't' && len == 4 && strncasecmp(s, "true", 4) == 0) {
+    lval->boolean = 1;
+    return BOOL_CONST;
+  }
+  if (s[0] == 'f' && len == 5 && strncasecmp(s, "false", 5) == 0) {
+    lval->boolean = 0;
+    return BOOL_CONST;
+  }
+  return 0;
+}
+
+static inline bool is_digit(char c) { return c >= '0' && c <= '9'; }
+static inline bool is_upper(char c) { return c >= 'A' && c <= 'Z'; }
+static inline bool is_lower(char c) { return c >= 'a' && c <= 'z'; }
+static inline bool is_idchar(char c)
+{
+  return is_lower(c) || is_upper(c) || is_digit(c) || c == '_';
+}
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  Comments and strings
+//
+/////////////////////////////////////////////////////////////////////////
+
+//
+// Skip a (possibly nested) comment; lex->pos is just past the opening "(*".
+// Returns false if the input ends inside the comment.
+//
+static bool skip_comment(Lex_State *lex)
+{
+  int depth = 1;
+
+  while (lex->pos < lex->end) {
+    char c = *lex->pos++;
+    if (c == '\n')
+      lex->lineno++;
+    else if (c == '(' && lex->pos < lex->end && *lex->pos == '*') {
+      lex->pos++;
+      depth++;
+    } else if (c == '*' && lex->pos < lex->end && *lex->pos == ')') {
+      lex->pos++;
+      if (--depth == 0)
+	return true;
+    }
+  }
+  return false;
+}
+
+//
+// After an error inside a string constant, scanning resumes after the
+// closing quote, or at the start of the next line if an unescaped
+// newline comes first.
+//
+static void skip_rest_of_string(Lex_State *lex)
+{
+  while (lex->pos < lex->end) {
+    char c = *lex->pos++;
+    if (c == '"')
+      return;
+    if (c == '\n') {
+      lex->lineno++;
+      return;
+    }
+    if (c == '\\' && lex->pos < lex->end)
+      if (*lex->pos++ == '\n')
+	lex->lineno++;
+  }
+}
+
+//
+// Scan a string constant; lex->pos is just past the opening quote.  The
+// runs between quotes, backslashes, newlines and nulls are copied whole.
+//
+static int scan_string(Lex_State *lex, YYSTYPE *lval)
+{
+  char *out = lex->string_buf;
+  char *limit = lex->string_buf + MAX_STR_CONST - 1;
+
+  for (;;) {
+    size_t n = string_run(lex->pos, lex->end);
+    if (n) {
+      if (n > (size_t) (limit - out)) {
+	lex->pos += limit - out + 1;
+	lex->skip_string = true;
+	return error(lval, "String constant too long");
+      }
+      memcpy(out, lex->pos, n);
+      out += n;
+      lex->pos += n;
+    }
+    if (lex->pos == lex->end)
+      return error(lval, "EOF in string constant");
+
+    char c = *lex->pos++;
+    switch (c) {
+    case '"':
+      *out = '\0';
+      lval->symbol = stringtable.add_string(lex->string_buf, out - lex->string_buf);
+      return STR_CONST;
+    case '\n':
+      lex->lineno++;
+      return error(lval, "Unterminated string constant");
+    case '\0':
+      lex->skip_string = true;
+      return error(lval, "String contains null character.");
+    case '\\':
+      if (lex->pos == lex->end)
+	return error(lval, "EOF in string constant");
+      c = *lex->pos++;
+      switch (c) {
+      case 'n': c = '\n'; break;
+      case 't': c = '\t'; break;
+      case 'b': c = '\b'; break;
+      case 'f': c = '\f'; break;
+      case '\n': lex->lineno++; break;
+      case '\0':
+	lex->skip_string = true;
+	return error(lval, "String contains escaped null character.");
+      }
+      break;
+    }
+
+    if (out == limit) {
+      lex->skip_string = true;
+      return error(lval, "String constant too long");
+    }
+    *out++ = c;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  Scanner
+//
+//  scan_token returns the next token of the Cool source, setting
+//  *lval and lex->lineno as the lexer does.
+//
+/////////////////////////////////////////////////////////////////////////
+
+static int scan_token(Lex_State *lex, YYSTYPE *lval)
+{
+  if (lex->skip_string) {
+    lex->skip_string = false;
+    skip_rest_of_string(lex);
+  }
+
+  while (lex->pos < lex->end) {
+    const char *start = lex->pos;
+    char c = *lex->pos++;
+
+    switch (c) {
+    case '\n':
+      lex->lineno++;
+      continue;
+    case ' ': case '\t': case '\r': case '\f': case '\v':
+      continue;
+
+    case '-':
+      if (lex->pos < lex->end && *lex->pos == '-') {
+	while (lex->pos < lex->end && *lex->pos != '\n')
+	  lex->pos++;
+	continue;
+      }
+      return '-';
+    case '(':
+      if (lex->pos < lex->end && *lex->pos == '*') {
+	lex->pos++;
+	if (!skip_comment(lex))
+	  return error(lval, "EOF in comment");
+	continue;
+      }
+      return '(';
+    case '*':
+      if (lex->pos < lex->end && *lex->pos == ')') {
+	lex->pos++;
+	return error(lval, "Unmatched *)");
+      }
+      return '*';
+    case '<':
+      if (lex->pos < lex->end && *lex->pos == '-') {
+	lex->pos++;
+	return ASSIGN;
+      }
+      if (lex->pos < lex->end && *lex->pos == '=') {
+	lex->pos++;
+	return LE;
+      }
+      return '<';
+    case '=':
+      if (lex->pos < lex->end && *lex->pos == '>') {
+	lex->pos++;
+	return DARROW;
+      }
+      return '=';
+    case '+': case '/': case '~': case '.': case '@': case ',':
+    case ';': case ':': case ')': case '{': case '}':
+      return c;
+
+    case '"':
+      return scan_string(lex, lval);
+    }
+
+    if (is_digit(c)) {
+      while (lex->pos < lex->end && is_digit(*lex->pos))
+	lex->pos++;
+      int len = lex->pos - start;
+      lval->symbol = inttable.add_string(lexeme(lex, start, len), len);
+      return INT_CONST;
+    }
+
+    if (is_lower(c) || is_upper(c)) {
+      while (lex->pos < lex->end && is_idchar(*lex->pos))
+	lex->pos++;
+      int len = lex->pos - start;
+      int token = keyword(lval, start, len);
+      if (token)
+	return token;
+      lval->symbol = idtable.add_string(lexeme(lex, start, len), len);
+      return is_upper(c) ? TYPEID : OBJECTID;
+    }
+
+    return bad_char(lex, lval, c);
+  }
+
+  lex->done = true;
+  return 0;
+}
+
+//
+// lex_token
+//
+// The next token of the input given to start_lex.
+//
+int lex_token(Lex_State *lex, YYSTYPE *lval)
+{
+  if (lex->done)
+    return 0;
+
+  int token = scan_token(lex, lval);
+
+  // A token stream has no end marker, so the parser reports a syntax
+  // error at EOF on the line of the last token; do the same here.
+  if (token == 0)
+    lex->lineno = lex->last_token_line;
+  else
+    lex->last_token_line = lex->lineno;
+  return token;
+}
+
+//
+// The flex token reader of -k -l (tokens-lex.cc, generated from
+// src/tokens.flex).  A regular token_file is mapped and handed to it
+// with yy_scan_buffer, so large token dumps cost no read() calls; a pipe
+// is read through its YY_INPUT as before.  A new file is noticed by the
+// last one having reached its end, since the next file fopen()ed by
+// handle_files may reuse the same FILE.
+//
+static int flex_yylex()
+{
+  static FILE *scanned_file;
+  static Input_Map scanned_map;
+  static YY_BUFFER_STATE scanned_buffer;  // that of scanned_map
+
+  if (token_file != scanned_file) {
+    Input_Map map;
+
+    scanned_file = token_file;
+    if (map_input(token_file, &map)) {
+      YY_BUFFER_STATE old = scanned_buffer;
+      scanned_buffer = yy_scan_buffer(map.base, map.len + 2);
+      if (old)
+        yy_delete_buffer(old);
+      unmap_input(&scanned_map);
+      scanned_map = map;
+    }
+    else if (scanned_buffer) {
+      yy_delete_buffer(scanned_buffer);
+      scanned_buffer = NULL;
+      unmap_input(&scanned_map);
+      yyrestart(yyin);
+    }
+  }
+
+  int token = tokens_yylex();
+  if (token == 0)
+    scanned_file = NULL;
+  return token;
+}
+
+//
+// cool_yylex
+//
+// The tokens of token_file, setting cool_yylval and curr_lineno: Cool
+// source by default, or the token stream of a separate lexer process, as
+// text with -k or in binary with -b.  The whole of a source file is
+// loaded the first time it is seen.  This is what parser -E writes out,
+// and the pure parser's lexer below uses it for -k and -b.
+//
+int cool_yylex()
+{
+  static Lex_State lex;
+  static Source_Text src;
+  static FILE *src_file;        // the token_file src came from
+
+  int token;
+
+  switch (lex_input) {
+  case LEX_TEXT_TOKENS:
+    token = yy_flex_debug ? flex_yylex() : text_yylex();
+    break;
+  case LEX_BINARY_TOKENS:
+    token = binary_yylex();
+    break;
+  default:
+    if (lex.done || src_file != token_file) {
+      load_source(token_file, curr_filename, &src);
+      start_lex(&lex, src.text, src.len);
+      src_file = token_file;
+    }
+    token = lex_token(&lex, &cool_yylval);
+    curr_lineno = lex.lineno;
+    break;
+  }
+  if (token)
+    parse_stats.tokens++;
+  return token;
+}
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  The parser's lexer
+//
+/////////////////////////////////////////////////////////////////////////
+
+void init_parse_state(Parse_State *ps, Lex_Input input, const char *filename,
+                      ostream *err)
+{
+  memset(ps, 0, sizeof(*ps));
+  ps->input = input;
+  ps->filename = filename;
+  ps->lineno = 1;
+  ps->classes = nil_Classes();
+  ps->err = err;
+}
+
+//
+// cool_yylex
+//
+// The lexer of the pure parser, cool_yyparse(ps).  Source is scanned from
+// ps->lex, or was scanned already into ps->scanned; the token streams,
+// which are read from token_file and are not reentrant, come through the
+// global cool_yylex() above.  After more than 50 errors the input is cut
+// short.
+//
+int cool_yylex(YYSTYPE *lval, YYLTYPE *lloc, Parse_State *ps)
+{
+  int token;
+
+  STATS_PHASE(PHASE_SCAN);
+  if (ps->errors > 50)
+    token = 0;
+  else if (ps->scanned) {
+    if (ps->scanned < ps->scanned_end) {
+      token = ps->scanned->token;
+      *lval = ps->scanned->value;
+      ps->lineno = ps->scanned->lineno;
+      ps->scanned++;
+    } else
+      token = 0;                // at the line of the last token, as above
+  } else if (ps->input == LEX_SOURCE) {
+    token = lex_token(&ps->lex, lval);
+    ps->lineno = ps->lex.lineno;
+    if (token)
+      parse_stats.tokens++;
+  } else {
+    token = cool_yylex();
+    *lval = cool_yylval;
+    ps->lineno = curr_lineno;
+    ps->filename = curr_filename;   // a binary stream names its files
+  }
+
+  lloc->first_line = lloc->last_line = ps->lineno;
+  ps->token = token;
+  ps->token_value = *lval;
+  STATS_PHASE(PHASE_PARSE);
+  return token;
+}
+
+void print_cool_token(ostream &s, int tok, const YYSTYPE &val)
+{
+  s << cool_token_to_string(tok);
+
+  switch (tok) {
+  case STR_CONST:
+    s << " = " << " \"";
+    print_escaped_string(s, val.symbol->get_string());
+    s << "\"";
+    break;
+  case INT_CONST:
+  case TYPEID:
+  case OBJECTID:
+    s << " = " << val.symbol;
+    break;
+  case BOOL_CONST:
+    s << (val.boolean ? " = true" : " = false");
+    break;
+  case ERROR:
+    s << " = ";
+    print_escaped_string(s, val.error_msg);
+    break;
+  }
+}
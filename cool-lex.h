@@ -0,0 +1,121 @@
+#ifndef COOL_LEX_H
+#define COOL_LEX_H
+
+//
+// cool-lex.h
+//
+//  State of the Cool scanner and of one run of the (reentrant) parser.
+//  Each parse has its own Parse_State, so several inputs can be parsed at
+//  once in one process; see parse-api.h.
+//
+
+#include <stdio.h>
+#include "cool-io.h"
+#include "cool-tree.h"
+#include "handle_flags.h"
+#include "input-map.h"
+#include "cool-parse.hh"
+
+/* Max size of string constants */
+#define MAX_STR_CONST 1025
+
+//
+// The scanner works on the whole of its input in memory.
+//
+struct Lex_State {
+  const char *pos;              // next character to scan
+  const char *end;
+  int lineno;                   // line of pos
+  int last_token_line;          // where the previous token ended
+  bool done;                    // EOF has been returned
+  bool skip_string;             // resume after a bad string constant
+  char string_buf[MAX_STR_CONST]; // to assemble string constants
+  char *lexeme_buf;             // '\0' terminated copy of a lexeme
+  int lexeme_cap;
+  char bad_char[2];             // message for a character with no token
+};
+
+void start_lex(Lex_State *lex, const char *buf, size_t len);
+void finish_lex(Lex_State *lex);
+int lex_token(Lex_State *lex, YYSTYPE *lval);
+
+//
+// The text of a source file: mapped if possible, otherwise (a pipe, say)
+// read into memory.  It stays valid until free_source.
+//
+struct Source_Text {
+  Input_Map map;
+  char *buf;
+  size_t cap;
+  const char *text;
+  size_t len;
+};
+
+void load_source(FILE *f, const char *filename, Source_Text *src);
+void free_source(Source_Text *src);
+
+//
+// A token scanned ahead of the parse, so that the tokens of a file can be
+// parsed in pieces (handle_files.cc, -j).
+//
+struct Scanned_Token {
+  int token;
+  int lineno;
+  YYSTYPE value;
+};
+
+//
+// Where each class goes as soon as it is parsed, when streaming
+// (--stream).  start is called once, before the first class, with the
+// line the program node would have had.  The nodes of a class are
+// freed when emit returns.  flush is called before exiting on errors,
+// so that the classes before the first error are written out.
+//
+struct Class_Sink {
+  virtual void start(int program_line) = 0;
+  virtual void emit(Class_ c) = 0;
+  virtual void flush() { }
+  virtual ~Class_Sink() { }
+};
+
+struct Parse_State {
+  Lex_Input input;              // where the tokens come from
+  Lex_State lex;                // for LEX_SOURCE
+  const Scanned_Token *scanned; // if not NULL, the tokens to parse
+  const Scanned_Token *scanned_end;
+  const char *filename;
+  int lineno;                   // line of the lookahead token
+  int token;                    // the lookahead token and its value,
+  YYSTYPE token_value;          //   for error messages
+  bool make_program;            // make program (handle_files makes its
+                                //   own, of all the files)
+  Program program;              // the result of the parse
+  Classes classes;              // for use in semantic analysis
+  int errors;                   // number of errors in lexing and parsing
+  ostream *err;                 // where error messages go
+  Class_Sink *sink;             // if not NULL, where the classes go
+  Tree_Arena mark;              //   and the nodes to keep
+};
+
+void init_parse_state(Parse_State *ps, Lex_Input input, const char *filename,
+                      ostream *err);
+
+// The pure parser's lexer.
+int cool_yylex(YYSTYPE *lval, YYLTYPE *lloc, Parse_State *ps);
+
+// Parse as --engine says: cool_yyparse, or descent_parse, the hand-written
+// parser of descent-parse.cc.  Both return 0 if the parse got to the end,
+// 1 if it gave up after an error, and 2 if it ran out of stack.
+int run_parser(Parse_State *ps);
+int descent_parse(Parse_State *ps);
+
+// Shared by the two parsers, from cool.y: report an error at the
+// lookahead (yyerror in cool.y, which Bison renames), and add a class
+// to the program or stream it out.
+void cool_yyerror(YYLTYPE *loc, Parse_State *ps, const char *s);
+Classes add_class(Parse_State *ps, Classes list, Class_ c);
+
+// print_cool_token, for a token whose value is not in cool_yylval.
+void print_cool_token(ostream &s, int tok, const YYSTYPE &val);
+
+#endif
@@ -1,8 +1,8 @@
-/* A Bison parser, made by GNU Bison 3.5.1.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison implementation for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2020 Free Software Foundation,
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
    Inc.
 
    This program is free software: you can redistribute it and/or modify
@@ -16,7 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -34,6 +34,10 @@
 /* C LALR(1) parser skeleton written by Richard Stallman, by
    simplifying the original so-called "semantic" parser.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 /* All symbols defined below should begin with yy or YY, to avoid
    infringing on user name space.  This should be done even for local
    variables, as they might otherwise be expanded by user macros.
@@ -41,20 +45,17 @@
    define necessary library symbols; they are noted "INFRINGES ON
    USER NAME SPACE" below.  */
 
-/* Undocumented macros, especially those whose name start with YY_,
-   are private implementation details.  Do not rely on them.  */
-
-/* Identify Bison output.  */
-#define YYBISON 1
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
 
-/* Bison version.  */
-#define YYBISON_VERSION "3.5.1"
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
 
 /* Pure parsers.  */
-#define YYPURE 0
+#define YYPURE 2
 
 /* Push parsers.  */
 #define YYPUSH 0
@@ -69,39 +70,46 @@
 #define yyerror         cool_yyerror
 #define yydebug         cool_yydebug
 #define yynerrs         cool_yynerrs
-#define yylval          cool_yylval
-#define yychar          cool_yychar
-#define yylloc          cool_yylloc
 
 /* First part of user prologue.  */
-#line 6 "cool.y"
+#line 19 "cool.y"
 
 #include "cool-tree.h"
 #include "stringtab.h"
 #include "utilities.h"
-
-/* Set the size of the parser stack to be sufficient large to accomodate
-    our tests.  There seems to be some problem with Bison's dynamic
-    reallocation of the parser stack, as it should resize to a max
-    size of YYMAXDEPTH, which is by default 10000. */
-#define YYINITDEPTH 3000
-
-/* Locations */
-#define YYLTYPE int              /* the type of locations */
-#define cool_yylloc curr_lineno  /* use the curr_lineno from the lexer
-                                    for the location of tokens */
-extern int node_lineno;          /* set before constructing a tree node
-                                    to whatever you want the line number
-                                    for the tree node to be */
+#include "handle_flags.h"
+#include "cool-lex.h"
+#include "parse-stats.h"
+
+/* The parser's stacks start out in cool_yyparse()'s frame, YYINITDEPTH
+    deep, and are moved to the heap and doubled whenever they fill, up to
+    --max-parse-depth entries; past that, or if malloc fails, the parse
+    ends with "memory exhausted".  In C++ Bison moves the stacks only if
+    the value and location types are known to be trivial, which is why
+    the locations are its own YYLTYPE and not simply an int. */
+#define YYINITDEPTH 1000
+#define YYMAXDEPTH max_parse_depth
+
+/* Locations.  node_lineno (tree.h) is set before constructing a tree
+    node to whatever you want the line number for the tree node to be. */
 
 /* The default action for locations.  Use the location of the first
-    terminal/non-terminal and set the node_lineno to that value. */
+    terminal/non-terminal and set the node_lineno to that value.
+    Bison uses it before every reduction's action, which -P counts. */
 #define YYLLOC_DEFAULT(Current, Rhs, N)		  \
   Current = (Rhs)[1];                             \
-  node_lineno = Current;
+  node_lineno = (Current).first_line;             \
+  STATS_PHASE(PHASE_BUILD);                       \
+  parse_stats.reductions++;
+
+/* yyerrok, for the actions of the error rules, which -P counts as the
+    errors recovered from. */
+#define RECOVERED                                 \
+  parse_stats.recoveries++;                       \
+  yyerrok;
 
 #define SET_NODELOC(Current)			\
-  node_lineno = Current;
+  node_lineno = (Current).first_line;
 
 /* IMPORTANT NOTE ON LINE NUMBERS
 *********************************
@@ -145,15 +153,16 @@ $$ = plus(int_const($1), int_const($3));
 
 */
 
-extern char *curr_filename;
+/* The parser is reentrant: everything it would otherwise keep in
+    globals, the scanner, the file name, the result and the error count,
+    is in the Parse_State passed to cool_yyparse() and on to the lexer.
+    See cool-lex.h. */
 
-void yyerror(const char *s);  /*  defined below; called for each parse error */
-extern int yylex();           /*  the entry point to the lexer  */
-Program ast_root;	      /* the result of the parse  */
-Classes parse_results;        /* for use in semantic analysis */
-int omerrs = 0;               /* number of erros in lexing and parsing */
+/* yyerror, called for each parse error, and add_class, which adds a
+    class to the program or streams it out, are defined below and
+    declared in cool-lex.h; descent-parse.cc uses them too. */
 
-#line 157 "cool-parse.cc"
+#line 166 "cool-parse.cc"
 
 # ifndef YY_CAST
 #  ifdef __cplusplus
@@ -176,136 +185,75 @@ int omerrs = 0;               /* number of erros in lexing and parsing */
 #  endif
 # endif
 
-/* Enabling verbose error messages.  */
-#ifdef YYERROR_VERBOSE
-# undef YYERROR_VERBOSE
-# define YYERROR_VERBOSE 1
-#else
-# define YYERROR_VERBOSE 0
-#endif
-
-/* Use api.header.include to #include this header
-   instead of duplicating it here.  */
-#ifndef YY_COOL_YY_COOL_PARSE_HH_INCLUDED
-# define YY_COOL_YY_COOL_PARSE_HH_INCLUDED
-/* Debug traces.  */
-#ifndef YYDEBUG
-# define YYDEBUG 1
-#endif
-#if YYDEBUG
-extern int cool_yydebug;
-#endif
-
-/* Token type.  */
-#ifndef YYTOKENTYPE
-# define YYTOKENTYPE
-  enum yytokentype
-  {
-    CLASS = 258,
-    ELSE = 259,
-    FI = 260,
-    IF = 261,
-    IN = 262,
-    INHERITS = 263,
-    LET = 264,
-    LOOP = 265,
-    POOL = 266,
-    THEN = 267,
-    WHILE = 268,
-    CASE = 269,
-    ESAC = 270,
-    OF = 271,
-    DARROW = 272,
-    NEW = 273,
-    ISVOID = 274,
-    STR_CONST = 275,
-    INT_CONST = 276,
-    BOOL_CONST = 277,
-    TYPEID = 278,
-    OBJECTID = 279,
-    ASSIGN = 280,
-    NOT = 281,
-    LE = 282,
-    ERROR = 283
-  };
-#endif
-/* Tokens.  */
-#define CLASS 258
-#define ELSE 259
-#define FI 260
-#define IF 261
-#define IN 262
-#define INHERITS 263
-#define LET 264
-#define LOOP 265
-#define POOL 266
-#define THEN 267
-#define WHILE 268
-#define CASE 269
-#define ESAC 270
-#define OF 271
-#define DARROW 272
-#define NEW 273
-#define ISVOID 274
-#define STR_CONST 275
-#define INT_CONST 276
-#define BOOL_CONST 277
-#define TYPEID 278
-#define OBJECTID 279
-#define ASSIGN 280
-#define NOT 281
-#define LE 282
-#define ERROR 283
-
-/* Value type.  */
-#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-union YYSTYPE
-{
-#line 86 "cool.y"
-
-  bool boolean;
-  Symbol symbol;
-  Program program;
-  Class_ class_;
-  Classes classes;
-  Feature feature;
-  Features features;
-  Formal formal;
-  Formals formals;
-  Case case_;
-  Cases cases;
-  Expression expression;
-  Expressions expressions;
-  const char *error_msg;
-
-#line 282 "cool-parse.cc"
-
-};
-typedef union YYSTYPE YYSTYPE;
-# define YYSTYPE_IS_TRIVIAL 1
-# define YYSTYPE_IS_DECLARED 1
-#endif
-
-/* Location type.  */
-#if ! defined YYLTYPE && ! defined YYLTYPE_IS_DECLARED
-typedef struct YYLTYPE YYLTYPE;
-struct YYLTYPE
+#include "cool-parse.hh"
+/* Symbol kind.  */
+enum yysymbol_kind_t
 {
-  int first_line;
-  int first_column;
-  int last_line;
-  int last_column;
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_CLASS = 3,                      /* CLASS  */
+  YYSYMBOL_ELSE = 4,                       /* ELSE  */
+  YYSYMBOL_FI = 5,                         /* FI  */
+  YYSYMBOL_IF = 6,                         /* IF  */
+  YYSYMBOL_IN = 7,                         /* IN  */
+  YYSYMBOL_INHERITS = 8,                   /* INHERITS  */
+  YYSYMBOL_LET = 9,                        /* LET  */
+  YYSYMBOL_LOOP = 10,                      /* LOOP  */
+  YYSYMBOL_POOL = 11,                      /* POOL  */
+  YYSYMBOL_THEN = 12,                      /* THEN  */
+  YYSYMBOL_WHILE = 13,                     /* WHILE  */
+  YYSYMBOL_CASE = 14,                      /* CASE  */
+  YYSYMBOL_ESAC = 15,                      /* ESAC  */
+  YYSYMBOL_OF = 16,                        /* OF  */
+  YYSYMBOL_DARROW = 17,                    /* DARROW  */
+  YYSYMBOL_NEW = 18,                       /* NEW  */
+  YYSYMBOL_ISVOID = 19,                    /* ISVOID  */
+  YYSYMBOL_STR_CONST = 20,                 /* STR_CONST  */
+  YYSYMBOL_INT_CONST = 21,                 /* INT_CONST  */
+  YYSYMBOL_BOOL_CONST = 22,                /* BOOL_CONST  */
+  YYSYMBOL_TYPEID = 23,                    /* TYPEID  */
+  YYSYMBOL_OBJECTID = 24,                  /* OBJECTID  */
+  YYSYMBOL_ASSIGN = 25,                    /* ASSIGN  */
+  YYSYMBOL_NOT = 26,                       /* NOT  */
+  YYSYMBOL_LE = 27,                        /* LE  */
+  YYSYMBOL_ERROR = 28,                     /* ERROR  */
+  YYSYMBOL_29_ = 29,                       /* '<'  */
+  YYSYMBOL_30_ = 30,                       /* '='  */
+  YYSYMBOL_31_ = 31,                       /* '+'  */
+  YYSYMBOL_32_ = 32,                       /* '-'  */
+  YYSYMBOL_33_ = 33,                       /* '*'  */
+  YYSYMBOL_34_ = 34,                       /* '/'  */
+  YYSYMBOL_35_ = 35,                       /* '~'  */
+  YYSYMBOL_36_ = 36,                       /* '@'  */
+  YYSYMBOL_37_ = 37,                       /* '.'  */
+  YYSYMBOL_38_ = 38,                       /* ';'  */
+  YYSYMBOL_39_ = 39,                       /* '{'  */
+  YYSYMBOL_40_ = 40,                       /* '}'  */
+  YYSYMBOL_41_ = 41,                       /* ':'  */
+  YYSYMBOL_42_ = 42,                       /* '('  */
+  YYSYMBOL_43_ = 43,                       /* ')'  */
+  YYSYMBOL_44_ = 44,                       /* ','  */
+  YYSYMBOL_YYACCEPT = 45,                  /* $accept  */
+  YYSYMBOL_program = 46,                   /* program  */
+  YYSYMBOL_class_list = 47,                /* class_list  */
+  YYSYMBOL_class = 48,                     /* class  */
+  YYSYMBOL_optional_feature_list = 49,     /* optional_feature_list  */
+  YYSYMBOL_feature_list = 50,              /* feature_list  */
+  YYSYMBOL_feature = 51,                   /* feature  */
+  YYSYMBOL_formals = 52,                   /* formals  */
+  YYSYMBOL_formal_list = 53,               /* formal_list  */
+  YYSYMBOL_formal = 54,                    /* formal  */
+  YYSYMBOL_expr = 55,                      /* expr  */
+  YYSYMBOL_expr_list = 56,                 /* expr_list  */
+  YYSYMBOL_expr_block_list = 57,           /* expr_block_list  */
+  YYSYMBOL_case_list = 58,                 /* case_list  */
+  YYSYMBOL_case = 59,                      /* case  */
+  YYSYMBOL_let_body = 60                   /* let_body  */
 };
-# define YYLTYPE_IS_DECLARED 1
-# define YYLTYPE_IS_TRIVIAL 1
-#endif
-
+typedef enum yysymbol_kind_t yysymbol_kind_t;
 
-extern YYSTYPE cool_yylval;
-extern YYLTYPE cool_yylloc;
-int cool_yyparse (void);
-
-#endif /* !YY_COOL_YY_COOL_PARSE_HH_INCLUDED  */
 
 
 
@@ -346,6 +294,18 @@ typedef int_least16_t yytype_int16;
 typedef short yytype_int16;
 #endif
 
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
 #if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
 typedef __UINT_LEAST8_TYPE__ yytype_uint8;
 #elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
@@ -405,6 +365,7 @@ typedef int yytype_uint16;
 
 #define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
 
+
 /* Stored state numbers (used for stacks). */
 typedef yytype_uint8 yy_state_t;
 
@@ -423,6 +384,7 @@ typedef int yy_state_fast_t;
 # endif
 #endif
 
+
 #ifndef YY_ATTRIBUTE_PURE
 # if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
 #  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
@@ -441,17 +403,23 @@ typedef int yy_state_fast_t;
 
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
-# define YYUSE(E) ((void) (E))
+# define YY_USE(E) ((void) (E))
 #else
-# define YYUSE(E) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
-#if defined __GNUC__ && ! defined __ICC && 407 <= __GNUC__ * 100 + __GNUC_MINOR__
 /* Suppress an incorrect diagnostic about yylval being uninitialized.  */
-# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                            \
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
     _Pragma ("GCC diagnostic push")                                     \
     _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
     _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
 # define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
     _Pragma ("GCC diagnostic pop")
 #else
@@ -480,7 +448,7 @@ typedef int yy_state_fast_t;
 
 #define YY_ASSERT(E) ((void) (0 && (E)))
 
-#if ! defined yyoverflow || YYERROR_VERBOSE
+#if !defined yyoverflow
 
 /* The parser invokes alloca or malloc; define the necessary symbols.  */
 
@@ -545,8 +513,7 @@ void free (void *); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 # endif
-#endif /* ! defined yyoverflow || YYERROR_VERBOSE */
-
+#endif /* !defined yyoverflow */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
@@ -625,14 +592,16 @@ union yyalloc
 /* YYNSTATES -- Number of states.  */
 #define YYNSTATES  160
 
-#define YYUNDEFTOK  2
+/* YYMAXUTOK -- Last valid token kind.  */
 #define YYMAXUTOK   284
 
 
 /* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
    as returned by yylex, with out-of-bounds checking.  */
-#define YYTRANSLATE(YYX)                                                \
-  (0 <= (YYX) && (YYX) <= YYMAXUTOK ? yytranslate[YYX] : YYUNDEFTOK)
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
 
 /* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
    as returned by yylex.  */
@@ -670,48 +639,48 @@ static const yytype_int8 yytranslate[] =
 };
 
 #if YYDEBUG
-  /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_int16 yyrline[] =
 {
-       0,   161,   161,   164,   167,   169,   172,   177,   180,   185,
-     186,   189,   191,   193,   195,   200,   202,   204,   207,   209,
-     212,   214,   217,   220,   222,   224,   226,   228,   230,   232,
-     234,   236,   238,   240,   242,   244,   246,   248,   250,   252,
-     254,   256,   258,   260,   262,   264,   266,   268,   270,   272,
-     274,   277,   279,   282,   284,   287,   289,   293,   295,   298,
-     301,   303,   305,   307,   309,   312
+       0,   189,   189,   195,   198,   200,   203,   208,   211,   216,
+     217,   220,   222,   224,   226,   231,   233,   235,   238,   240,
+     243,   245,   248,   251,   253,   255,   257,   259,   261,   263,
+     265,   267,   269,   271,   273,   275,   277,   279,   281,   283,
+     285,   287,   289,   291,   293,   295,   297,   299,   301,   303,
+     305,   308,   310,   313,   315,   318,   320,   324,   326,   329,
+     332,   334,   336,   338,   340,   343
 };
 #endif
 
-#if YYDEBUG || YYERROR_VERBOSE || 0
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
 /* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
    First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
 static const char *const yytname[] =
 {
-  "$end", "error", "$undefined", "CLASS", "ELSE", "FI", "IF", "IN",
-  "INHERITS", "LET", "LOOP", "POOL", "THEN", "WHILE", "CASE", "ESAC", "OF",
-  "DARROW", "NEW", "ISVOID", "STR_CONST", "INT_CONST", "BOOL_CONST",
-  "TYPEID", "OBJECTID", "ASSIGN", "NOT", "LE", "ERROR", "'<'", "'='",
-  "'+'", "'-'", "'*'", "'/'", "'~'", "'@'", "'.'", "';'", "'{'", "'}'",
-  "':'", "'('", "')'", "','", "$accept", "program", "class_list", "class",
-  "optional_feature_list", "feature_list", "feature", "formals",
-  "formal_list", "formal", "expr", "expr_list", "expr_block_list",
-  "case_list", "case", "let_body", YY_NULLPTR
+  "\"end of file\"", "error", "\"invalid token\"", "CLASS", "ELSE", "FI",
+  "IF", "IN", "INHERITS", "LET", "LOOP", "POOL", "THEN", "WHILE", "CASE",
+  "ESAC", "OF", "DARROW", "NEW", "ISVOID", "STR_CONST", "INT_CONST",
+  "BOOL_CONST", "TYPEID", "OBJECTID", "ASSIGN", "NOT", "LE", "ERROR",
+  "'<'", "'='", "'+'", "'-'", "'*'", "'/'", "'~'", "'@'", "'.'", "';'",
+  "'{'", "'}'", "':'", "'('", "')'", "','", "$accept", "program",
+  "class_list", "class", "optional_feature_list", "feature_list",
+  "feature", "formals", "formal_list", "formal", "expr", "expr_list",
+  "expr_block_list", "case_list", "case", "let_body", YY_NULLPTR
 };
-#endif
 
-# ifdef YYPRINT
-/* YYTOKNUM[NUM] -- (External) token number corresponding to the
-   (internal) symbol number NUM (which must be that of a token).  */
-static const yytype_int16 yytoknum[] =
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
 {
-       0,   256,   284,   258,   259,   260,   261,   262,   263,   264,
-     265,   266,   267,   268,   269,   270,   271,   272,   273,   274,
-     275,   276,   277,   278,   279,   280,   281,   282,   283,    60,
-      61,    43,    45,    42,    47,   126,    64,    46,    59,   123,
-     125,    58,    40,    41,    44
-};
-# endif
+  return yytname[yysymbol];
+}
+#endif
 
 #define YYPACT_NINF (-118)
 
@@ -723,8 +692,8 @@ static const yytype_int16 yytoknum[] =
 #define yytable_value_is_error(Yyn) \
   ((Yyn) == YYTABLE_NINF)
 
-  /* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
-     STATE-NUM.  */
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
 static const yytype_int16 yypact[] =
 {
       56,   -33,    -8,    37,    26,  -118,  -118,    -4,  -118,   -10,
@@ -745,9 +714,9 @@ static const yytype_int16 yypact[] =
      228,     0,   228,  -118,    59,   381,  -118,   369,  -118,  -118
 };
 
-  /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
-     Performed when YYTABLE does not specify something else to do.  Zero
-     means the default is an error.  */
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
 static const yytype_int8 yydefact[] =
 {
        0,     0,     0,     0,     0,     3,     4,     0,     1,     0,
@@ -768,23 +737,23 @@ static const yytype_int8 yydefact[] =
        0,     0,     0,    26,     0,    61,    63,     0,    27,    59
 };
 
-  /* YYPGOTO[NTERM-NUM].  */
+/* YYPGOTO[NTERM-NUM].  */
 static const yytype_int16 yypgoto[] =
 {
     -118,  -118,  -118,   148,   135,  -118,   138,  -118,  -118,   114,
      -40,  -117,  -118,  -118,    42,   -85
 };
 
-  /* YYDEFGOTO[NTERM-NUM].  */
+/* YYDEFGOTO[NTERM-NUM].  */
 static const yytype_int8 yydefgoto[] =
 {
-      -1,     3,     4,     5,    17,    18,    19,    24,    33,    34,
+       0,     3,     4,     5,    17,    18,    19,    24,    33,    34,
       98,    99,    78,   122,   123,    67
 };
 
-  /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
-     positive, shift that token.  If negative, reduce the rule whose
-     number is the opposite.  If YYTABLE_NINF, syntax error.  */
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_int16 yytable[] =
 {
       60,    65,   131,    31,    11,     6,    64,   118,    68,    69,
@@ -879,8 +848,8 @@ static const yytype_int16 yycheck[] =
       -1,    29,    30,    31,    32,    33,    34,    -1,    36,    37
 };
 
-  /* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-     symbol of state STATE-NUM.  */
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
 static const yytype_int8 yystos[] =
 {
        0,     1,     3,    46,    47,    48,    38,    23,     0,     1,
@@ -901,7 +870,7 @@ static const yytype_int8 yystos[] =
        7,    44,    17,    43,    56,    55,    60,    55,    43,    38
 };
 
-  /* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr1[] =
 {
        0,    45,    46,    47,    47,    47,    47,    48,    48,    49,
@@ -913,7 +882,7 @@ static const yytype_int8 yyr1[] =
       60,    60,    60,    60,    60,    60
 };
 
-  /* YYR2[YYN] -- Number of symbols on the right hand side of rule YYN.  */
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr2[] =
 {
        0,     2,     1,     1,     2,     2,     3,     6,     8,     0,
@@ -926,14 +895,15 @@ static const yytype_int8 yyr2[] =
 };
 
 
+enum { YYENOMEM = -2 };
+
 #define yyerrok         (yyerrstatus = 0)
 #define yyclearin       (yychar = YYEMPTY)
-#define YYEMPTY         (-2)
-#define YYEOF           0
 
 #define YYACCEPT        goto yyacceptlab
 #define YYABORT         goto yyabortlab
 #define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
 
 
 #define YYRECOVERING()  (!!yyerrstatus)
@@ -950,15 +920,14 @@ static const yytype_int8 yyr2[] =
       }                                                           \
     else                                                          \
       {                                                           \
-        yyerror (YY_("syntax error: cannot back up")); \
+        yyerror (&yylloc, ps, YY_("syntax error: cannot back up")); \
         YYERROR;                                                  \
       }                                                           \
   while (0)
 
-/* Error token number */
-#define YYTERROR        1
-#define YYERRCODE       256
-
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
 
 /* YYLLOC_DEFAULT -- Set CURRENT to span from RHS[1] to RHS[N].
    If N is 0, then set CURRENT to the empty location which ends
@@ -1002,12 +971,19 @@ do {                                            \
 } while (0)
 
 
-/* YY_LOCATION_PRINT -- Print the location on the stream.
+/* YYLOCATION_PRINT -- Print the location on the stream.
    This macro was not mandated originally: define only if we know
    we won't break user code: when these are the locations we know.  */
 
-#ifndef YY_LOCATION_PRINT
-# if defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+# ifndef YYLOCATION_PRINT
+
+#  if defined YY_LOCATION_PRINT
+
+   /* Temporary convenience wrapper in case some people defined the
+      undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YYLOCATION_PRINT(File, Loc)  YY_LOCATION_PRINT(File, *(Loc))
+
+#  elif defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
 
 /* Print *YYLOCP on YYO.  Private, do not rely on its existence. */
 
@@ -1035,24 +1011,32 @@ yy_location_print_ (FILE *yyo, YYLTYPE const * const yylocp)
         res += YYFPRINTF (yyo, "-%d", end_col);
     }
   return res;
- }
+}
 
-#  define YY_LOCATION_PRINT(File, Loc)          \
-  yy_location_print_ (File, &(Loc))
+#   define YYLOCATION_PRINT  yy_location_print_
 
-# else
-#  define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-# endif
-#endif
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT(File, Loc)  YYLOCATION_PRINT(File, &(Loc))
 
+#  else
 
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)                    \
+#   define YYLOCATION_PRINT(File, Loc) ((void) 0)
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT  YYLOCATION_PRINT
+
+#  endif
+# endif /* !defined YYLOCATION_PRINT */
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
 do {                                                                      \
   if (yydebug)                                                            \
     {                                                                     \
       YYFPRINTF (stderr, "%s ", Title);                                   \
       yy_symbol_print (stderr,                                            \
-                  Type, Value, Location); \
+                  Kind, Value, Location, ps); \
       YYFPRINTF (stderr, "\n");                                           \
     }                                                                     \
 } while (0)
@@ -1063,19 +1047,17 @@ do {                                                                      \
 `-----------------------------------*/
 
 static void
-yy_symbol_value_print (FILE *yyo, int yytype, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp)
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp, Parse_State *ps)
 {
   FILE *yyoutput = yyo;
-  YYUSE (yyoutput);
-  YYUSE (yylocationp);
+  YY_USE (yyoutput);
+  YY_USE (yylocationp);
+  YY_USE (ps);
   if (!yyvaluep)
     return;
-# ifdef YYPRINT
-  if (yytype < YYNTOKENS)
-    YYPRINT (yyo, yytoknum[yytype], *yyvaluep);
-# endif
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-  YYUSE (yytype);
+  YY_USE (yykind);
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
@@ -1085,14 +1067,15 @@ yy_symbol_value_print (FILE *yyo, int yytype, YYSTYPE const * const yyvaluep, YY
 `---------------------------*/
 
 static void
-yy_symbol_print (FILE *yyo, int yytype, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp)
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp, Parse_State *ps)
 {
   YYFPRINTF (yyo, "%s %s (",
-             yytype < YYNTOKENS ? "token" : "nterm", yytname[yytype]);
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  YY_LOCATION_PRINT (yyo, *yylocationp);
+  YYLOCATION_PRINT (yyo, yylocationp);
   YYFPRINTF (yyo, ": ");
-  yy_symbol_value_print (yyo, yytype, yyvaluep, yylocationp);
+  yy_symbol_value_print (yyo, yykind, yyvaluep, yylocationp, ps);
   YYFPRINTF (yyo, ")");
 }
 
@@ -1125,7 +1108,8 @@ do {                                                            \
 `------------------------------------------------*/
 
 static void
-yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp, int yyrule)
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp,
+                 int yyrule, Parse_State *ps)
 {
   int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
@@ -1137,9 +1121,9 @@ yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp, int yyrule)
     {
       YYFPRINTF (stderr, "   $%d = ", yyi + 1);
       yy_symbol_print (stderr,
-                       yystos[+yyssp[yyi + 1 - yynrhs]],
-                       &yyvsp[(yyi + 1) - (yynrhs)]
-                       , &(yylsp[(yyi + 1) - (yynrhs)])                       );
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)],
+                       &(yylsp[(yyi + 1) - (yynrhs)]), ps);
       YYFPRINTF (stderr, "\n");
     }
 }
@@ -1147,15 +1131,15 @@ yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp, int yyrule)
 # define YY_REDUCE_PRINT(Rule)          \
 do {                                    \
   if (yydebug)                          \
-    yy_reduce_print (yyssp, yyvsp, yylsp, Rule); \
+    yy_reduce_print (yyssp, yyvsp, yylsp, Rule, ps); \
 } while (0)
 
 /* Nonzero means print parse trace.  It is left uninitialized so that
    multiple parsers can coexist.  */
 int yydebug;
 #else /* !YYDEBUG */
-# define YYDPRINTF(Args)
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
 # define YY_STACK_PRINT(Bottom, Top)
 # define YY_REDUCE_PRINT(Rule)
 #endif /* !YYDEBUG */
@@ -1178,328 +1162,102 @@ int yydebug;
 #endif
 
 
-#if YYERROR_VERBOSE
-
-# ifndef yystrlen
-#  if defined __GLIBC__ && defined _STRING_H
-#   define yystrlen(S) (YY_CAST (YYPTRDIFF_T, strlen (S)))
-#  else
-/* Return the length of YYSTR.  */
-static YYPTRDIFF_T
-yystrlen (const char *yystr)
-{
-  YYPTRDIFF_T yylen;
-  for (yylen = 0; yystr[yylen]; yylen++)
-    continue;
-  return yylen;
-}
-#  endif
-# endif
-
-# ifndef yystpcpy
-#  if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
-#   define yystpcpy stpcpy
-#  else
-/* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
-   YYDEST.  */
-static char *
-yystpcpy (char *yydest, const char *yysrc)
-{
-  char *yyd = yydest;
-  const char *yys = yysrc;
-
-  while ((*yyd++ = *yys++) != '\0')
-    continue;
 
-  return yyd - 1;
-}
-#  endif
-# endif
 
-# ifndef yytnamerr
-/* Copy to YYRES the contents of YYSTR after stripping away unnecessary
-   quotes and backslashes, so that it's suitable for yyerror.  The
-   heuristic is that double-quoting is unnecessary unless the string
-   contains an apostrophe, a comma, or backslash (other than
-   backslash-backslash).  YYSTR is taken from yytname.  If YYRES is
-   null, do not copy; instead, return the length of what the result
-   would have been.  */
-static YYPTRDIFF_T
-yytnamerr (char *yyres, const char *yystr)
-{
-  if (*yystr == '"')
-    {
-      YYPTRDIFF_T yyn = 0;
-      char const *yyp = yystr;
-
-      for (;;)
-        switch (*++yyp)
-          {
-          case '\'':
-          case ',':
-            goto do_not_strip_quotes;
-
-          case '\\':
-            if (*++yyp != '\\')
-              goto do_not_strip_quotes;
-            else
-              goto append;
-
-          append:
-          default:
-            if (yyres)
-              yyres[yyn] = *yyp;
-            yyn++;
-            break;
-
-          case '"':
-            if (yyres)
-              yyres[yyn] = '\0';
-            return yyn;
-          }
-    do_not_strip_quotes: ;
-    }
 
-  if (yyres)
-    return yystpcpy (yyres, yystr) - yyres;
-  else
-    return yystrlen (yystr);
-}
-# endif
-
-/* Copy into *YYMSG, which is of size *YYMSG_ALLOC, an error message
-   about the unexpected token YYTOKEN for the state stack whose top is
-   YYSSP.
-
-   Return 0 if *YYMSG was successfully written.  Return 1 if *YYMSG is
-   not large enough to hold the message.  In that case, also set
-   *YYMSG_ALLOC to the required number of bytes.  Return 2 if the
-   required number of bytes is too large to store.  */
-static int
-yysyntax_error (YYPTRDIFF_T *yymsg_alloc, char **yymsg,
-                yy_state_t *yyssp, int yytoken)
-{
-  enum { YYERROR_VERBOSE_ARGS_MAXIMUM = 5 };
-  /* Internationalized format string. */
-  const char *yyformat = YY_NULLPTR;
-  /* Arguments of yyformat: reported tokens (one for the "unexpected",
-     one per "expected"). */
-  char const *yyarg[YYERROR_VERBOSE_ARGS_MAXIMUM];
-  /* Actual size of YYARG. */
-  int yycount = 0;
-  /* Cumulated lengths of YYARG.  */
-  YYPTRDIFF_T yysize = 0;
-
-  /* There are many possibilities here to consider:
-     - If this state is a consistent state with a default action, then
-       the only way this function was invoked is if the default action
-       is an error action.  In that case, don't check for expected
-       tokens because there are none.
-     - The only way there can be no lookahead present (in yychar) is if
-       this state is a consistent state with a default action.  Thus,
-       detecting the absence of a lookahead is sufficient to determine
-       that there is no unexpected or expected token to report.  In that
-       case, just report a simple "syntax error".
-     - Don't assume there isn't a lookahead just because this state is a
-       consistent state with a default action.  There might have been a
-       previous inconsistent state, consistent state with a non-default
-       action, or user semantic action that manipulated yychar.
-     - Of course, the expected token list depends on states to have
-       correct lookahead information, and it depends on the parser not
-       to perform extra reductions after fetching a lookahead from the
-       scanner and before detecting a syntax error.  Thus, state merging
-       (from LALR or IELR) and default reductions corrupt the expected
-       token list.  However, the list is correct for canonical LR with
-       one exception: it will still contain any token that will not be
-       accepted due to an error action in a later state.
-  */
-  if (yytoken != YYEMPTY)
-    {
-      int yyn = yypact[+*yyssp];
-      YYPTRDIFF_T yysize0 = yytnamerr (YY_NULLPTR, yytname[yytoken]);
-      yysize = yysize0;
-      yyarg[yycount++] = yytname[yytoken];
-      if (!yypact_value_is_default (yyn))
-        {
-          /* Start YYX at -YYN if negative to avoid negative indexes in
-             YYCHECK.  In other words, skip the first -YYN actions for
-             this state because they are default actions.  */
-          int yyxbegin = yyn < 0 ? -yyn : 0;
-          /* Stay within bounds of both yycheck and yytname.  */
-          int yychecklim = YYLAST - yyn + 1;
-          int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
-          int yyx;
-
-          for (yyx = yyxbegin; yyx < yyxend; ++yyx)
-            if (yycheck[yyx + yyn] == yyx && yyx != YYTERROR
-                && !yytable_value_is_error (yytable[yyx + yyn]))
-              {
-                if (yycount == YYERROR_VERBOSE_ARGS_MAXIMUM)
-                  {
-                    yycount = 1;
-                    yysize = yysize0;
-                    break;
-                  }
-                yyarg[yycount++] = yytname[yyx];
-                {
-                  YYPTRDIFF_T yysize1
-                    = yysize + yytnamerr (YY_NULLPTR, yytname[yyx]);
-                  if (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM)
-                    yysize = yysize1;
-                  else
-                    return 2;
-                }
-              }
-        }
-    }
-
-  switch (yycount)
-    {
-# define YYCASE_(N, S)                      \
-      case N:                               \
-        yyformat = S;                       \
-      break
-    default: /* Avoid compiler warnings. */
-      YYCASE_(0, YY_("syntax error"));
-      YYCASE_(1, YY_("syntax error, unexpected %s"));
-      YYCASE_(2, YY_("syntax error, unexpected %s, expecting %s"));
-      YYCASE_(3, YY_("syntax error, unexpected %s, expecting %s or %s"));
-      YYCASE_(4, YY_("syntax error, unexpected %s, expecting %s or %s or %s"));
-      YYCASE_(5, YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s"));
-# undef YYCASE_
-    }
-
-  {
-    /* Don't count the "%s"s in the final size, but reserve room for
-       the terminator.  */
-    YYPTRDIFF_T yysize1 = yysize + (yystrlen (yyformat) - 2 * yycount) + 1;
-    if (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM)
-      yysize = yysize1;
-    else
-      return 2;
-  }
-
-  if (*yymsg_alloc < yysize)
-    {
-      *yymsg_alloc = 2 * yysize;
-      if (! (yysize <= *yymsg_alloc
-             && *yymsg_alloc <= YYSTACK_ALLOC_MAXIMUM))
-        *yymsg_alloc = YYSTACK_ALLOC_MAXIMUM;
-      return 1;
-    }
-
-  /* Avoid sprintf, as that infringes on the user's name space.
-     Don't have undefined behavior even if the translation
-     produced a string with the wrong number of "%s"s.  */
-  {
-    char *yyp = *yymsg;
-    int yyi = 0;
-    while ((*yyp = *yyformat) != '\0')
-      if (*yyp == '%' && yyformat[1] == 's' && yyi < yycount)
-        {
-          yyp += yytnamerr (yyp, yyarg[yyi++]);
-          yyformat += 2;
-        }
-      else
-        {
-          ++yyp;
-          ++yyformat;
-        }
-  }
-  return 0;
-}
-#endif /* YYERROR_VERBOSE */
 
 /*-----------------------------------------------.
 | Release the memory associated to this symbol.  |
 `-----------------------------------------------*/
 
 static void
-yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep, YYLTYPE *yylocationp)
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, YYLTYPE *yylocationp, Parse_State *ps)
 {
-  YYUSE (yyvaluep);
-  YYUSE (yylocationp);
+  YY_USE (yyvaluep);
+  YY_USE (yylocationp);
+  YY_USE (ps);
   if (!yymsg)
     yymsg = "Deleting";
-  YY_SYMBOL_PRINT (yymsg, yytype, yyvaluep, yylocationp);
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-  YYUSE (yytype);
+  YY_USE (yykind);
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
 
 
-/* The lookahead symbol.  */
+
+
+/*----------.
+| yyparse.  |
+`----------*/
+
+int
+yyparse (Parse_State *ps)
+{
+/* Lookahead token kind.  */
 int yychar;
 
+
 /* The semantic value of the lookahead symbol.  */
-YYSTYPE yylval;
+/* Default value used for initialization, for pacifying older GCCs
+   or non-GCC compilers.  */
+YY_INITIAL_VALUE (static YYSTYPE yyval_default;)
+YYSTYPE yylval YY_INITIAL_VALUE (= yyval_default);
+
 /* Location data for the lookahead symbol.  */
-YYLTYPE yylloc
+static YYLTYPE yyloc_default
 # if defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
   = { 1, 1, 1, 1 }
 # endif
 ;
-/* Number of syntax errors so far.  */
-int yynerrs;
-
+YYLTYPE yylloc = yyloc_default;
 
-/*----------.
-| yyparse.  |
-`----------*/
+    /* Number of syntax errors so far.  */
+    int yynerrs = 0;
 
-int
-yyparse (void)
-{
-    yy_state_fast_t yystate;
+    yy_state_fast_t yystate = 0;
     /* Number of tokens to shift before error messages enabled.  */
-    int yyerrstatus;
-
-    /* The stacks and their tools:
-       'yyss': related to states.
-       'yyvs': related to semantic values.
-       'yyls': related to locations.
+    int yyerrstatus = 0;
 
-       Refer to the stacks through separate pointers, to allow yyoverflow
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
        to reallocate them elsewhere.  */
 
-    /* The state stack.  */
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
+
+    /* The state stack: array, bottom, top.  */
     yy_state_t yyssa[YYINITDEPTH];
-    yy_state_t *yyss;
-    yy_state_t *yyssp;
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
 
-    /* The semantic value stack.  */
+    /* The semantic value stack: array, bottom, top.  */
     YYSTYPE yyvsa[YYINITDEPTH];
-    YYSTYPE *yyvs;
-    YYSTYPE *yyvsp;
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
 
-    /* The location stack.  */
+    /* The location stack: array, bottom, top.  */
     YYLTYPE yylsa[YYINITDEPTH];
-    YYLTYPE *yyls;
-    YYLTYPE *yylsp;
-
-    /* The locations where the error started and ended.  */
-    YYLTYPE yyerror_range[3];
-
-    YYPTRDIFF_T yystacksize;
+    YYLTYPE *yyls = yylsa;
+    YYLTYPE *yylsp = yyls;
 
   int yyn;
+  /* The return value of yyparse.  */
   int yyresult;
-  /* Lookahead token as an internal (translated) token number.  */
-  int yytoken = 0;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
   YYLTYPE yyloc;
 
-#if YYERROR_VERBOSE
-  /* Buffer for error messages, and its allocated size.  */
-  char yymsgbuf[128];
-  char *yymsg = yymsgbuf;
-  YYPTRDIFF_T yymsg_alloc = sizeof yymsgbuf;
-#endif
+  /* The locations where the error started and ended.  */
+  YYLTYPE yyerror_range[3];
+
+
 
 #define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N), yylsp -= (N))
 
@@ -1507,17 +1265,10 @@ yyparse (void)
      Keep to zero when no symbol should be popped.  */
   int yylen = 0;
 
-  yyssp = yyss = yyssa;
-  yyvsp = yyvs = yyvsa;
-  yylsp = yyls = yylsa;
-  yystacksize = YYINITDEPTH;
-
   YYDPRINTF ((stderr, "Starting parse\n"));
 
-  yystate = 0;
-  yyerrstatus = 0;
-  yynerrs = 0;
   yychar = YYEMPTY; /* Cause a token to be read.  */
+
   yylsp[0] = yylloc;
   goto yysetstate;
 
@@ -1540,10 +1291,11 @@ yysetstate:
   YY_IGNORE_USELESS_CAST_BEGIN
   *yyssp = YY_CAST (yy_state_t, yystate);
   YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
 
   if (yyss + yystacksize - 1 <= yyssp)
 #if !defined yyoverflow && !defined YYSTACK_RELOCATE
-    goto yyexhaustedlab;
+    YYNOMEM;
 #else
     {
       /* Get the current used size of the three stacks, in elements.  */
@@ -1574,7 +1326,7 @@ yysetstate:
 # else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-        goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
         yystacksize = YYMAXDEPTH;
@@ -1585,11 +1337,11 @@ yysetstate:
           YY_CAST (union yyalloc *,
                    YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
         if (! yyptr)
-          goto yyexhaustedlab;
+          YYNOMEM;
         YYSTACK_RELOCATE (yyss_alloc, yyss);
         YYSTACK_RELOCATE (yyvs_alloc, yyvs);
         YYSTACK_RELOCATE (yyls_alloc, yyls);
-# undef YYSTACK_RELOCATE
+#  undef YYSTACK_RELOCATE
         if (yyss1 != yyssa)
           YYSTACK_FREE (yyss1);
       }
@@ -1609,6 +1361,7 @@ yysetstate:
     }
 #endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
+
   if (yystate == YYFINAL)
     YYACCEPT;
 
@@ -1629,18 +1382,30 @@ yybackup:
 
   /* Not known => get a lookahead token if don't already have one.  */
 
-  /* YYCHAR is either YYEMPTY or YYEOF or a valid lookahead symbol.  */
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
   if (yychar == YYEMPTY)
     {
-      YYDPRINTF ((stderr, "Reading a token: "));
-      yychar = yylex ();
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex (&yylval, &yylloc, ps);
     }
 
   if (yychar <= YYEOF)
     {
-      yychar = yytoken = YYEOF;
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
       YYDPRINTF ((stderr, "Now at end of input.\n"));
     }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      yyerror_range[1] = yylloc;
+      goto yyerrlab1;
+    }
   else
     {
       yytoken = YYTRANSLATE (yychar);
@@ -1712,400 +1477,402 @@ yyreduce:
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-  case 2:
-#line 161 "cool.y"
-                        { (yyloc) = (yylsp[0]); ast_root = program((yyvsp[0].classes)); }
-#line 1719 "cool-parse.cc"
+  case 2: /* program: class_list  */
+#line 190 "cool.y"
+{ (yyloc) = (yylsp[0]);
+  if (ps->make_program)
+    ps->program = program((yyvsp[0].classes)); }
+#line 1486 "cool-parse.cc"
     break;
 
-  case 3:
-#line 165 "cool.y"
-{ (yyval.classes) = single_Classes((yyvsp[0].class_));
-  parse_results = (yyval.classes); }
-#line 1726 "cool-parse.cc"
+  case 3: /* class_list: class  */
+#line 196 "cool.y"
+{ (yyval.classes) = add_class(ps, NULL, (yyvsp[0].class_));
+  ps->classes = (yyval.classes); }
+#line 1493 "cool-parse.cc"
     break;
 
-  case 4:
-#line 168 "cool.y"
-{ yyerrok; }
-#line 1732 "cool-parse.cc"
+  case 4: /* class_list: error ';'  */
+#line 199 "cool.y"
+{ RECOVERED }
+#line 1499 "cool-parse.cc"
     break;
 
-  case 5:
-#line 170 "cool.y"
-{ (yyval.classes) = append_Classes((yyvsp[-1].classes),single_Classes((yyvsp[0].class_)));
-  parse_results = (yyval.classes); }
-#line 1739 "cool-parse.cc"
+  case 5: /* class_list: class_list class  */
+#line 201 "cool.y"
+{ (yyval.classes) = add_class(ps, (yyvsp[-1].classes), (yyvsp[0].class_));
+  ps->classes = (yyval.classes); }
+#line 1506 "cool-parse.cc"
     break;
 
-  case 6:
-#line 173 "cool.y"
+  case 6: /* class_list: class_list error ';'  */
+#line 204 "cool.y"
 { (yyval.classes) = (yyvsp[-2].classes);
-  yyerrok; }
-#line 1746 "cool-parse.cc"
+  RECOVERED }
+#line 1513 "cool-parse.cc"
     break;
 
-  case 7:
-#line 178 "cool.y"
+  case 7: /* class: CLASS TYPEID '{' optional_feature_list '}' ';'  */
+#line 209 "cool.y"
 { (yyval.class_) = class_((yyvsp[-4].symbol),idtable.add_string("Object"),(yyvsp[-2].features),
-        stringtable.add_string(curr_filename)); }
-#line 1753 "cool-parse.cc"
+        stringtable.add_string(ps->filename)); }
+#line 1520 "cool-parse.cc"
     break;
 
-  case 8:
-#line 181 "cool.y"
-{ (yyval.class_) = class_((yyvsp[-6].symbol),(yyvsp[-4].symbol),(yyvsp[-2].features),stringtable.add_string(curr_filename)); }
-#line 1759 "cool-parse.cc"
+  case 8: /* class: CLASS TYPEID INHERITS TYPEID '{' optional_feature_list '}' ';'  */
+#line 212 "cool.y"
+{ (yyval.class_) = class_((yyvsp[-6].symbol),(yyvsp[-4].symbol),(yyvsp[-2].features),stringtable.add_string(ps->filename)); }
+#line 1526 "cool-parse.cc"
     break;
 
-  case 9:
-#line 185 "cool.y"
+  case 9: /* optional_feature_list: %empty  */
+#line 216 "cool.y"
 {  (yyval.features) = nil_Features(); }
-#line 1765 "cool-parse.cc"
+#line 1532 "cool-parse.cc"
     break;
 
-  case 10:
-#line 187 "cool.y"
+  case 10: /* optional_feature_list: feature_list  */
+#line 218 "cool.y"
 { (yyval.features) = (yyvsp[0].features); }
-#line 1771 "cool-parse.cc"
+#line 1538 "cool-parse.cc"
     break;
 
-  case 11:
-#line 190 "cool.y"
+  case 11: /* feature_list: feature ';'  */
+#line 221 "cool.y"
 { (yyval.features) = single_Features((yyvsp[-1].feature)); }
-#line 1777 "cool-parse.cc"
+#line 1544 "cool-parse.cc"
     break;
 
-  case 12:
-#line 192 "cool.y"
-{ yyerrok; }
-#line 1783 "cool-parse.cc"
+  case 12: /* feature_list: error ';'  */
+#line 223 "cool.y"
+{ RECOVERED }
+#line 1550 "cool-parse.cc"
     break;
 
-  case 13:
-#line 194 "cool.y"
+  case 13: /* feature_list: feature_list feature ';'  */
+#line 225 "cool.y"
 { (yyval.features) = append_Features((yyvsp[-2].features), single_Features((yyvsp[-1].feature))); }
-#line 1789 "cool-parse.cc"
+#line 1556 "cool-parse.cc"
     break;
 
-  case 14:
-#line 196 "cool.y"
+  case 14: /* feature_list: feature_list error ';'  */
+#line 227 "cool.y"
 { (yyval.features) = (yyvsp[-2].features);
-  yyerrok; }
-#line 1796 "cool-parse.cc"
+  RECOVERED }
+#line 1563 "cool-parse.cc"
     break;
 
-  case 15:
-#line 201 "cool.y"
+  case 15: /* feature: OBJECTID formals ':' TYPEID '{' expr '}'  */
+#line 232 "cool.y"
 { (yyval.feature) = method((yyvsp[-6].symbol), (yyvsp[-5].formals), (yyvsp[-3].symbol), (yyvsp[-1].expression)); }
-#line 1802 "cool-parse.cc"
+#line 1569 "cool-parse.cc"
     break;
 
-  case 16:
-#line 203 "cool.y"
+  case 16: /* feature: OBJECTID ':' TYPEID  */
+#line 234 "cool.y"
 { (yyval.feature) = attr((yyvsp[-2].symbol), (yyvsp[0].symbol), no_expr()); }
-#line 1808 "cool-parse.cc"
+#line 1575 "cool-parse.cc"
     break;
 
-  case 17:
-#line 205 "cool.y"
+  case 17: /* feature: OBJECTID ':' TYPEID ASSIGN expr  */
+#line 236 "cool.y"
 { (yyval.feature) = attr((yyvsp[-4].symbol), (yyvsp[-2].symbol), (yyvsp[0].expression)); }
-#line 1814 "cool-parse.cc"
+#line 1581 "cool-parse.cc"
     break;
 
-  case 18:
-#line 208 "cool.y"
+  case 18: /* formals: '(' ')'  */
+#line 239 "cool.y"
 { (yyval.formals) = nil_Formals(); }
-#line 1820 "cool-parse.cc"
+#line 1587 "cool-parse.cc"
     break;
 
-  case 19:
-#line 210 "cool.y"
+  case 19: /* formals: '(' formal_list ')'  */
+#line 241 "cool.y"
 { (yyval.formals) = (yyvsp[-1].formals); }
-#line 1826 "cool-parse.cc"
+#line 1593 "cool-parse.cc"
     break;
 
-  case 20:
-#line 213 "cool.y"
+  case 20: /* formal_list: formal  */
+#line 244 "cool.y"
 { (yyval.formals) = single_Formals((yyvsp[0].formal)); }
-#line 1832 "cool-parse.cc"
+#line 1599 "cool-parse.cc"
     break;
 
-  case 21:
-#line 215 "cool.y"
+  case 21: /* formal_list: formal_list ',' formal  */
+#line 246 "cool.y"
 { (yyval.formals) = append_Formals((yyvsp[-2].formals), single_Formals((yyvsp[0].formal))); }
-#line 1838 "cool-parse.cc"
+#line 1605 "cool-parse.cc"
     break;
 
-  case 22:
-#line 218 "cool.y"
+  case 22: /* formal: OBJECTID ':' TYPEID  */
+#line 249 "cool.y"
 { (yyval.formal) = formal((yyvsp[-2].symbol), (yyvsp[0].symbol)); }
-#line 1844 "cool-parse.cc"
+#line 1611 "cool-parse.cc"
     break;
 
-  case 23:
-#line 221 "cool.y"
+  case 23: /* expr: OBJECTID ASSIGN expr  */
+#line 252 "cool.y"
 { (yyval.expression) = assign((yyvsp[-2].symbol), (yyvsp[0].expression)); }
-#line 1850 "cool-parse.cc"
+#line 1617 "cool-parse.cc"
     break;
 
-  case 24:
-#line 223 "cool.y"
+  case 24: /* expr: expr '.' OBJECTID '(' ')'  */
+#line 254 "cool.y"
 { (yyval.expression) = dispatch((yyvsp[-4].expression), (yyvsp[-2].symbol), nil_Expressions()); }
-#line 1856 "cool-parse.cc"
+#line 1623 "cool-parse.cc"
     break;
 
-  case 25:
-#line 225 "cool.y"
+  case 25: /* expr: expr '.' OBJECTID '(' expr_list ')'  */
+#line 256 "cool.y"
 { (yyval.expression) = dispatch((yyvsp[-5].expression), (yyvsp[-3].symbol), (yyvsp[-1].expressions)); }
-#line 1862 "cool-parse.cc"
+#line 1629 "cool-parse.cc"
     break;
 
-  case 26:
-#line 227 "cool.y"
+  case 26: /* expr: expr '@' TYPEID '.' OBJECTID '(' ')'  */
+#line 258 "cool.y"
 { (yyval.expression) = static_dispatch((yyvsp[-6].expression), (yyvsp[-4].symbol), (yyvsp[-2].symbol), nil_Expressions()); }
-#line 1868 "cool-parse.cc"
+#line 1635 "cool-parse.cc"
     break;
 
-  case 27:
-#line 229 "cool.y"
+  case 27: /* expr: expr '@' TYPEID '.' OBJECTID '(' expr_list ')'  */
+#line 260 "cool.y"
 { (yyval.expression) = static_dispatch((yyvsp[-7].expression), (yyvsp[-5].symbol), (yyvsp[-3].symbol), (yyvsp[-1].expressions)); }
-#line 1874 "cool-parse.cc"
+#line 1641 "cool-parse.cc"
     break;
 
-  case 28:
-#line 231 "cool.y"
+  case 28: /* expr: OBJECTID '(' ')'  */
+#line 262 "cool.y"
 { (yyval.expression) = dispatch(object(idtable.add_string("self")), (yyvsp[-2].symbol), nil_Expressions()); }
-#line 1880 "cool-parse.cc"
+#line 1647 "cool-parse.cc"
     break;
 
-  case 29:
-#line 233 "cool.y"
+  case 29: /* expr: OBJECTID '(' expr_list ')'  */
+#line 264 "cool.y"
 { (yyval.expression) = dispatch(object(idtable.add_string("self")), (yyvsp[-3].symbol), (yyvsp[-1].expressions)); }
-#line 1886 "cool-parse.cc"
+#line 1653 "cool-parse.cc"
     break;
 
-  case 30:
-#line 235 "cool.y"
+  case 30: /* expr: IF expr THEN expr ELSE expr FI  */
+#line 266 "cool.y"
 { (yyval.expression) = cond((yyvsp[-5].expression), (yyvsp[-3].expression), (yyvsp[-1].expression)); }
-#line 1892 "cool-parse.cc"
+#line 1659 "cool-parse.cc"
     break;
 
-  case 31:
-#line 237 "cool.y"
+  case 31: /* expr: WHILE expr LOOP expr POOL  */
+#line 268 "cool.y"
 { (yyval.expression) = loop((yyvsp[-3].expression), (yyvsp[-1].expression)); }
-#line 1898 "cool-parse.cc"
+#line 1665 "cool-parse.cc"
     break;
 
-  case 32:
-#line 239 "cool.y"
+  case 32: /* expr: '{' expr_block_list '}'  */
+#line 270 "cool.y"
 { (yyval.expression) = block((yyvsp[-1].expressions)); }
-#line 1904 "cool-parse.cc"
+#line 1671 "cool-parse.cc"
     break;
 
-  case 33:
-#line 241 "cool.y"
+  case 33: /* expr: LET let_body  */
+#line 272 "cool.y"
 { (yyval.expression) = (yyvsp[0].expression); }
-#line 1910 "cool-parse.cc"
+#line 1677 "cool-parse.cc"
     break;
 
-  case 34:
-#line 243 "cool.y"
+  case 34: /* expr: CASE expr OF case_list ESAC  */
+#line 274 "cool.y"
 { (yyval.expression) = typcase((yyvsp[-3].expression), (yyvsp[-1].cases)); }
-#line 1916 "cool-parse.cc"
+#line 1683 "cool-parse.cc"
     break;
 
-  case 35:
-#line 245 "cool.y"
+  case 35: /* expr: NEW TYPEID  */
+#line 276 "cool.y"
 { (yyval.expression) = new_((yyvsp[0].symbol)); }
-#line 1922 "cool-parse.cc"
+#line 1689 "cool-parse.cc"
     break;
 
-  case 36:
-#line 247 "cool.y"
+  case 36: /* expr: ISVOID expr  */
+#line 278 "cool.y"
 { (yyval.expression) = isvoid((yyvsp[0].expression)); }
-#line 1928 "cool-parse.cc"
+#line 1695 "cool-parse.cc"
     break;
 
-  case 37:
-#line 249 "cool.y"
+  case 37: /* expr: expr '+' expr  */
+#line 280 "cool.y"
 { (yyval.expression) = plus((yyvsp[-2].expression), (yyvsp[0].expression)); }
-#line 1934 "cool-parse.cc"
+#line 1701 "cool-parse.cc"
     break;
 
-  case 38:
-#line 251 "cool.y"
+  case 38: /* expr: expr '-' expr  */
+#line 282 "cool.y"
 { (yyval.expression) = sub((yyvsp[-2].expression), (yyvsp[0].expression)); }
-#line 1940 "cool-parse.cc"
+#line 1707 "cool-parse.cc"
     break;
 
-  case 39:
-#line 253 "cool.y"
+  case 39: /* expr: expr '*' expr  */
+#line 284 "cool.y"
 { (yyval.expression) = mul((yyvsp[-2].expression), (yyvsp[0].expression)); }
-#line 1946 "cool-parse.cc"
+#line 1713 "cool-parse.cc"
     break;
 
-  case 40:
-#line 255 "cool.y"
+  case 40: /* expr: expr '/' expr  */
+#line 286 "cool.y"
 { (yyval.expression) = divide((yyvsp[-2].expression), (yyvsp[0].expression)); }
-#line 1952 "cool-parse.cc"
+#line 1719 "cool-parse.cc"
     break;
 
-  case 41:
-#line 257 "cool.y"
+  case 41: /* expr: '~' expr  */
+#line 288 "cool.y"
 { (yyval.expression) = neg((yyvsp[0].expression)); }
-#line 1958 "cool-parse.cc"
+#line 1725 "cool-parse.cc"
     break;
 
-  case 42:
-#line 259 "cool.y"
+  case 42: /* expr: expr '<' expr  */
+#line 290 "cool.y"
 { (yyval.expression) = lt((yyvsp[-2].expression), (yyvsp[0].expression)); }
-#line 1964 "cool-parse.cc"
+#line 1731 "cool-parse.cc"
     break;
 
-  case 43:
-#line 261 "cool.y"
+  case 43: /* expr: expr LE expr  */
+#line 292 "cool.y"
 { (yyval.expression) = leq((yyvsp[-2].expression), (yyvsp[0].expression)); }
-#line 1970 "cool-parse.cc"
+#line 1737 "cool-parse.cc"
     break;
 
-  case 44:
-#line 263 "cool.y"
+  case 44: /* expr: expr '=' expr  */
+#line 294 "cool.y"
 { (yyval.expression) = eq((yyvsp[-2].expression), (yyvsp[0].expression)); }
-#line 1976 "cool-parse.cc"
+#line 1743 "cool-parse.cc"
     break;
 
-  case 45:
-#line 265 "cool.y"
+  case 45: /* expr: NOT expr  */
+#line 296 "cool.y"
 { (yyval.expression) = comp((yyvsp[0].expression)); }
-#line 1982 "cool-parse.cc"
+#line 1749 "cool-parse.cc"
     break;
 
-  case 46:
-#line 267 "cool.y"
+  case 46: /* expr: '(' expr ')'  */
+#line 298 "cool.y"
 { (yyval.expression) = (yyvsp[-1].expression); }
-#line 1988 "cool-parse.cc"
+#line 1755 "cool-parse.cc"
     break;
 
-  case 47:
-#line 269 "cool.y"
+  case 47: /* expr: OBJECTID  */
+#line 300 "cool.y"
 { (yyval.expression) = object((yyvsp[0].symbol)); }
-#line 1994 "cool-parse.cc"
+#line 1761 "cool-parse.cc"
     break;
 
-  case 48:
-#line 271 "cool.y"
+  case 48: /* expr: INT_CONST  */
+#line 302 "cool.y"
 { (yyval.expression) = int_const((yyvsp[0].symbol)); }
-#line 2000 "cool-parse.cc"
+#line 1767 "cool-parse.cc"
     break;
 
-  case 49:
-#line 273 "cool.y"
+  case 49: /* expr: STR_CONST  */
+#line 304 "cool.y"
 { (yyval.expression) = string_const((yyvsp[0].symbol)); }
-#line 2006 "cool-parse.cc"
+#line 1773 "cool-parse.cc"
     break;
 
-  case 50:
-#line 275 "cool.y"
+  case 50: /* expr: BOOL_CONST  */
+#line 306 "cool.y"
 { (yyval.expression) = bool_const((yyvsp[0].boolean)); }
-#line 2012 "cool-parse.cc"
+#line 1779 "cool-parse.cc"
     break;
 
-  case 51:
-#line 278 "cool.y"
+  case 51: /* expr_list: expr  */
+#line 309 "cool.y"
 { (yyval.expressions) = single_Expressions((yyvsp[0].expression)); }
-#line 2018 "cool-parse.cc"
+#line 1785 "cool-parse.cc"
     break;
 
-  case 52:
-#line 280 "cool.y"
+  case 52: /* expr_list: expr_list ',' expr  */
+#line 311 "cool.y"
 { (yyval.expressions) = append_Expressions((yyvsp[-2].expressions), single_Expressions((yyvsp[0].expression))); }
-#line 2024 "cool-parse.cc"
+#line 1791 "cool-parse.cc"
     break;
 
-  case 53:
-#line 283 "cool.y"
+  case 53: /* expr_block_list: expr ';'  */
+#line 314 "cool.y"
 { (yyval.expressions) = single_Expressions((yyvsp[-1].expression)); }
-#line 2030 "cool-parse.cc"
+#line 1797 "cool-parse.cc"
     break;
 
-  case 54:
-#line 285 "cool.y"
+  case 54: /* expr_block_list: error ';'  */
+#line 316 "cool.y"
 { (yyval.expressions) = nil_Expressions(); 
-  yyerrok; }
-#line 2037 "cool-parse.cc"
+  RECOVERED }
+#line 1804 "cool-parse.cc"
     break;
 
-  case 55:
-#line 288 "cool.y"
+  case 55: /* expr_block_list: expr_block_list expr ';'  */
+#line 319 "cool.y"
 { (yyval.expressions) = append_Expressions((yyvsp[-2].expressions), single_Expressions((yyvsp[-1].expression))); }
-#line 2043 "cool-parse.cc"
+#line 1810 "cool-parse.cc"
     break;
 
-  case 56:
-#line 290 "cool.y"
+  case 56: /* expr_block_list: expr_block_list error ';'  */
+#line 321 "cool.y"
 { (yyval.expressions) = (yyvsp[-2].expressions);
-  yyerrok; }
-#line 2050 "cool-parse.cc"
+  RECOVERED }
+#line 1817 "cool-parse.cc"
     break;
 
-  case 57:
-#line 294 "cool.y"
+  case 57: /* case_list: case  */
+#line 325 "cool.y"
 { (yyval.cases) = single_Cases((yyvsp[0].case_)); }
-#line 2056 "cool-parse.cc"
+#line 1823 "cool-parse.cc"
     break;
 
-  case 58:
-#line 296 "cool.y"
+  case 58: /* case_list: case_list case  */
+#line 327 "cool.y"
 { (yyval.cases) = append_Cases((yyvsp[-1].cases), single_Cases((yyvsp[0].case_))); }
-#line 2062 "cool-parse.cc"
+#line 1829 "cool-parse.cc"
     break;
 
-  case 59:
-#line 299 "cool.y"
+  case 59: /* case: OBJECTID ':' TYPEID DARROW expr ';'  */
+#line 330 "cool.y"
 { (yyval.case_) = branch((yyvsp[-5].symbol), (yyvsp[-3].symbol), (yyvsp[-1].expression)); }
-#line 2068 "cool-parse.cc"
+#line 1835 "cool-parse.cc"
     break;
 
-  case 60:
-#line 302 "cool.y"
+  case 60: /* let_body: OBJECTID ':' TYPEID IN expr  */
+#line 333 "cool.y"
 { (yyval.expression) = let((yyvsp[-4].symbol), (yyvsp[-2].symbol), no_expr(), (yyvsp[0].expression)); }
-#line 2074 "cool-parse.cc"
+#line 1841 "cool-parse.cc"
     break;
 
-  case 61:
-#line 304 "cool.y"
+  case 61: /* let_body: OBJECTID ':' TYPEID ASSIGN expr IN expr  */
+#line 335 "cool.y"
 { (yyval.expression) = let((yyvsp[-6].symbol), (yyvsp[-4].symbol), (yyvsp[-2].expression), (yyvsp[0].expression)); }
-#line 2080 "cool-parse.cc"
+#line 1847 "cool-parse.cc"
     break;
 
-  case 62:
-#line 306 "cool.y"
+  case 62: /* let_body: OBJECTID ':' TYPEID ',' let_body  */
+#line 337 "cool.y"
 { (yyval.expression) = let((yyvsp[-4].symbol), (yyvsp[-2].symbol), no_expr(), (yyvsp[0].expression)); }
-#line 2086 "cool-parse.cc"
+#line 1853 "cool-parse.cc"
     break;
 
-  case 63:
-#line 308 "cool.y"
+  case 63: /* let_body: OBJECTID ':' TYPEID ASSIGN expr ',' let_body  */
+#line 339 "cool.y"
 { (yyval.expression) = let((yyvsp[-6].symbol), (yyvsp[-4].symbol), (yyvsp[-2].expression), (yyvsp[0].expression)); }
-#line 2092 "cool-parse.cc"
+#line 1859 "cool-parse.cc"
     break;
 
-  case 64:
-#line 310 "cool.y"
+  case 64: /* let_body: error ',' let_body  */
+#line 341 "cool.y"
 { (yyval.expression) = (yyvsp[0].expression); 
-  yyerrok;}
-#line 2099 "cool-parse.cc"
+  RECOVERED }
+#line 1866 "cool-parse.cc"
     break;
 
-  case 65:
-#line 313 "cool.y"
-{ (yyval.expression) = (yyvsp[0].expression); yyerrok; }
-#line 2105 "cool-parse.cc"
+  case 65: /* let_body: error IN expr  */
+#line 344 "cool.y"
+{ RECOVERED }
+#line 1872 "cool-parse.cc"
     break;
 
 
-#line 2109 "cool-parse.cc"
+#line 1876 "cool-parse.cc"
 
       default: break;
     }
@@ -2120,11 +1887,10 @@ yyreduce:
      case of YYERROR or YYBACKUP, subsequent parser actions might lead
      to an incorrect destructor call or verbose syntax error message
      before the lookahead is translated.  */
-  YY_SYMBOL_PRINT ("-> $$ =", yyr1[yyn], &yyval, &yyloc);
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
 
   YYPOPSTACK (yylen);
   yylen = 0;
-  YY_STACK_PRINT (yyss, yyssp);
 
   *++yyvsp = yyval;
   *++yylsp = yyloc;
@@ -2149,50 +1915,15 @@ yyreduce:
 yyerrlab:
   /* Make sure we have latest lookahead translation.  See comments at
      user semantic actions for why this is necessary.  */
-  yytoken = yychar == YYEMPTY ? YYEMPTY : YYTRANSLATE (yychar);
-
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
   /* If not already recovering from an error, report this error.  */
   if (!yyerrstatus)
     {
       ++yynerrs;
-#if ! YYERROR_VERBOSE
-      yyerror (YY_("syntax error"));
-#else
-# define YYSYNTAX_ERROR yysyntax_error (&yymsg_alloc, &yymsg, \
-                                        yyssp, yytoken)
-      {
-        char const *yymsgp = YY_("syntax error");
-        int yysyntax_error_status;
-        yysyntax_error_status = YYSYNTAX_ERROR;
-        if (yysyntax_error_status == 0)
-          yymsgp = yymsg;
-        else if (yysyntax_error_status == 1)
-          {
-            if (yymsg != yymsgbuf)
-              YYSTACK_FREE (yymsg);
-            yymsg = YY_CAST (char *, YYSTACK_ALLOC (YY_CAST (YYSIZE_T, yymsg_alloc)));
-            if (!yymsg)
-              {
-                yymsg = yymsgbuf;
-                yymsg_alloc = sizeof yymsgbuf;
-                yysyntax_error_status = 2;
-              }
-            else
-              {
-                yysyntax_error_status = YYSYNTAX_ERROR;
-                yymsgp = yymsg;
-              }
-          }
-        yyerror (yymsgp);
-        if (yysyntax_error_status == 2)
-          goto yyexhaustedlab;
-      }
-# undef YYSYNTAX_ERROR
-#endif
+      yyerror (&yylloc, ps, YY_("syntax error"));
     }
 
   yyerror_range[1] = yylloc;
-
   if (yyerrstatus == 3)
     {
       /* If just tried and failed to reuse lookahead token after an
@@ -2207,7 +1938,7 @@ yyerrlab:
       else
         {
           yydestruct ("Error: discarding",
-                      yytoken, &yylval, &yylloc);
+                      yytoken, &yylval, &yylloc, ps);
           yychar = YYEMPTY;
         }
     }
@@ -2225,6 +1956,7 @@ yyerrorlab:
      label yyerrorlab therefore never appears in user code.  */
   if (0)
     YYERROR;
+  ++yynerrs;
 
   /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
@@ -2241,13 +1973,14 @@ yyerrorlab:
 yyerrlab1:
   yyerrstatus = 3;      /* Each real token shifted decrements this.  */
 
+  /* Pop stack until we find a state that shifts the error token.  */
   for (;;)
     {
       yyn = yypact[yystate];
       if (!yypact_value_is_default (yyn))
         {
-          yyn += YYTERROR;
-          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYTERROR)
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
             {
               yyn = yytable[yyn];
               if (0 < yyn)
@@ -2261,7 +1994,7 @@ yyerrlab1:
 
       yyerror_range[1] = *yylsp;
       yydestruct ("Error: popping",
-                  yystos[yystate], yyvsp, yylsp);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, yylsp, ps);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
@@ -2272,13 +2005,11 @@ yyerrlab1:
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 
   yyerror_range[2] = yylloc;
-  /* Using YYLLOC is tempting, but would change the location of
-     the lookahead.  YYLOC is available though.  */
-  YYLLOC_DEFAULT (yyloc, yyerror_range, 2);
-  *++yylsp = yyloc;
+  ++yylsp;
+  YYLLOC_DEFAULT (*yylsp, yyerror_range, 2);
 
   /* Shift the error token.  */
-  YY_SYMBOL_PRINT ("Shifting", yystos[yyn], yyvsp, yylsp);
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
 
   yystate = yyn;
   goto yynewstate;
@@ -2289,7 +2020,7 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
 
 
 /*-----------------------------------.
@@ -2297,31 +2028,29 @@ yyacceptlab:
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
 
 
-#if !defined yyoverflow || YYERROR_VERBOSE
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
-  yyerror (YY_("memory exhausted"));
+  yyerror (&yylloc, ps, YY_("memory exhausted"));
   yyresult = 2;
-  /* Fall through.  */
-#endif
+  goto yyreturnlab;
 
 
-/*-----------------------------------------------------.
-| yyreturn -- parsing is finished, return the result.  |
-`-----------------------------------------------------*/
-yyreturn:
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
   if (yychar != YYEMPTY)
     {
       /* Make sure we have latest lookahead translation.  See comments at
          user semantic actions for why this is necessary.  */
       yytoken = YYTRANSLATE (yychar);
       yydestruct ("Cleanup: discarding lookahead",
-                  yytoken, &yylval, &yylloc);
+                  yytoken, &yylval, &yylloc, ps);
     }
   /* Do not reclaim the symbols of the rule whose action triggered
      this YYABORT or YYACCEPT.  */
@@ -2330,31 +2059,52 @@ yyreturn:
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-                  yystos[+*yyssp], yyvsp, yylsp);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, yylsp, ps);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
   if (yyss != yyssa)
     YYSTACK_FREE (yyss);
 #endif
-#if YYERROR_VERBOSE
-  if (yymsg != yymsgbuf)
-    YYSTACK_FREE (yymsg);
-#endif
+
   return yyresult;
 }
-#line 314 "cool.y"
 
+#line 345 "cool.y"
 
-/* This function is called automatically when Bison detects a parse error. */
-void yyerror(const char *s)
+
+/* This function is called automatically when Bison detects a parse error.
+   The lookahead token is the last one the lexer returned, which
+   cool_yylex() keeps in ps->token and ps->token_value. */
+void yyerror(YYLTYPE *loc, Parse_State *ps, const char *s)
 {
-  extern int curr_lineno;
+  if (ps->errors > 50)
+    return;                     /* already giving up; see cool_yylex() */
 
-  std::cerr << "\"" << curr_filename << "\", line " << curr_lineno << ": " \
+  *ps->err << "\"" << ps->filename << "\", line " << ps->lineno << ": " \
     << s << " at or near ";
-  print_cool_token(yychar);
-  std::cerr << std::endl;
-  omerrs++;
-  if(omerrs>50) { std::cerr << "More than 50 errors" << std::endl; exit(1);}
+  print_cool_token(*ps->err, ps->token, ps->token_value);
+  *ps->err << std::endl;
+  ps->errors++;
+  parse_stats.syntax_errors++;
+  if (ps->errors > 50)
+    *ps->err << "More than 50 errors" << std::endl;
+}
+
+/* With a Class_Sink (--stream), each class is handed on as soon as it is
+   parsed and its nodes are freed; no list of classes is kept.  Nothing
+   else on the parser's stack holds nodes at this point: the class list
+   is the only thing below it.  Once there has been an error the classes
+   may hold the debris of error recovery, so they are only freed. */
+Classes add_class(Parse_State *ps, Classes list, Class_ c)
+{
+  if (ps->sink) {
+    if (ps->errors == 0)
+      ps->sink->emit(c);
+    release_tree_nodes_to(ps->mark);
+    return NULL;
+  }
+  if (list == NULL)
+    return single_Classes(c);
+  return append_Classes(list, single_Classes(c));
 }
@@ -0,0 +1,1497 @@
+//////////////////////////////////////////////////////////
+//
+// file: cool-tree.cc
+//
+// This file defines the functions of each class
+//
+//////////////////////////////////////////////////////////
+
+
+#include "tree.h"
+#include "cool-tree.h"
+#include "parse-stats.h"
+
+
+// constructors' functions
+//
+// copy and dump are walks of the tree (tree-walk.h); each node makes its
+// own copy out of copies of its subtrees, and dumps itself a part at a
+// time, around its subtrees.
+Program program_class::copy_Program()
+{
+   return (Program) copy_tree(this);
+}
+
+
+tree_node *program_class::copy_with(tree_node **subtrees)
+{
+   return new program_class((Classes) subtrees[0]);
+}
+
+
+int program_class::children()
+{
+   return 1;
+}
+
+
+tree_node *program_class::child(int)
+{
+   return classes;
+}
+
+
+void program_class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int program_class::dump_part(ostream& stream, int n, int i)
+{
+   if (i == 0)
+      stream << pad(n) << "program\n";
+   return n+2;
+}
+
+
+Class_ class__class::copy_Class_()
+{
+   return (Class_) copy_tree(this);
+}
+
+
+tree_node *class__class::copy_with(tree_node **subtrees)
+{
+   return new class__class(copy_Symbol(name), copy_Symbol(parent), (Features) subtrees[0], copy_Symbol(filename));
+}
+
+
+int class__class::children()
+{
+   return 1;
+}
+
+
+tree_node *class__class::child(int)
+{
+   return features;
+}
+
+
+void class__class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int class__class::dump_part(ostream& stream, int n, int i)
+{
+   switch (i) {
+   case 0:
+      stream << pad(n) << "class_\n";
+      dump_Symbol(stream, n+2, name);
+      dump_Symbol(stream, n+2, parent);
+      break;
+   case 1:
+      dump_Symbol(stream, n+2, filename);
+      break;
+   }
+   return n+2;
+}
+
+
+Feature method_class::copy_Feature()
+{
+   return (Feature) copy_tree(this);
+}
+
+
+tree_node *method_class::copy_with(tree_node **subtrees)
+{
+   return new method_class(copy_Symbol(name), (Formals) subtrees[0], copy_Symbol(return_type), (Expression) subtrees[1]);
+}
+
+
+int method_class::children()
+{
+   return 2;
+}
+
+
+tree_node *method_class::child(int i)
+{
+   switch (i) {
+   case 0: return formals;
+   default: return expr;
+   }
+}
+
+
+void method_class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int method_class::dump_part(ostream& stream, int n, int i)
+{
+   switch (i) {
+   case 0:
+      stream << pad(n) << "method\n";
+      dump_Symbol(stream, n+2, name);
+      break;
+   case 1:
+      dump_Symbol(stream, n+2, return_type);
+      break;
+   }
+   return n+2;
+}
+
+
+Feature attr_class::copy_Feature()
+{
+   return (Feature) copy_tree(this);
+}
+
+
+tree_node *attr_class::copy_with(tree_node **subtrees)
+{
+   return new attr_class(copy_Symbol(name), copy_Symbol(type_decl), (Expression) subtrees[0]);
+}
+
+
+int attr_class::children()
+{
+   return 1;
+}
+
+
+tree_node *attr_class::child(int)
+{
+   return init;
+}
+
+
+void attr_class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int attr_class::dump_part(ostream& stream, int n, int i)
+{
+   if (i == 0) {
+      stream << pad(n) << "attr\n";
+      dump_Symbol(stream, n+2, name);
+      dump_Symbol(stream, n+2, type_decl);
+   }
+   return n+2;
+}
+
+
+Formal formal_class::copy_Formal()
+{
+   return (Formal) copy_tree(this);
+}
+
+
+tree_node *formal_class::copy_with(tree_node **)
+{
+   return new formal_class(copy_Symbol(name), copy_Symbol(type_decl));
+}
+
+
+int formal_class::children()
+{
+   return 0;
+}
+
+
+tree_node *formal_class::child(int)
+{
+   return NULL;
+}
+
+
+void formal_class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int formal_class::dump_part(ostream& stream, int n, int)
+{
+   stream << pad(n) << "formal\n";
+   dump_Symbol(stream, n+2, name);
+   dump_Symbol(stream, n+2, type_decl);
+   return n+2;
+}
+
+
+Case branch_class::copy_Case()
+{
+   return (Case) copy_tree(this);
+}
+
+
+tree_node *branch_class::copy_with(tree_node **subtrees)
+{
+   return new branch_class(copy_Symbol(name), copy_Symbol(type_decl), (Expression) subtrees[0]);
+}
+
+
+int branch_class::children()
+{
+   return 1;
+}
+
+
+tree_node *branch_class::child(int)
+{
+   return expr;
+}
+
+
+void branch_class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int branch_class::dump_part(ostream& stream, int n, int i)
+{
+   if (i == 0) {
+      stream << pad(n) << "branch\n";
+      dump_Symbol(stream, n+2, name);
+      dump_Symbol(stream, n+2, type_decl);
+   }
+   return n+2;
+}
+
+
+Expression assign_class::copy_Expression()
+{
+   return (Expression) copy_tree(this);
+}
+
+
+tree_node *assign_class::copy_with(tree_node **subtrees)
+{
+   return new assign_class(copy_Symbol(name), (Expression) subtrees[0]);
+}
+
+
+int assign_class::children()
+{
+   return 1;
+}
+
+
+tree_node *assign_class::child(int)
+{
+   return expr;
+}
+
+
+void assign_class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int assign_class::dump_part(ostream& stream, int n, int i)
+{
+   if (i == 0) {
+      stream << pad(n) << "assign\n";
+      dump_Symbol(stream, n+2, name);
+   }
+   return n+2;
+}
+
+
+Expression static_dispatch_class::copy_Expression()
+{
+   return (Expression) copy_tree(this);
+}
+
+
+tree_node *static_dispatch_class::copy_with(tree_node **subtrees)
+{
+   return new static_dispatch_class((Expression) subtrees[0], copy_Symbol(type_name), copy_Symbol(name), (Expressions) subtrees[1]);
+}
+
+
+int static_dispatch_class::children()
+{
+   return 2;
+}
+
+
+tree_node *static_dispatch_class::child(int i)
+{
+   switch (i) {
+   case 0: return expr;
+   default: return actual;
+   }
+}
+
+
+void static_dispatch_class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int static_dispatch_class::dump_part(ostream& stream, int n, int i)
+{
+   switch (i) {
+   case 0:
+      stream << pad(n) << "static_dispatch\n";
+      break;
+   case 1:
+      dump_Symbol(stream, n+2, type_name);
+      dump_Symbol(stream, n+2, name);
+      break;
+   }
+   return n+2;
+}
+
+
+Expression dispatch_class::copy_Expression()
+{
+   return (Expression) copy_tree(this);
+}
+
+
+tree_node *dispatch_class::copy_with(tree_node **subtrees)
+{
+   return new dispatch_class((Expression) subtrees[0], copy_Symbol(name), (Expressions) subtrees[1]);
+}
+
+
+int dispatch_class::children()
+{
+   return 2;
+}
+
+
+tree_node *dispatch_class::child(int i)
+{
+   switch (i) {
+   case 0: return expr;
+   default: return actual;
+   }
+}
+
+
+void dispatch_class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int dispatch_class::dump_part(ostream& stream, int n, int i)
+{
+   switch (i) {
+   case 0:
+      stream << pad(n) << "dispatch\n";
+      break;
+   case 1:
+      dump_Symbol(stream, n+2, name);
+      break;
+   }
+   return n+2;
+}
+
+
+Expression cond_class::copy_Expression()
+{
+   return (Expression) copy_tree(this);
+}
+
+
+tree_node *cond_class::copy_with(tree_node **subtrees)
+{
+   return new cond_class((Expression) subtrees[0], (Expression) subtrees[1], (Expression) subtrees[2]);
+}
+
+
+int cond_class::children()
+{
+   return 3;
+}
+
+
+tree_node *cond_class::child(int i)
+{
+   switch (i) {
+   case 0: return pred;
+   case 1: return then_exp;
+   default: return else_exp;
+   }
+}
+
+
+void cond_class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int cond_class::dump_part(ostream& stream, int n, int i)
+{
+   if (i == 0)
+      stream << pad(n) << "cond\n";
+   return n+2;
+}
+
+
+Expression loop_class::copy_Expression()
+{
+   return (Expression) copy_tree(this);
+}
+
+
+tree_node *loop_class::copy_with(tree_node **subtrees)
+{
+   return new loop_class((Expression) subtrees[0], (Expression) subtrees[1]);
+}
+
+
+int loop_class::children()
+{
+   return 2;
+}
+
+
+tree_node *loop_class::child(int i)
+{
+   switch (i) {
+   case 0: return pred;
+   default: return body;
+   }
+}
+
+
+void loop_class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int loop_class::dump_part(ostream& stream, int n, int i)
+{
+   if (i == 0)
+      stream << pad(n) << "loop\n";
+   return n+2;
+}
+
+
+Expression typcase_class::copy_Expression()
+{
+   return (Expression) copy_tree(this);
+}
+
+
+tree_node *typcase_class::copy_with(tree_node **subtrees)
+{
+   return new typcase_class((Expression) subtrees[0], (Cases) subtrees[1]);
+}
+
+
+int typcase_class::children()
+{
+   return 2;
+}
+
+
+tree_node *typcase_class::child(int i)
+{
+   switch (i) {
+   case 0: return expr;
+   default: return cases;
+   }
+}
+
+
+void typcase_class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int typcase_class::dump_part(ostream& stream, int n, int i)
+{
+   if (i == 0)
+      stream << pad(n) << "typcase\n";
+   return n+2;
+}
+
+
+Expression block_class::copy_Expression()
+{
+   return (Expression) copy_tree(this);
+}
+
+
+tree_node *block_class::copy_with(tree_node **subtrees)
+{
+   return new block_class((Expressions) subtrees[0]);
+}
+
+
+int block_class::children()
+{
+   return 1;
+}
+
+
+tree_node *block_class::child(int)
+{
+   return body;
+}
+
+
+void block_class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int block_class::dump_part(ostream& stream, int n, int i)
+{
+   if (i == 0)
+      stream << pad(n) << "block\n";
+   return n+2;
+}
+
+
+Expression let_class::copy_Expression()
+{
+   return (Expression) copy_tree(this);
+}
+
+
+tree_node *let_class::copy_with(tree_node **subtrees)
+{
+   return new let_class(copy_Symbol(identifier), copy_Symbol(type_decl), (Expression) subtrees[0], (Expression) subtrees[1]);
+}
+
+
+int let_class::children()
+{
+   return 2;
+}
+
+
+tree_node *let_class::child(int i)
+{
+   switch (i) {
+   case 0: return init;
+   default: return body;
+   }
+}
+
+
+void let_class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int let_class::dump_part(ostream& stream, int n, int i)
+{
+   if (i == 0) {
+      stream << pad(n) << "let\n";
+      dump_Symbol(stream, n+2, identifier);
+      dump_Symbol(stream, n+2, type_decl);
+   }
+   return n+2;
+}
+
+
+Expression plus_class::copy_Expression()
+{
+   return (Expression) copy_tree(this);
+}
+
+
+tree_node *plus_class::copy_with(tree_node **subtrees)
+{
+   return new plus_class((Expression) subtrees[0], (Expression) subtrees[1]);
+}
+
+
+int plus_class::children()
+{
+   return 2;
+}
+
+
+tree_node *plus_class::child(int i)
+{
+   switch (i) {
+   case 0: return e1;
+   default: return e2;
+   }
+}
+
+
+void plus_class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int plus_class::dump_part(ostream& stream, int n, int i)
+{
+   if (i == 0)
+      stream << pad(n) << "plus\n";
+   return n+2;
+}
+
+
+Expression sub_class::copy_Expression()
+{
+   return (Expression) copy_tree(this);
+}
+
+
+tree_node *sub_class::copy_with(tree_node **subtrees)
+{
+   return new sub_class((Expression) subtrees[0], (Expression) subtrees[1]);
+}
+
+
+int sub_class::children()
+{
+   return 2;
+}
+
+
+tree_node *sub_class::child(int i)
+{
+   switch (i) {
+   case 0: return e1;
+   default: return e2;
+   }
+}
+
+
+void sub_class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int sub_class::dump_part(ostream& stream, int n, int i)
+{
+   if (i == 0)
+      stream << pad(n) << "sub\n";
+   return n+2;
+}
+
+
+Expression mul_class::copy_Expression()
+{
+   return (Expression) copy_tree(this);
+}
+
+
+tree_node *mul_class::copy_with(tree_node **subtrees)
+{
+   return new mul_class((Expression) subtrees[0], (Expression) subtrees[1]);
+}
+
+
+int mul_class::children()
+{
+   return 2;
+}
+
+
+tree_node *mul_class::child(int i)
+{
+   switch (i) {
+   case 0: return e1;
+   default: return e2;
+   }
+}
+
+
+void mul_class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int mul_class::dump_part(ostream& stream, int n, int i)
+{
+   if (i == 0)
+      stream << pad(n) << "mul\n";
+   return n+2;
+}
+
+
+Expression divide_class::copy_Expression()
+{
+   return (Expression) copy_tree(this);
+}
+
+
+tree_node *divide_class::copy_with(tree_node **subtrees)
+{
+   return new divide_class((Expression) subtrees[0], (Expression) subtrees[1]);
+}
+
+
+int divide_class::children()
+{
+   return 2;
+}
+
+
+tree_node *divide_class::child(int i)
+{
+   switch (i) {
+   case 0: return e1;
+   default: return e2;
+   }
+}
+
+
+void divide_class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int divide_class::dump_part(ostream& stream, int n, int i)
+{
+   if (i == 0)
+      stream << pad(n) << "divide\n";
+   return n+2;
+}
+
+
+Expression neg_class::copy_Expression()
+{
+   return (Expression) copy_tree(this);
+}
+
+
+tree_node *neg_class::copy_with(tree_node **subtrees)
+{
+   return new neg_class((Expression) subtrees[0]);
+}
+
+
+int neg_class::children()
+{
+   return 1;
+}
+
+
+tree_node *neg_class::child(int)
+{
+   return e1;
+}
+
+
+void neg_class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int neg_class::dump_part(ostream& stream, int n, int i)
+{
+   if (i == 0)
+      stream << pad(n) << "neg\n";
+   return n+2;
+}
+
+
+Expression lt_class::copy_Expression()
+{
+   return (Expression) copy_tree(this);
+}
+
+
+tree_node *lt_class::copy_with(tree_node **subtrees)
+{
+   return new lt_class((Expression) subtrees[0], (Expression) subtrees[1]);
+}
+
+
+int lt_class::children()
+{
+   return 2;
+}
+
+
+tree_node *lt_class::child(int i)
+{
+   switch (i) {
+   case 0: return e1;
+   default: return e2;
+   }
+}
+
+
+void lt_class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int lt_class::dump_part(ostream& stream, int n, int i)
+{
+   if (i == 0)
+      stream << pad(n) << "lt\n";
+   return n+2;
+}
+
+
+Expression eq_class::copy_Expression()
+{
+   return (Expression) copy_tree(this);
+}
+
+
+tree_node *eq_class::copy_with(tree_node **subtrees)
+{
+   return new eq_class((Expression) subtrees[0], (Expression) subtrees[1]);
+}
+
+
+int eq_class::children()
+{
+   return 2;
+}
+
+
+tree_node *eq_class::child(int i)
+{
+   switch (i) {
+   case 0: return e1;
+   default: return e2;
+   }
+}
+
+
+void eq_class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int eq_class::dump_part(ostream& stream, int n, int i)
+{
+   if (i == 0)
+      stream << pad(n) << "eq\n";
+   return n+2;
+}
+
+
+Expression leq_class::copy_Expression()
+{
+   return (Expression) copy_tree(this);
+}
+
+
+tree_node *leq_class::copy_with(tree_node **subtrees)
+{
+   return new leq_class((Expression) subtrees[0], (Expression) subtrees[1]);
+}
+
+
+int leq_class::children()
+{
+   return 2;
+}
+
+
+tree_node *leq_class::child(int i)
+{
+   switch (i) {
+   case 0: return e1;
+   default: return e2;
+   }
+}
+
+
+void leq_class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int leq_class::dump_part(ostream& stream, int n, int i)
+{
+   if (i == 0)
+      stream << pad(n) << "leq\n";
+   return n+2;
+}
+
+
+Expression comp_class::copy_Expression()
+{
+   return (Expression) copy_tree(this);
+}
+
+
+tree_node *comp_class::copy_with(tree_node **subtrees)
+{
+   return new comp_class((Expression) subtrees[0]);
+}
+
+
+int comp_class::children()
+{
+   return 1;
+}
+
+
+tree_node *comp_class::child(int)
+{
+   return e1;
+}
+
+
+void comp_class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int comp_class::dump_part(ostream& stream, int n, int i)
+{
+   if (i == 0)
+      stream << pad(n) << "comp\n";
+   return n+2;
+}
+
+
+Expression int_const_class::copy_Expression()
+{
+   return (Expression) copy_tree(this);
+}
+
+
+tree_node *int_const_class::copy_with(tree_node **)
+{
+   return new int_const_class(copy_Symbol(token));
+}
+
+
+int int_const_class::children()
+{
+   return 0;
+}
+
+
+tree_node *int_const_class::child(int)
+{
+   return NULL;
+}
+
+
+void int_const_class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int int_const_class::dump_part(ostream& stream, int n, int)
+{
+   stream << pad(n) << "int_const\n";
+   dump_Symbol(stream, n+2, token);
+   return n+2;
+}
+
+
+Expression bool_const_class::copy_Expression()
+{
+   return (Expression) copy_tree(this);
+}
+
+
+tree_node *bool_const_class::copy_with(tree_node **)
+{
+   return new bool_const_class(copy_Boolean(val));
+}
+
+
+int bool_const_class::children()
+{
+   return 0;
+}
+
+
+tree_node *bool_const_class::child(int)
+{
+   return NULL;
+}
+
+
+void bool_const_class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int bool_const_class::dump_part(ostream& stream, int n, int)
+{
+   stream << pad(n) << "bool_const\n";
+   dump_Boolean(stream, n+2, val);
+   return n+2;
+}
+
+
+Expression string_const_class::copy_Expression()
+{
+   return (Expression) copy_tree(this);
+}
+
+
+tree_node *string_const_class::copy_with(tree_node **)
+{
+   return new string_const_class(copy_Symbol(token));
+}
+
+
+int string_const_class::children()
+{
+   return 0;
+}
+
+
+tree_node *string_const_class::child(int)
+{
+   return NULL;
+}
+
+
+void string_const_class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int string_const_class::dump_part(ostream& stream, int n, int)
+{
+   stream << pad(n) << "string_const\n";
+   dump_Symbol(stream, n+2, token);
+   return n+2;
+}
+
+
+Expression new__class::copy_Expression()
+{
+   return (Expression) copy_tree(this);
+}
+
+
+tree_node *new__class::copy_with(tree_node **)
+{
+   return new new__class(copy_Symbol(type_name));
+}
+
+
+int new__class::children()
+{
+   return 0;
+}
+
+
+tree_node *new__class::child(int)
+{
+   return NULL;
+}
+
+
+void new__class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int new__class::dump_part(ostream& stream, int n, int)
+{
+   stream << pad(n) << "new_\n";
+   dump_Symbol(stream, n+2, type_name);
+   return n+2;
+}
+
+
+Expression isvoid_class::copy_Expression()
+{
+   return (Expression) copy_tree(this);
+}
+
+
+tree_node *isvoid_class::copy_with(tree_node **subtrees)
+{
+   return new isvoid_class((Expression) subtrees[0]);
+}
+
+
+int isvoid_class::children()
+{
+   return 1;
+}
+
+
+tree_node *isvoid_class::child(int)
+{
+   return e1;
+}
+
+
+void isvoid_class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int isvoid_class::dump_part(ostream& stream, int n, int i)
+{
+   if (i == 0)
+      stream << pad(n) << "isvoid\n";
+   return n+2;
+}
+
+
+Expression no_expr_class::copy_Expression()
+{
+   return (Expression) copy_tree(this);
+}
+
+
+tree_node *no_expr_class::copy_with(tree_node **)
+{
+   return new no_expr_class();
+}
+
+
+int no_expr_class::children()
+{
+   return 0;
+}
+
+
+tree_node *no_expr_class::child(int)
+{
+   return NULL;
+}
+
+
+void no_expr_class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int no_expr_class::dump_part(ostream& stream, int n, int)
+{
+   stream << pad(n) << "no_expr\n";
+   return n+2;
+}
+
+
+Expression object_class::copy_Expression()
+{
+   return (Expression) copy_tree(this);
+}
+
+
+tree_node *object_class::copy_with(tree_node **)
+{
+   return new object_class(copy_Symbol(name));
+}
+
+
+int object_class::children()
+{
+   return 0;
+}
+
+
+tree_node *object_class::child(int)
+{
+   return NULL;
+}
+
+
+void object_class::dump(ostream& stream, int n)
+{
+   dump_tree(this, stream, n);
+}
+
+
+int object_class::dump_part(ostream& stream, int n, int)
+{
+   stream << pad(n) << "object\n";
+   dump_Symbol(stream, n+2, name);
+   return n+2;
+}
+
+
+// interfaces used by Bison
+Classes nil_Classes()
+{
+   return new nil_node<Class_>();
+}
+
+Classes single_Classes(Class_ e)
+{
+   return new single_list_node<Class_>(e);
+}
+
+Classes append_Classes(Classes p1, Classes p2)
+{
+   return new append_node<Class_>(p1, p2);
+}
+
+Features nil_Features()
+{
+   return new nil_node<Feature>();
+}
+
+Features single_Features(Feature e)
+{
+   return new single_list_node<Feature>(e);
+}
+
+Features append_Features(Features p1, Features p2)
+{
+   return new append_node<Feature>(p1, p2);
+}
+
+Formals nil_Formals()
+{
+   return new nil_node<Formal>();
+}
+
+Formals single_Formals(Formal e)
+{
+   return new single_list_node<Formal>(e);
+}
+
+Formals append_Formals(Formals p1, Formals p2)
+{
+   return new append_node<Formal>(p1, p2);
+}
+
+Expressions nil_Expressions()
+{
+   return new nil_node<Expression>();
+}
+
+Expressions single_Expressions(Expression e)
+{
+   return new single_list_node<Expression>(e);
+}
+
+Expressions append_Expressions(Expressions p1, Expressions p2)
+{
+   return new append_node<Expression>(p1, p2);
+}
+
+Cases nil_Cases()
+{
+   return new nil_node<Case>();
+}
+
+Cases single_Cases(Case e)
+{
+   return new single_list_node<Case>(e);
+}
+
+Cases append_Cases(Cases p1, Cases p2)
+{
+   return new append_node<Case>(p1, p2);
+}
+
+Program program(Classes classes)
+{
+  COUNT_NODE(AST_PROGRAM);
+  return new program_class(classes);
+}
+
+Class_ class_(Symbol name, Symbol parent, Features features, Symbol filename)
+{
+  COUNT_NODE(AST_CLASS);
+  return new class__class(name, parent, features, filename);
+}
+
+Feature method(Symbol name, Formals formals, Symbol return_type, Expression expr)
+{
+  COUNT_NODE(AST_METHOD);
+  return new method_class(name, formals, return_type, expr);
+}
+
+Feature attr(Symbol name, Symbol type_decl, Expression init)
+{
+  COUNT_NODE(AST_ATTR);
+  return new attr_class(name, type_decl, init);
+}
+
+Formal formal(Symbol name, Symbol type_decl)
+{
+  COUNT_NODE(AST_FORMAL);
+  return new formal_class(name, type_decl);
+}
+
+Case branch(Symbol name, Symbol type_decl, Expression expr)
+{
+  COUNT_NODE(AST_BRANCH);
+  return new branch_class(name, type_decl, expr);
+}
+
+Expression assign(Symbol name, Expression expr)
+{
+  COUNT_NODE(AST_ASSIGN);
+  return new assign_class(name, expr);
+}
+
+Expression static_dispatch(Expression expr, Symbol type_name, Symbol name, Expressions actual)
+{
+  COUNT_NODE(AST_STATIC_DISPATCH);
+  return new static_dispatch_class(expr, type_name, name, actual);
+}
+
+Expression dispatch(Expression expr, Symbol name, Expressions actual)
+{
+  COUNT_NODE(AST_DISPATCH);
+  return new dispatch_class(expr, name, actual);
+}
+
+Expression cond(Expression pred, Expression then_exp, Expression else_exp)
+{
+  COUNT_NODE(AST_COND);
+  return new cond_class(pred, then_exp, else_exp);
+}
+
+Expression loop(Expression pred, Expression body)
+{
+  COUNT_NODE(AST_LOOP);
+  return new loop_class(pred, body);
+}
+
+Expression typcase(Expression expr, Cases cases)
+{
+  COUNT_NODE(AST_TYPCASE);
+  return new typcase_class(expr, cases);
+}
+
+Expression block(Expressions body)
+{
+  COUNT_NODE(AST_BLOCK);
+  return new block_class(body);
+}
+
+Expression let(Symbol identifier, Symbol type_decl, Expression init, Expression body)
+{
+  COUNT_NODE(AST_LET);
+  return new let_class(identifier, type_decl, init, body);
+}
+
+Expression plus(Expression e1, Expression e2)
+{
+  COUNT_NODE(AST_PLUS);
+  return new plus_class(e1, e2);
+}
+
+Expression sub(Expression e1, Expression e2)
+{
+  COUNT_NODE(AST_SUB);
+  return new sub_class(e1, e2);
+}
+
+Expression mul(Expression e1, Expression e2)
+{
+  COUNT_NODE(AST_MUL);
+  return new mul_class(e1, e2);
+}
+
+Expression divide(Expression e1, Expression e2)
+{
+  COUNT_NODE(AST_DIVIDE);
+  return new divide_class(e1, e2);
+}
+
+Expression neg(Expression e1)
+{
+  COUNT_NODE(AST_NEG);
+  return new neg_class(e1);
+}
+
+Expression lt(Expression e1, Expression e2)
+{
+  COUNT_NODE(AST_LT);
+  return new lt_class(e1, e2);
+}
+
+Expression eq(Expression e1, Expression e2)
+{
+  COUNT_NODE(AST_EQ);
+  return new eq_class(e1, e2);
+}
+
+Expression leq(Expression e1, Expression e2)
+{
+  COUNT_NODE(AST_LEQ);
+  return new leq_class(e1, e2);
+}
+
+Expression comp(Expression e1)
+{
+  COUNT_NODE(AST_COMP);
+  return new comp_class(e1);
+}
+
+Expression int_const(Symbol token)
+{
+  COUNT_NODE(AST_INT_CONST);
+  return new int_const_class(token);
+}
+
+Expression bool_const(Boolean val)
+{
+  COUNT_NODE(AST_BOOL_CONST);
+  return new bool_const_class(val);
+}
+
+Expression string_const(Symbol token)
+{
+  COUNT_NODE(AST_STRING_CONST);
+  return new string_const_class(token);
+}
+
+Expression new_(Symbol type_name)
+{
+  COUNT_NODE(AST_NEW);
+  return new new__class(type_name);
+}
+
+Expression isvoid(Expression e1)
+{
+  COUNT_NODE(AST_ISVOID);
+  return new isvoid_class(e1);
+}
+
+Expression no_expr()
+{
+  COUNT_NODE(AST_NO_EXPR);
+  return new no_expr_class();
+}
+
+Expression object(Symbol name)
+{
+  COUNT_NODE(AST_OBJECT);
+  return new object_class(name);
+}
+
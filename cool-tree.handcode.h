@@ -42,63 +42,125 @@ typedef Expressions_class *Expressions;
 typedef list_node<Case> Cases_class;
 typedef Cases_class *Cases;
 
+class Ast_Writer;
+class Dump_Buffer;
+class Vm_Compiler;
+class Rep_Analysis;
+enum Vm_Rep : int;
+class X86_Cgen;
+
+// The parts of the walks over the tree; see tree.h and tree-walk.h.
+#define tree_node_WALKS                                  \
+int children();                                          \
+tree_node *child(int i);                                 \
+tree_node *copy_with(tree_node **subtrees);              \
+int dump_part(ostream& stream, int n, int i);            \
+int dump_with_types_part(Dump_Buffer& stream, int n, int i); \
+void write_ast_part(Ast_Writer& w, int i);
+
 #define Program_EXTRAS                          \
-virtual void dump_with_types(ostream&, int) = 0; 
+virtual Classes get_classes() = 0;              \
+void dump_with_types(Dump_Buffer&, int);        \
+void dump_with_types(ostream&, int);
 
 
 
 #define program_EXTRAS                          \
-void dump_with_types(ostream&, int);            
+Classes get_classes() { return classes; }       \
+tree_node_WALKS
 
 #define Class__EXTRAS                   \
 virtual Symbol get_filename() = 0;      \
-virtual void dump_with_types(ostream&,int) = 0; 
+virtual Symbol get_name() = 0;          \
+virtual Symbol get_parent() = 0;        \
+virtual Features get_features() = 0;    \
+void dump_with_types(Dump_Buffer&,int); \
+void dump_with_types(ostream&,int);
 
 
 #define class__EXTRAS                                 \
 Symbol get_filename() { return filename; }             \
-void dump_with_types(ostream&,int);                    
+Symbol get_name() { return name; }                     \
+Symbol get_parent() { return parent; }                 \
+Features get_features() { return features; }           \
+tree_node_WALKS
 
 
 #define Feature_EXTRAS                                        \
-virtual void dump_with_types(ostream&,int) = 0; 
+virtual Symbol get_name() = 0;          \
+virtual bool is_method() = 0;           \
+void dump_with_types(Dump_Buffer&,int); \
+void dump_with_types(ostream&,int);
 
 
 #define Feature_SHARED_EXTRAS                                       \
-void dump_with_types(ostream&,int);    
+Symbol get_name() { return name; }                                  \
+tree_node_WALKS
+
+#define method_EXTRAS                                   \
+bool is_method() { return true; }                       \
+Formals get_formals() { return formals; }               \
+Symbol get_return_type() { return return_type; }        \
+Expression get_expr() { return expr; }
+
+#define attr_EXTRAS                                     \
+bool is_method() { return false; }                      \
+Symbol get_type_decl() { return type_decl; }            \
+Expression get_init() { return init; }
 
 
 
 
 
 #define Formal_EXTRAS                              \
-virtual void dump_with_types(ostream&,int) = 0;
+void dump_with_types(Dump_Buffer&,int); \
+void dump_with_types(ostream&,int);
 
 
 #define formal_EXTRAS                           \
-void dump_with_types(ostream&,int);
+Symbol get_name() { return name; }              \
+Symbol get_type_decl() { return type_decl; }    \
+tree_node_WALKS
 
 
 #define Case_EXTRAS                             \
-virtual void dump_with_types(ostream& ,int) = 0;
+void dump_with_types(Dump_Buffer& ,int); \
+void dump_with_types(ostream& ,int);
 
 
 #define branch_EXTRAS                                   \
-void dump_with_types(ostream& ,int);
+Symbol get_name() { return name; }                      \
+Symbol get_type_decl() { return type_decl; }            \
+Expression get_expr() { return expr; }                  \
+tree_node_WALKS
+
+
+#define int_const_EXTRAS                        \
+Symbol get_token() { return token; }
+
+#define bool_const_EXTRAS                       \
+Boolean get_val() { return val; }
 
 
 #define Expression_EXTRAS                    \
 Symbol type;                                 \
 Symbol get_type() { return type; }           \
 Expression set_type(Symbol s) { type = s; return this; } \
-virtual void dump_with_types(ostream&,int) = 0;  \
-void dump_type(ostream&, int);               \
+void dump_with_types(Dump_Buffer&,int);      \
+void dump_with_types(ostream&,int);          \
+void dump_type(Dump_Buffer&, int);           \
+virtual int compile(Vm_Compiler&, int) = 0;  \
+virtual Vm_Rep rep(Rep_Analysis&) = 0;       \
+virtual void code(X86_Cgen&) = 0;           \
 Expression_class() { type = (Symbol) NULL; }
 
 
 
 #define Expression_SHARED_EXTRAS           \
-void dump_with_types(ostream&,int); 
+int compile(Vm_Compiler&, int);            \
+Vm_Rep rep(Rep_Analysis&);                 \
+void code(X86_Cgen&);                      \
+tree_node_WALKS
 
 
 #endif
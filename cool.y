@@ -3,33 +3,56 @@
  *              Parser definition for the COOL language.
  *
  */
+%code requires {
+/* Locations are Bison's YYLTYPE, of which only the lines are used;
+   cool_yylex() sets them to the line of each token. */
+
+struct Parse_State;
+}
+
+%code provides {
+/* The value of the last token read by the non-reentrant cool_yylex(),
+   for the token-stream readers; see cool-lex.cc. */
+extern YYSTYPE cool_yylval;
+}
+
 %{
 #include "cool-tree.h"
 #include "stringtab.h"
 #include "utilities.h"
-
-/* Set the size of the parser stack to be sufficient large to accomodate
-    our tests.  There seems to be some problem with Bison's dynamic
-    reallocation of the parser stack, as it should resize to a max
-    size of YYMAXDEPTH, which is by default 10000. */
-#define YYINITDEPTH 3000
-
-/* Locations */
-#define YYLTYPE int              /* the type of locations */
-#define cool_yylloc curr_lineno  /* use the curr_lineno from the lexer
-                                    for the location of tokens */
-extern int node_lineno;          /* set before constructing a tree node
-                                    to whatever you want the line number
-                                    for the tree node to be */
+#include "handle_flags.h"
+#include "cool-lex.h"
+#include "parse-stats.h"
+
+/* The parser's stacks start out in cool_yyparse()'s frame, YYINITDEPTH
+    deep, and are moved to the heap and doubled whenever they fill, up to
+    --max-parse-depth entries; past that, or if malloc fails, the parse
+    ends with "memory exhausted".  In C++ Bison moves the stacks only if
+    the value and location types are known to be trivial, which is why
+    the locations are its own YYLTYPE and not simply an int. */
+#define YYINITDEPTH 1000
+#define YYMAXDEPTH max_parse_depth
+
+/* Locations.  node_lineno (tree.h) is set before constructing a tree
+    node to whatever you want the line number for the tree node to be. */
 
 /* The default action for locations.  Use the location of the first
-    terminal/non-terminal and set the node_lineno to that value. */
+    terminal/non-terminal and set the node_lineno to that value.
+    Bison uses it before every reduction's action, which -P counts. */
 #define YYLLOC_DEFAULT(Current, Rhs, N)		  \
   Current = (Rhs)[1];                             \
-  node_lineno = Current;
+  node_lineno = (Current).first_line;             \
+  STATS_PHASE(PHASE_BUILD);                       \
+  parse_stats.reductions++;
+
+/* yyerrok, for the actions of the error rules, which -P counts as the
+    errors recovered from. */
+#define RECOVERED                                 \
+  parse_stats.recoveries++;                       \
+  yyerrok;
 
 #define SET_NODELOC(Current)			\
-  node_lineno = Current;
+  node_lineno = (Current).first_line;
 
 /* IMPORTANT NOTE ON LINE NUMBERS
 *********************************
@@ -73,15 +96,20 @@ $$ = plus(int_const($1), int_const($3));
 
 */
 
-extern char *curr_filename;
+/* The parser is reentrant: everything it would otherwise keep in
+    globals, the scanner, the file name, the result and the error count,
+    is in the Parse_State passed to cool_yyparse() and on to the lexer.
+    See cool-lex.h. */
 
-void yyerror(const char *s);  /*  defined below; called for each parse error */
-extern int yylex();           /*  the entry point to the lexer  */
-Program ast_root;	      /* the result of the parse  */
-Classes parse_results;        /* for use in semantic analysis */
-int omerrs = 0;               /* number of erros in lexing and parsing */
+/* yyerror, called for each parse error, and add_class, which adds a
+    class to the program or streams it out, are defined below and
+    declared in cool-lex.h; descent-parse.cc uses them too. */
 %}
 
+%define api.pure full
+%parse-param {Parse_State *ps}
+%lex-param {Parse_State *ps}
+
 /* A union of all the types that can be the result of parsing actions. */
 %union {
   bool boolean;
@@ -157,28 +185,31 @@ int omerrs = 0;               /* number of erros in lexing and parsing */
 %left '.'
 
 %%
-// Save the root of the abstract syntax tree in a global variable.
-program	: class_list	{ @$ = @1; ast_root = program($1); };
+// Save the root of the abstract syntax tree, if the caller wants it.
+program	: class_list
+{ @$ = @1;
+  if (ps->make_program)
+    ps->program = program($1); };
 
 class_list
 : class			/* single class */
-{ $$ = single_Classes($1);
-  parse_results = $$; }
+{ $$ = add_class(ps, NULL, $1);
+  ps->classes = $$; }
 | error ';' 
-{ yyerrok; }
+{ RECOVERED }
 | class_list class	/* several classes */
-{ $$ = append_Classes($1,single_Classes($2));
-  parse_results = $$; }
+{ $$ = add_class(ps, $1, $2);
+  ps->classes = $$; }
 |  class_list[a1] error ';'
 { $$ = $a1;
-  yyerrok; }
+  RECOVERED }
 
 /* If no parent is specified, the class inherits from the Object class. */
 class	: CLASS TYPEID '{' optional_feature_list '}' ';'
 { $$ = class_($2,idtable.add_string("Object"),$4,
-        stringtable.add_string(curr_filename)); }
+        stringtable.add_string(ps->filename)); }
 | CLASS TYPEID INHERITS TYPEID '{' optional_feature_list '}' ';'
-{ $$ = class_($2,$4,$6,stringtable.add_string(curr_filename)); }
+{ $$ = class_($2,$4,$6,stringtable.add_string(ps->filename)); }
 
 /* Feature list may be empty, but no empty features in list. */
 optional_feature_list:		/* empty */
@@ -189,12 +220,12 @@ optional_feature_list:		/* empty */
 feature_list: feature ';'
 { $$ = single_Features($1); }
 | error ';'
-{ yyerrok; }
+{ RECOVERED }
 | feature_list feature ';'
 { $$ = append_Features($1, single_Features($2)); }
 | feature_list[a1] error ';'
 { $$ = $a1;
-  yyerrok; };
+  RECOVERED };
 /* end of grammar */
 
 feature[res]: OBJECTID[a1] formals[a2] ':' TYPEID[a3] '{' expr[a4] '}'
@@ -283,12 +314,12 @@ expr_block_list[res]: expr[a1]';'
 { $res = single_Expressions($a1); }
 | error ';'
 { $res = nil_Expressions(); 
-  yyerrok; }
+  RECOVERED }
 | expr_block_list[a2] expr[a1] ';'
 { $res = append_Expressions($a2, single_Expressions($a1)); }
 | expr_block_list[a1] error ';'
 { $$ = $a1;
-  yyerrok; }
+  RECOVERED }
 
 case_list[res]: case[a1]
 { $res = single_Cases($a1); }
@@ -308,20 +339,43 @@ let_body[res]: OBJECTID[a1] ':' TYPEID[a2] IN expr[a3]
 { $res = let($a1, $a2, $a3, $a4); }
 | error ',' let_body[a1]
 { $$ = $a1; 
-  yyerrok;}
+  RECOVERED }
 | error IN expr[a3] 
-{ yyerrok; }
+{ RECOVERED }
 %%
 
-/* This function is called automatically when Bison detects a parse error. */
-void yyerror(const char *s)
+/* This function is called automatically when Bison detects a parse error.
+   The lookahead token is the last one the lexer returned, which
+   cool_yylex() keeps in ps->token and ps->token_value. */
+void yyerror(YYLTYPE *loc, Parse_State *ps, const char *s)
 {
-  extern int curr_lineno;
+  if (ps->errors > 50)
+    return;                     /* already giving up; see cool_yylex() */
 
-  std::cerr << "\"" << curr_filename << "\", line " << curr_lineno << ": " \
+  *ps->err << "\"" << ps->filename << "\", line " << ps->lineno << ": " \
     << s << " at or near ";
-  print_cool_token(yychar);
-  std::cerr << std::endl;
-  omerrs++;
-  if(omerrs>50) { std::cerr << "More than 50 errors" << std::endl; exit(1);}
-}
\ No newline at end of file
+  print_cool_token(*ps->err, ps->token, ps->token_value);
+  *ps->err << std::endl;
+  ps->errors++;
+  parse_stats.syntax_errors++;
+  if (ps->errors > 50)
+    *ps->err << "More than 50 errors" << std::endl;
+}
+
+/* With a Class_Sink (--stream), each class is handed on as soon as it is
+   parsed and its nodes are freed; no list of classes is kept.  Nothing
+   else on the parser's stack holds nodes at this point: the class list
+   is the only thing below it.  Once there has been an error the classes
+   may hold the debris of error recovery, so they are only freed. */
+Classes add_class(Parse_State *ps, Classes list, Class_ c)
+{
+  if (ps->sink) {
+    if (ps->errors == 0)
+      ps->sink->emit(c);
+    release_tree_nodes_to(ps->mark);
+    return NULL;
+  }
+  if (list == NULL)
+    return single_Classes(c);
+  return append_Classes(list, single_Classes(c));
+}
@@ -0,0 +1,880 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////////
+//
+//  descent-parse.cc
+//
+//  The parser of --engine descent: the grammar of cool.y, coded by hand.
+//  Classes and features are parsed by recursive descent; expressions by
+//  precedence climbing, with the levels of cool.y's precedence
+//  declarations, driven by a stack of their own.  It takes its tokens from
+//  cool_yylex, builds the same tree, with the same line numbers, and
+//  leaves the same results in the Parse_State as cool_yyparse.
+//
+//  Errors.  A hand-written parser finds an error at the same token as
+//  Bison's (both stop at the first token that no program can continue
+//  with), so the message is the same.  Recovery follows what Bison does
+//  with the error rules of cool.y:
+//
+//    - the error is unwound (each function returns NULL, and parse_expr
+//      pops its continuations) to the innermost construct that has an
+//      error rule: the let being parsed, else the block, else the class
+//      body, else the class list;
+//    - that construct throws away tokens up to the one after "error" in
+//      its rule (';', or ',' or IN in a let) and carries on;
+//    - errstatus is Bison's yyerrstatus: no message is given for an
+//      error within three tokens of the last one, and yyerrok clears it
+//      where cool.y says so.
+//
+//  A class body is a recovery point up to the ';' after its '}', as the
+//  state after its '{' is on Bison's stack until then.
+//
+//  Nesting.  An expression is parsed by a loop, which keeps what is left
+//  of each construct it is inside on a stack of continuations (p->conts),
+//  where a recursive parser would keep a C++ frame: a bracketed form
+//  waiting for its ')', THEN or FI, a prefix operator for its operand, a
+//  climb for the right operand of its operator.  So the depth is bounded
+//  by memory and by --max-parse-depth, as Bison's is; past the latter the
+//  parse ends, as Bison's does, with "memory exhausted".  Lets nested in
+//  the bodies of lets share one continuation, with their bindings on a
+//  stack of their own.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include <vector>
+#include "cool-lex.h"
+#include "parse-stats.h"
+
+#define NO_TOKEN (-2)           // the lookahead has not been read
+#define VALUE (-1)              // a step has finished an expression
+
+// Levels of the precedence declarations of cool.y, lowest first.
+enum {
+  PREC_NONE,
+  PREC_IN,
+  PREC_ASSIGN,
+  PREC_NOT,
+  PREC_COMPARE,                 // nonassoc: LE '<' '='
+  PREC_ADD,
+  PREC_MUL,
+  PREC_ISVOID,
+  PREC_NEG,
+};
+
+//
+// A binding of a let whose body is still to come, or the error token
+// where a binding failed to parse (let_body: error ',' let_body, and
+// error IN expr).
+//
+enum Let_Kind { LET_BINDING, LET_ERROR };
+
+struct Let_Binding {
+  Let_Kind kind;
+  int line;
+  Symbol name;
+  Symbol type;
+  Expression init;              // NULL if none
+};
+
+//
+// What is left to do of a construct of an expression while parse_expr is
+// parsing an expression inside it.
+//
+enum Cont_Kind {
+  K_CLIMB,                      // operators of level min or above
+  K_ASSIGN,                     // OBJECTID ASSIGN
+  K_ARGS,                       // the arguments of a dispatch
+  K_PAREN,                      // '(' expr ')'
+  K_UNARY,                      // NOT, ISVOID or '~'
+  K_IF,
+  K_WHILE,
+  K_CASE,
+  K_BLOCK,
+  K_LET,
+};
+
+struct Cont {
+  Cont_Kind kind;
+  int line;                     // of its first token
+  int op;                       // K_CLIMB: the operator waiting for its
+                                //   right operand, or 0 for the operand;
+                                //   K_UNARY: the operator; K_LET: ASSIGN
+                                //   or IN, as b's init or the body is next
+  int min;                      // K_CLIMB: the lowest level it takes
+  int last;                     //   and the level of the last operator
+  Expression e1, e2;            // the expressions it has so far
+  Symbol name, type;            // of a K_ASSIGN, K_ARGS or K_CASE branch
+  int line2;                    //   and the line of the branch
+  Expressions list;             // K_ARGS, K_BLOCK
+  Cases cases;                  // K_CASE
+  size_t lets;                  // K_LET: its bindings on p->lets from here
+  Let_Binding b;                //   and the one being parsed
+};
+
+struct Descent {
+  Parse_State *ps;
+  int tok;                      // the lookahead, or NO_TOKEN
+  YYSTYPE val;                  //   its value
+  int line;                     //   and line
+  int errstatus;                // as Bison's yyerrstatus
+  bool aborted;                 // the parse has given up
+  bool exhausted;               //   for want of stack
+  std::vector<Cont> conts;      // for parse_expr
+  std::vector<Let_Binding> lets;  // for K_LET
+};
+
+//////////////////////////////////////////////////////////////////////////
+//
+//  Tokens and errors
+//
+//////////////////////////////////////////////////////////////////////////
+
+// The lookahead; like Bison, read only when it is needed.
+static inline int look(Descent *p)
+{
+  if (p->tok == NO_TOKEN) {
+    YYLTYPE loc;
+    p->tok = cool_yylex(&p->val, &loc, p->ps);
+    p->line = loc.first_line;
+  }
+  return p->tok;
+}
+
+// Move past the lookahead.
+static inline void shift(Descent *p)
+{
+  if (p->errstatus)
+    p->errstatus--;
+  p->tok = NO_TOKEN;
+}
+
+// Before the action of a rule: the line of its new nodes, and -P.
+static inline void build(int line)
+{
+  STATS_PHASE(PHASE_BUILD);
+  parse_stats.reductions++;
+  node_lineno = line;
+}
+
+static void syntax_error(Descent *p)
+{
+  YYLTYPE loc;
+
+  if (p->errstatus == 0)
+    cool_yyerror(&loc, p->ps, "syntax error");
+  p->errstatus = 3;
+}
+
+static Expression exhausted(Descent *p)
+{
+  YYLTYPE loc;
+
+  cool_yyerror(&loc, p->ps, "memory exhausted");
+  p->aborted = true;
+  p->exhausted = true;
+  return NULL;
+}
+
+//
+// Recover from an error at an error rule "error t1" or "error t2": shift
+// the error token, and throw tokens away until t1 or t2, which is left as
+// the lookahead.  Returns false, having given up, if the input ends
+// first.
+//
+static bool skip_to(Descent *p, int t1, int t2)
+{
+  if (p->aborted)
+    return false;
+  for (;;) {
+    int t = look(p);
+    if (t == t1 || t == t2)
+      return true;
+    if (t == 0) {
+      p->aborted = true;
+      return false;
+    }
+    p->tok = NO_TOKEN;
+  }
+}
+
+static bool expect(Descent *p, int t)
+{
+  if (look(p) != t) {
+    syntax_error(p);
+    return false;
+  }
+  shift(p);
+  return true;
+}
+
+static bool expect_symbol(Descent *p, int t, Symbol *s)
+{
+  if (look(p) != t) {
+    syntax_error(p);
+    return false;
+  }
+  *s = p->val.symbol;
+  shift(p);
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+//
+//  Expressions
+//
+//////////////////////////////////////////////////////////////////////////
+
+static int binary_prec(int tok)
+{
+  switch (tok) {
+  case '<': case LE: case '=':
+    return PREC_COMPARE;
+  case '+': case '-':
+    return PREC_ADD;
+  case '*': case '/':
+    return PREC_MUL;
+  default:
+    return PREC_NONE;
+  }
+}
+
+static Expression binary(int op, Expression e1, Expression e2)
+{
+  switch (op) {
+  case '+': return plus(e1, e2);
+  case '-': return sub(e1, e2);
+  case '*': return mul(e1, e2);
+  case '/': return divide(e1, e2);
+  case '<': return lt(e1, e2);
+  case LE:  return leq(e1, e2);
+  default:  return eq(e1, e2);
+  }
+}
+
+static Cont &push(Descent *p, Cont_Kind kind, int line)
+{
+  Cont c = Cont();
+
+  c.kind = kind;
+  c.line = line;
+  p->conts.push_back(c);
+  return p->conts.back();
+}
+
+// The value of a step that has finished an expression, or failed.
+static int value(Expression *e, Expression v)
+{
+  *e = v;
+  return VALUE;
+}
+
+// The dispatch on top of the stack, its ')' having been shifted.
+static int dispatched(Descent *p, Expression *e)
+{
+  Cont c = p->conts.back();
+
+  p->conts.pop_back();
+  build(c.line);
+  if (c.e1 == NULL)
+    return value(e, dispatch(object(idtable.add_string("self")), c.name,
+                             c.list));
+  if (c.type != NULL)
+    return value(e, static_dispatch(c.e1, c.type, c.name, c.list));
+  return value(e, dispatch(c.e1, c.name, c.list));
+}
+
+// '(' ')' or '(' expr_list ')': the arguments of the dispatch on top.
+static int args(Descent *p, Expression *e)
+{
+  if (!expect(p, '('))
+    return value(e, NULL);
+  if (look(p) == ')') {
+    shift(p);
+    p->conts.back().list = nil_Expressions();
+    return dispatched(p, e);
+  }
+  return PREC_IN;
+}
+
+// The next expression of the block on top, or its '}'.
+static int block_next(Descent *p, Expression *e)
+{
+  Cont &c = p->conts.back();
+
+  if (c.list != NULL && look(p) == '}') {
+    shift(p);
+    Expressions list = c.list;
+    int line = c.line;
+    p->conts.pop_back();
+    build(line);
+    return value(e, block(list));
+  }
+  return PREC_IN;
+}
+
+// OBJECTID ':' TYPEID DARROW of the next branch of the case on top.
+static int case_branch(Descent *p, Expression *e)
+{
+  Cont &c = p->conts.back();
+
+  c.line2 = (look(p), p->line);
+  if (!expect_symbol(p, OBJECTID, &c.name) || !expect(p, ':') ||
+      !expect_symbol(p, TYPEID, &c.type) || !expect(p, DARROW))
+    return value(e, NULL);
+  return PREC_IN;
+}
+
+//
+// The bindings of the let on top: OBJECTID ':' TYPEID [ASSIGN expr], up
+// to the ',' or IN after it, from the one in c.b if bound, else from the
+// next.  A let that begins the body of another is the whole of it, so its
+// bindings join the same chain.
+//
+static int let_bindings(Descent *p, bool bound, Expression *e)
+{
+  Cont &c = p->conts.back();
+
+  for (;; bound = false) {
+    if (!bound) {
+      c.b.kind = LET_BINDING;
+      c.b.line = (look(p), p->line);
+      c.b.init = NULL;
+      if (!expect_symbol(p, OBJECTID, &c.b.name) || !expect(p, ':') ||
+          !expect_symbol(p, TYPEID, &c.b.type))
+        return value(e, NULL);
+      if (look(p) == ASSIGN) {
+        shift(p);
+        c.op = ASSIGN;
+        return PREC_IN;
+      }
+      if (p->tok != ',' && p->tok != IN) {
+        syntax_error(p);
+        return value(e, NULL);
+      }
+    }
+    if (p->tok == ',') {
+      shift(p);
+      p->lets.push_back(c.b);
+      continue;
+    }
+    shift(p);                   // IN
+    if (look(p) == LET) {
+      shift(p);
+      p->lets.push_back(c.b);
+      continue;
+    }
+    c.op = IN;
+    return PREC_IN;
+  }
+}
+
+//
+// Start an expression of operators of level min or above, and the
+// operand before its operators: a constant, a name, an assignment, a
+// bracketed form, or a prefix operator.  Only the forms without an
+// expression inside are finished here; the others push what is left of
+// them and ask for the expression they begin with.
+//
+static int begin(Descent *p, int min, Expression *e)
+{
+  if ((long) p->conts.size() >= max_parse_depth)
+    return value(e, exhausted(p));
+
+  int tok = look(p);
+  int line = p->line;
+  YYSTYPE val = p->val;
+  Symbol type;
+
+  Cont &c = push(p, K_CLIMB, line);
+  c.min = min;
+  c.last = PREC_NONE;
+  switch (tok) {
+  case OBJECTID:
+    shift(p);
+    if (look(p) == ASSIGN) {
+      shift(p);
+      push(p, K_ASSIGN, line).name = val.symbol;
+      return PREC_ASSIGN;
+    }
+    if (p->tok == '(') {
+      push(p, K_ARGS, line).name = val.symbol;
+      return args(p, e);
+    }
+    build(line);
+    return value(e, object(val.symbol));
+  case INT_CONST:
+    shift(p);
+    build(line);
+    return value(e, int_const(val.symbol));
+  case STR_CONST:
+    shift(p);
+    build(line);
+    return value(e, string_const(val.symbol));
+  case BOOL_CONST:
+    shift(p);
+    build(line);
+    return value(e, bool_const(val.boolean));
+  case NEW:
+    shift(p);
+    if (!expect_symbol(p, TYPEID, &type))
+      return value(e, NULL);
+    build(line);
+    return value(e, new_(type));
+  case '(':
+    shift(p);
+    push(p, K_PAREN, line);
+    return PREC_IN;
+  case IF:
+    shift(p);
+    push(p, K_IF, line);
+    return PREC_IN;
+  case WHILE:
+    shift(p);
+    push(p, K_WHILE, line);
+    return PREC_IN;
+  case CASE:
+    shift(p);
+    push(p, K_CASE, line);
+    return PREC_IN;
+  case '{':
+    shift(p);
+    push(p, K_BLOCK, line);
+    return block_next(p, e);
+  case LET:
+    shift(p);
+    push(p, K_LET, line).lets = p->lets.size();
+    return let_bindings(p, false, e);
+  case NOT:
+    shift(p);
+    push(p, K_UNARY, line).op = NOT;
+    return PREC_NOT + 1;
+  case ISVOID:
+    shift(p);
+    push(p, K_UNARY, line).op = ISVOID;
+    return PREC_ISVOID + 1;
+  case '~':
+    shift(p);
+    push(p, K_UNARY, line).op = '~';
+    return PREC_NEG + 1;
+  default:
+    syntax_error(p);
+    return value(e, NULL);
+  }
+}
+
+//
+// The climb on top has its operand v, or the right operand v of its
+// operator.  The dispatches bind tightest of all; the operand is then
+// combined with the operators that follow it, each right operand taking
+// in the operators above the level of its own (all of them are left
+// associative).  A comparison may not be the left operand of another.
+//
+static int climb(Descent *p, Expression v, Expression *e)
+{
+  Cont &c = p->conts.back();
+
+  if (c.op == 0) {
+    if (look(p) == '.' || p->tok == '@') {
+      Symbol type = NULL, name;
+      if (p->tok == '@') {
+        shift(p);
+        if (!expect_symbol(p, TYPEID, &type) || !expect(p, '.'))
+          return value(e, NULL);
+      } else
+        shift(p);
+      if (!expect_symbol(p, OBJECTID, &name))
+        return value(e, NULL);
+      Cont &d = push(p, K_ARGS, c.line);
+      d.e1 = v;
+      d.type = type;
+      d.name = name;
+      return args(p, e);
+    }
+    c.e1 = v;
+  } else {
+    build(c.line);
+    c.e1 = binary(c.op, c.e1, v);
+    c.last = binary_prec(c.op);
+    c.op = 0;
+  }
+
+  int op = look(p);
+  int prec = binary_prec(op);
+  if (prec < c.min) {
+    v = c.e1;
+    p->conts.pop_back();
+    return value(e, v);
+  }
+  if (prec == PREC_COMPARE && c.last == PREC_COMPARE) {
+    syntax_error(p);
+    return value(e, NULL);
+  }
+  shift(p);
+  c.op = op;
+  return prec + 1;
+}
+
+// The construct on top has the expression v it asked for; carry on with it.
+static int resume(Descent *p, Expression v, Expression *e)
+{
+  Cont &c = p->conts.back();
+  Cont done;
+
+  switch (c.kind) {
+  case K_CLIMB:
+    return climb(p, v, e);
+  case K_ASSIGN:
+    done = c;
+    p->conts.pop_back();
+    build(done.line);
+    return value(e, assign(done.name, v));
+  case K_ARGS:
+    c.list = c.list ? append_Expressions(c.list, single_Expressions(v))
+                    : single_Expressions(v);
+    if (look(p) == ',') {
+      shift(p);
+      return PREC_IN;
+    }
+    if (!expect(p, ')'))
+      return value(e, NULL);
+    return dispatched(p, e);
+  case K_PAREN:
+    p->conts.pop_back();
+    return value(e, expect(p, ')') ? v : NULL);
+  case K_UNARY:
+    done = c;
+    p->conts.pop_back();
+    build(done.line);
+    return value(e, done.op == NOT ? comp(v) :
+                    done.op == ISVOID ? isvoid(v) : neg(v));
+  case K_IF:
+    if (c.e1 == NULL) {
+      c.e1 = v;
+      return expect(p, THEN) ? PREC_IN : value(e, NULL);
+    }
+    if (c.e2 == NULL) {
+      c.e2 = v;
+      return expect(p, ELSE) ? PREC_IN : value(e, NULL);
+    }
+    if (!expect(p, FI))
+      return value(e, NULL);
+    done = c;
+    p->conts.pop_back();
+    build(done.line);
+    return value(e, cond(done.e1, done.e2, v));
+  case K_WHILE:
+    if (c.e1 == NULL) {
+      c.e1 = v;
+      return expect(p, LOOP) ? PREC_IN : value(e, NULL);
+    }
+    if (!expect(p, POOL))
+      return value(e, NULL);
+    done = c;
+    p->conts.pop_back();
+    build(done.line);
+    return value(e, loop(done.e1, v));
+  case K_CASE:
+    if (c.e1 == NULL) {
+      c.e1 = v;
+      return expect(p, OF) ? case_branch(p, e) : value(e, NULL);
+    }
+    if (!expect(p, ';'))
+      return value(e, NULL);
+    build(c.line2);
+    {
+      Case k = branch(c.name, c.type, v);
+      c.cases = c.cases ? append_Cases(c.cases, single_Cases(k))
+                        : single_Cases(k);
+    }
+    if (look(p) != ESAC)
+      return case_branch(p, e);
+    shift(p);
+    done = c;
+    p->conts.pop_back();
+    build(done.line);
+    return value(e, typcase(done.e1, done.cases));
+  case K_BLOCK:
+    if (look(p) != ';') {
+      syntax_error(p);
+      return value(e, NULL);
+    }
+    shift(p);
+    c.list = c.list ? append_Expressions(c.list, single_Expressions(v))
+                    : single_Expressions(v);
+    return block_next(p, e);
+  case K_LET:
+    if (c.op == ASSIGN) {
+      c.b.init = v;
+      if (look(p) == ',' || p->tok == IN)
+        return let_bindings(p, true, e);
+      syntax_error(p);
+      return value(e, NULL);
+    }
+    p->lets.push_back(c.b);
+    while (p->lets.size() > c.lets) {
+      Let_Binding &b = p->lets.back();
+      if (b.kind == LET_BINDING) {
+        build(b.line);
+        v = let(b.name, b.type, b.init ? b.init : no_expr(), v);
+      } else {
+        p->errstatus = 0;       // yyerrok
+        parse_stats.recoveries++;
+      }
+      p->lets.pop_back();
+    }
+    p->conts.pop_back();
+    return value(e, v);
+  }
+  return value(e, NULL);
+}
+
+//
+// An error has been found in the construct on top: recover from it if
+// it has an error rule (the block's "error ';'", the let's "error ','"
+// and "error IN"), else give it up.
+//
+static int recover(Descent *p, Expression *e)
+{
+  Cont &c = p->conts.back();
+
+  switch (c.kind) {
+  case K_BLOCK:
+    if (!skip_to(p, ';', ';'))
+      break;
+    shift(p);
+    p->errstatus = 0;           // yyerrok
+    parse_stats.recoveries++;
+    if (c.list == NULL)
+      c.list = nil_Expressions();
+    return block_next(p, e);
+  case K_LET:
+    if (!skip_to(p, ',', IN)) {
+      p->lets.resize(c.lets);
+      break;
+    }
+    c.b.kind = LET_ERROR;
+    return let_bindings(p, true, e);
+  default:
+    break;
+  }
+  p->conts.pop_back();
+  return value(e, NULL);
+}
+
+//
+// An expression of operators of level min or above, or NULL after an
+// error that no construct within it recovered from.  Each step either
+// finishes an expression, or pushes what is left of the construct it is
+// in and asks for the next expression at some level; so the nesting is
+// held on p->conts, not on the C++ stack.
+//
+static Expression parse_expr(Descent *p, int min)
+{
+  size_t base = p->conts.size();
+  Expression e = NULL;
+  int next = min;
+
+  for (;;) {
+    if (next != VALUE)
+      next = begin(p, next, &e);
+    else if (p->conts.size() == base)
+      return e;
+    else if (e == NULL)
+      next = recover(p, &e);
+    else
+      next = resume(p, e, &e);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////
+//
+//  Classes and features
+//
+//////////////////////////////////////////////////////////////////////////
+
+// formals: '(' ')' or '(' formal_list ')'
+static Formals parse_formals(Descent *p)
+{
+  Formals list = NULL;
+
+  shift(p);
+  if (look(p) == ')') {
+    shift(p);
+    return nil_Formals();
+  }
+  for (;;) {
+    Symbol name, type;
+    int line = (look(p), p->line);
+    if (!expect_symbol(p, OBJECTID, &name) || !expect(p, ':') ||
+        !expect_symbol(p, TYPEID, &type))
+      return NULL;
+    build(line);
+    Formal f = formal(name, type);
+    list = list ? append_Formals(list, single_Formals(f)) : single_Formals(f);
+    if (look(p) != ',')
+      break;
+    shift(p);
+  }
+  return expect(p, ')') ? list : NULL;
+}
+
+static Feature parse_feature(Descent *p)
+{
+  int line = p->line;
+  Symbol name = p->val.symbol, type;
+  Expression e;
+
+  shift(p);
+  if (look(p) == '(') {
+    Formals formals = parse_formals(p);
+    if (formals == NULL || !expect(p, ':') ||
+        !expect_symbol(p, TYPEID, &type) || !expect(p, '{') ||
+        (e = parse_expr(p, PREC_IN)) == NULL || !expect(p, '}'))
+      return NULL;
+    build(line);
+    return method(name, formals, type, e);
+  }
+  if (!expect(p, ':') || !expect_symbol(p, TYPEID, &type))
+    return NULL;
+  if (look(p) == ASSIGN) {
+    shift(p);
+    if ((e = parse_expr(p, PREC_IN)) == NULL)
+      return NULL;
+    build(line);
+    return attr(name, type, e);
+  }
+  build(line);
+  return attr(name, type, no_expr());
+}
+
+//
+// The features of a class, from after its '{' to the ';' after its '}'.
+// An error anywhere in there is recovered from by feature_list's error
+// rules; one after the '}' brings the parse back into the class body.
+//
+static Features parse_features(Descent *p)
+{
+  Features list = NULL;
+
+  for (;;) {
+    switch (look(p)) {
+    case OBJECTID: {
+      Feature f = parse_feature(p);
+      if (f == NULL)
+        break;
+      if (look(p) != ';') {
+        syntax_error(p);
+        break;
+      }
+      shift(p);
+      list = list ? append_Features(list, single_Features(f))
+                  : single_Features(f);
+      continue;
+    }
+    case '}':
+      shift(p);
+      if (look(p) == ';') {
+        shift(p);
+        return list ? list : nil_Features();
+      }
+      syntax_error(p);
+      list = NULL;
+      break;
+    default:
+      syntax_error(p);
+      list = NULL;
+      break;
+    }
+    if (!skip_to(p, ';', ';'))
+      return NULL;
+    shift(p);
+    p->errstatus = 0;           // yyerrok
+    parse_stats.recoveries++;
+  }
+}
+
+// CLASS TYPEID [INHERITS TYPEID] '{' optional_feature_list '}' ';'
+static Class_ parse_class(Descent *p)
+{
+  int line = p->line;
+  Symbol name, parent = NULL;
+
+  shift(p);
+  if (!expect_symbol(p, TYPEID, &name))
+    return NULL;
+  if (look(p) == INHERITS) {
+    shift(p);
+    if (!expect_symbol(p, TYPEID, &parent))
+      return NULL;
+  }
+  if (!expect(p, '{'))
+    return NULL;
+  Features features = parse_features(p);
+  if (features == NULL)
+    return NULL;
+  build(line);
+  return class_(name, parent ? parent : idtable.add_string("Object"),
+                features, stringtable.add_string(p->ps->filename));
+}
+
+static void parse_program(Descent *p)
+{
+  Parse_State *ps = p->ps;
+  Classes list = NULL;
+  bool have_list = false;       // a class_list has been parsed
+  int line = 0;                 //   and its line
+
+  for (;;) {
+    if (look(p) == CLASS) {
+      int class_line = p->line;
+      Class_ c = parse_class(p);
+      if (c != NULL) {
+        if (!have_list)
+          line = class_line;
+        build(line);
+        list = ps->classes = add_class(ps, have_list ? list : NULL, c);
+        have_list = true;
+        continue;
+      }
+    } else if (have_list && p->tok == 0) {
+      build(line);
+      if (ps->make_program)
+        ps->program = program(list);
+      return;
+    } else
+      syntax_error(p);
+    if (!skip_to(p, ';', ';'))
+      return;
+    if (!have_list)
+      line = p->line;
+    shift(p);
+    p->errstatus = 0;           // yyerrok
+    parse_stats.recoveries++;
+    have_list = true;
+  }
+}
+
+int descent_parse(Parse_State *ps)
+{
+  Descent p;
+
+  p.ps = ps;
+  p.tok = NO_TOKEN;
+  p.line = ps->lineno;
+  p.errstatus = 0;
+  p.aborted = false;
+  p.exhausted = false;
+  parse_program(&p);
+  return p.exhausted ? 2 : p.aborted ? 1 : 0;
+}
+
+int run_parser(Parse_State *ps)
+{
+  if (parse_engine == ENGINE_DESCENT)
+    return descent_parse(ps);
+  return cool_yyparse(ps);
+}
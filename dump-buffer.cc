@@ -0,0 +1,139 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//
+// dump-buffer.cc
+//
+//  The buffered output of dump_with_types; see dump-buffer.h.
+//
+
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+#include "dump-buffer.h"
+#include "string-scan.h"
+
+static const char spaces[DUMP_MAX_PAD + 1] =
+  "                                                                                ";
+
+Dump_Buffer::Dump_Buffer(int fd)
+  : buf(new char[DUMP_BUFFER_SIZE]), used(0), fd(fd), stream(NULL) { }
+
+Dump_Buffer::Dump_Buffer(ostream &s)
+  : buf(new char[DUMP_BUFFER_SIZE]), used(0), fd(-1), stream(&s) { }
+
+Dump_Buffer::~Dump_Buffer()
+{
+  flush();
+  delete [] buf;
+}
+
+static void write_all(int fd, const char *s, size_t n)
+{
+  while (n > 0) {
+    ssize_t w = write(fd, s, n);
+    if (w < 0 && errno == EINTR)
+      continue;
+    if (w <= 0) {
+      cerr << "Could not write the tree" << endl;
+      exit(1);
+    }
+    s += w;
+    n -= w;
+  }
+}
+
+void Dump_Buffer::drain()
+{
+  if (fd >= 0)
+    write_all(fd, buf, used);
+  else
+    stream->write(buf, used);
+  used = 0;
+}
+
+void Dump_Buffer::flush()
+{
+  drain();
+  if (stream)
+    stream->flush();
+}
+
+Dump_Buffer &Dump_Buffer::text(const char *s, size_t n)
+{
+  room(n);
+  if (n > DUMP_BUFFER_SIZE) {   // too big to buffer; used is 0
+    if (fd >= 0)
+      write_all(fd, s, n);
+    else
+      stream->write(s, n);
+    return *this;
+  }
+  memcpy(buf + used, s, n);
+  used += n;
+  return *this;
+}
+
+Dump_Buffer &Dump_Buffer::operator<<(int i)
+{
+  char digits[16];
+  char *p = digits + sizeof(digits);
+  unsigned u = i < 0 ? 0u - i : i;
+
+  do {
+    *--p = '0' + u % 10;
+    u /= 10;
+  } while (u);
+  if (i < 0)
+    *--p = '-';
+  return text(p, digits + sizeof(digits) - p);
+}
+
+Dump_Buffer &Dump_Buffer::pad(int n)
+{
+  if (n <= 0)
+    return *this;
+  return text(spaces, n < DUMP_MAX_PAD ? n : DUMP_MAX_PAD);
+}
+
+//
+// As print_escaped_string: the usual escapes for \\, \", \n, \t, \b and
+// \f, other unprintable characters in octal.  The runs of characters
+// that need no escape are copied whole.
+//
+Dump_Buffer &Dump_Buffer::escaped(const char *s, size_t n)
+{
+  const char *end = s + n;
+
+  while (s < end) {
+    size_t run = printable_run(s, end);
+    if (run) {
+      text(s, run);
+      s += run;
+      if (s == end)
+        break;
+    }
+
+    unsigned char c = *s++;
+    room(4);
+    char *p = buf + used;
+    switch (c) {
+    case '\\': p[0] = '\\'; p[1] = '\\'; used += 2; break;
+    case '\"': p[0] = '\\'; p[1] = '\"'; used += 2; break;
+    case '\n': p[0] = '\\'; p[1] = 'n'; used += 2; break;
+    case '\t': p[0] = '\\'; p[1] = 't'; used += 2; break;
+    case '\b': p[0] = '\\'; p[1] = 'b'; used += 2; break;
+    case '\f': p[0] = '\\'; p[1] = 'f'; used += 2; break;
+    default:
+      p[0] = '\\';
+      p[1] = '0' + (c >> 6);
+      p[2] = '0' + ((c >> 3) & 7);
+      p[3] = '0' + (c & 7);
+      used += 4;
+    }
+  }
+  return *this;
+}
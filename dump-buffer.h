@@ -0,0 +1,54 @@
+#ifndef DUMP_BUFFER_H
+#define DUMP_BUFFER_H
+
+//
+// dump-buffer.h
+//
+//  The output of dump_with_types.  Text is gathered in one large buffer
+//  and handed to the file descriptor (with a single write(2)) or the
+//  ostream only when the buffer fills or is flushed, so a node costs a
+//  few memcpys rather than a chain of ostream insertions and an endl.
+//
+//  pad(), the Symbol output and escaped() produce exactly what pad(),
+//  operator<< and print_escaped_string in utilities.h would.
+//
+
+#include <stddef.h>
+#include <string.h>
+#include "cool-io.h"
+#include "stringtab.h"
+
+#define DUMP_BUFFER_SIZE (1 << 18)
+#define DUMP_MAX_PAD 80         // as utilities.h's pad()
+
+class Dump_Buffer {
+  char *buf;
+  size_t used;
+  int fd;                       // where the text goes: fd, if >= 0,
+  ostream *stream;              //   otherwise stream
+
+  void drain();                 // write out the buffer and empty it
+  void room(size_t n) { if (used + n > DUMP_BUFFER_SIZE) drain(); }
+public:
+  explicit Dump_Buffer(int fd);
+  explicit Dump_Buffer(ostream &s);
+  ~Dump_Buffer();               // flushes
+
+  void flush();
+
+  Dump_Buffer &text(const char *s, size_t n);
+  Dump_Buffer &operator<<(const char *s) { return text(s, strlen(s)); }
+  Dump_Buffer &operator<<(char c)
+    { room(1); buf[used++] = c; return *this; }
+  Dump_Buffer &operator<<(int i);
+  Dump_Buffer &operator<<(Symbol s)
+    { return text(s->get_string(), s->get_len()); }
+
+  Dump_Buffer &pad(int n);      // n spaces, at most DUMP_MAX_PAD
+  Dump_Buffer &escaped(const char *s, size_t n);
+  Dump_Buffer &escaped(const char *s) { return escaped(s, strlen(s)); }
+};
+
+void dump_program_header(Dump_Buffer& stream, int n, int line);
+
+#endif
@@ -0,0 +1,343 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#include <stdio.h>
+#include "cool-tree.h"
+#include "tree-walk.h"
+#include "utilities.h"
+#include "dump-buffer.h"
+
+//
+// dump_with_types prints the abstract syntax tree with the type of each
+// expression, in the format read by the later phases of the compiler.
+// It is a walk of the tree (tree-walk.h): each node prints what comes
+// before its first subtree, between its subtrees and after its last,
+// and the elements of a list are printed where the list would be.
+//
+
+//
+//  Print the type of an expression, or "_no_type" if it has none.
+//
+void Expression_class::dump_type(Dump_Buffer& stream, int n)
+{
+  if (type)
+    { stream.pad(n) << ": " << type << '\n'; }
+  else
+    { stream.pad(n) << ": _no_type\n"; }
+}
+
+static void dump_line(Dump_Buffer& stream, int n, tree_node *t)
+{
+  stream.pad(n) << '#' << t->get_line_number() << '\n';
+}
+
+static void dump_Symbol(Dump_Buffer& stream, int n, Symbol sym)
+{
+  stream.pad(n) << sym << '\n';
+}
+
+static void dump_Boolean(Dump_Buffer& stream, int n, Boolean b)
+{
+  stream.pad(n) << (int) b << '\n';
+}
+
+struct Typed_Dump_Walk {
+  Dump_Buffer& stream;
+  Typed_Dump_Walk(Dump_Buffer& s) : stream(s) { }
+  int part(tree_node *t, int i, int n)
+    { return t->dump_with_types_part(stream, n, i); }
+};
+
+static void dump_tree_with_types(tree_node *t, Dump_Buffer& stream, int n)
+{
+  Typed_Dump_Walk w(stream);
+  walk_tree(t, w, n);
+}
+
+int tree_node::dump_with_types_part(Dump_Buffer&, int n, int)
+{
+  return n;                     // a list, whose elements go in its place
+}
+
+void Program_class::dump_with_types(Dump_Buffer& s, int n)
+  { dump_tree_with_types(this, s, n); }
+void Class__class::dump_with_types(Dump_Buffer& s, int n)
+  { dump_tree_with_types(this, s, n); }
+void Feature_class::dump_with_types(Dump_Buffer& s, int n)
+  { dump_tree_with_types(this, s, n); }
+void Formal_class::dump_with_types(Dump_Buffer& s, int n)
+  { dump_tree_with_types(this, s, n); }
+void Case_class::dump_with_types(Dump_Buffer& s, int n)
+  { dump_tree_with_types(this, s, n); }
+void Expression_class::dump_with_types(Dump_Buffer& s, int n)
+  { dump_tree_with_types(this, s, n); }
+
+//
+// The tree can still be dumped to any ostream; it goes through a
+// Dump_Buffer all the same.
+//
+template <class Node> static void dump_to_stream(Node *t, ostream& s, int n)
+{
+  Dump_Buffer stream(s);
+  t->dump_with_types(stream, n);
+}
+
+void Program_class::dump_with_types(ostream& s, int n)
+  { dump_to_stream(this, s, n); }
+void Class__class::dump_with_types(ostream& s, int n)
+  { dump_to_stream(this, s, n); }
+void Feature_class::dump_with_types(ostream& s, int n)
+  { dump_to_stream(this, s, n); }
+void Formal_class::dump_with_types(ostream& s, int n)
+  { dump_to_stream(this, s, n); }
+void Case_class::dump_with_types(ostream& s, int n)
+  { dump_to_stream(this, s, n); }
+void Expression_class::dump_with_types(ostream& s, int n)
+  { dump_to_stream(this, s, n); }
+
+//
+// The start of a program's dump, before its classes at n+2.  --stream
+// writes it and then dumps each class as it is parsed.
+//
+void dump_program_header(Dump_Buffer& stream, int n, int line)
+{
+   stream.pad(n) << '#' << line << '\n';
+   stream.pad(n) << "_program\n";
+}
+
+int program_class::dump_with_types_part(Dump_Buffer& stream, int n, int i)
+{
+   if (i == 0)
+     dump_program_header(stream, n, line_number);
+   return n+2;
+}
+
+int class__class::dump_with_types_part(Dump_Buffer& stream, int n, int i)
+{
+   switch (i) {
+   case 0:
+     dump_line(stream,n,this);
+     stream.pad(n) << "_class\n";
+     dump_Symbol(stream, n+2, name);
+     dump_Symbol(stream, n+2, parent);
+     stream.pad(n+2) << "\"";
+     stream.escaped(filename->get_string(), filename->get_len());
+     stream << "\"\n";
+     stream.pad(n+2) << "(\n";
+     break;                     // features
+   case 1:
+     stream.pad(n+2) << ")\n";
+   }
+   return n+2;
+}
+
+int method_class::dump_with_types_part(Dump_Buffer& stream, int n, int i)
+{
+   switch (i) {
+   case 0:
+     dump_line(stream,n,this);
+     stream.pad(n) << "_method\n";
+     dump_Symbol(stream, n+2, name);
+     break;                     // formals
+   case 1:
+     dump_Symbol(stream, n+2, return_type);
+     break;                     // expr
+   }
+   return n+2;
+}
+
+int attr_class::dump_with_types_part(Dump_Buffer& stream, int n, int i)
+{
+   if (i == 0) {
+     dump_line(stream,n,this);
+     stream.pad(n) << "_attr\n";
+     dump_Symbol(stream, n+2, name);
+     dump_Symbol(stream, n+2, type_decl);
+   }                            // init
+   return n+2;
+}
+
+int formal_class::dump_with_types_part(Dump_Buffer& stream, int n, int)
+{
+   dump_line(stream,n,this);
+   stream.pad(n) << "_formal\n";
+   dump_Symbol(stream, n+2, name);
+   dump_Symbol(stream, n+2, type_decl);
+   return n+2;
+}
+
+int branch_class::dump_with_types_part(Dump_Buffer& stream, int n, int i)
+{
+   if (i == 0) {
+     dump_line(stream,n,this);
+     stream.pad(n) << "_branch\n";
+     dump_Symbol(stream, n+2, name);
+     dump_Symbol(stream, n+2, type_decl);
+   }                            // expr
+   return n+2;
+}
+
+int assign_class::dump_with_types_part(Dump_Buffer& stream, int n, int i)
+{
+   switch (i) {
+   case 0:
+     dump_line(stream,n,this);
+     stream.pad(n) << "_assign\n";
+     dump_Symbol(stream, n+2, name);
+     break;                     // expr
+   case 1:
+     dump_type(stream,n);
+   }
+   return n+2;
+}
+
+int static_dispatch_class::dump_with_types_part(Dump_Buffer& stream, int n,
+                                                int i)
+{
+   switch (i) {
+   case 0:
+     dump_line(stream,n,this);
+     stream.pad(n) << "_static_dispatch\n";
+     break;                     // expr
+   case 1:
+     dump_Symbol(stream, n+2, type_name);
+     dump_Symbol(stream, n+2, name);
+     stream.pad(n+2) << "(\n";
+     break;                     // actual
+   case 2:
+     stream.pad(n+2) << ")\n";
+     dump_type(stream,n);
+   }
+   return n+2;
+}
+
+int dispatch_class::dump_with_types_part(Dump_Buffer& stream, int n, int i)
+{
+   switch (i) {
+   case 0:
+     dump_line(stream,n,this);
+     stream.pad(n) << "_dispatch\n";
+     break;                     // expr
+   case 1:
+     dump_Symbol(stream, n+2, name);
+     stream.pad(n+2) << "(\n";
+     break;                     // actual
+   case 2:
+     stream.pad(n+2) << ")\n";
+     dump_type(stream,n);
+   }
+   return n+2;
+}
+
+int let_class::dump_with_types_part(Dump_Buffer& stream, int n, int i)
+{
+   switch (i) {
+   case 0:
+     dump_line(stream,n,this);
+     stream.pad(n) << "_let\n";
+     dump_Symbol(stream, n+2, identifier);
+     dump_Symbol(stream, n+2, type_decl);
+     break;                     // init, body
+   case 2:
+     dump_type(stream,n);
+   }
+   return n+2;
+}
+
+//
+// The rest of the expressions print a name, their subtrees and their
+// type.
+//
+static int dump_expr_part(Dump_Buffer& stream, int n, int i, int last,
+                          Expression e, const char *name)
+{
+   if (i == 0) {
+     dump_line(stream,n,e);
+     stream.pad(n) << name;
+   }
+   if (i == last)
+     e->dump_type(stream,n);
+   return n+2;
+}
+
+#define DUMP_EXPR_PART(cls, subtrees, name)                             \
+int cls::dump_with_types_part(Dump_Buffer& stream, int n, int i)        \
+  { return dump_expr_part(stream, n, i, subtrees, this, name); }
+
+DUMP_EXPR_PART(cond_class, 3, "_cond\n")
+DUMP_EXPR_PART(loop_class, 2, "_loop\n")
+DUMP_EXPR_PART(typcase_class, 2, "_typcase\n")
+DUMP_EXPR_PART(block_class, 1, "_block\n")
+DUMP_EXPR_PART(plus_class, 2, "_plus\n")
+DUMP_EXPR_PART(sub_class, 2, "_sub\n")
+DUMP_EXPR_PART(mul_class, 2, "_mul\n")
+DUMP_EXPR_PART(divide_class, 2, "_divide\n")
+DUMP_EXPR_PART(neg_class, 1, "_neg\n")
+DUMP_EXPR_PART(lt_class, 2, "_lt\n")
+DUMP_EXPR_PART(eq_class, 2, "_eq\n")
+DUMP_EXPR_PART(leq_class, 2, "_leq\n")
+DUMP_EXPR_PART(comp_class, 1, "_comp\n")
+DUMP_EXPR_PART(isvoid_class, 1, "_isvoid\n")
+
+//
+// Expressions without subtrees are printed in their one part.
+//
+
+int int_const_class::dump_with_types_part(Dump_Buffer& stream, int n, int)
+{
+   dump_line(stream,n,this);
+   stream.pad(n) << "_int\n";
+   dump_Symbol(stream, n+2, token);
+   dump_type(stream,n);
+   return n+2;
+}
+
+int bool_const_class::dump_with_types_part(Dump_Buffer& stream, int n, int)
+{
+   dump_line(stream,n,this);
+   stream.pad(n) << "_bool\n";
+   dump_Boolean(stream, n+2, val);
+   dump_type(stream,n);
+   return n+2;
+}
+
+int string_const_class::dump_with_types_part(Dump_Buffer& stream, int n, int)
+{
+   dump_line(stream,n,this);
+   stream.pad(n) << "_string\n";
+   stream.pad(n+2) << "\"";
+   stream.escaped(token->get_string(), token->get_len());
+   stream << "\"\n";
+   dump_type(stream,n);
+   return n+2;
+}
+
+int new__class::dump_with_types_part(Dump_Buffer& stream, int n, int)
+{
+   dump_line(stream,n,this);
+   stream.pad(n) << "_new\n";
+   dump_Symbol(stream, n+2, type_name);
+   dump_type(stream,n);
+   return n+2;
+}
+
+int no_expr_class::dump_with_types_part(Dump_Buffer& stream, int n, int)
+{
+   line_number = 0;     // an absent expression has no line of its own
+   dump_line(stream,n,this);
+   stream.pad(n) << "_no_expr\n";
+   dump_type(stream,n);
+   return n+2;
+}
+
+int object_class::dump_with_types_part(Dump_Buffer& stream, int n, int)
+{
+   dump_line(stream,n,this);
+   stream.pad(n) << "_object\n";
+   dump_Symbol(stream, n+2, name);
+   dump_type(stream,n);
+   return n+2;
+}
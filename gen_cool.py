@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+
+# Generate synthetic Cool programs for benchmarking the parser.
+#
+#   python3 gen_cool.py WORKLOAD [SCALE] > file.cl
+#
+# The output depends only on WORKLOAD and SCALE, so timings of the same
+# workload can be compared from one build to the next.  SCALE (default 1)
+# multiplies the size; at 1 every workload is a few megabytes of source.
+
+import random
+import sys
+
+def let_chain(out, rng, depth):
+    # let x0 : Int <- 0 in let x1 : Int <- x0 + 1 in ... in x<depth-1>
+    out.append("    let x0 : Int <- %d in\n" % rng.randrange(100))
+    for i in range(1, depth):
+        out.append("    let x%d : Int <- x%d + %d in\n" % (i, i - 1, rng.randrange(100)))
+    out.append("      x%d\n" % (depth - 1))
+
+def gen_classes(scale, rng):
+    # Many small classes, each with attributes, a method and a dispatch.
+    out = []
+    n = 8000 * scale
+    for c in range(n):
+        parent = "Object" if c == 0 else "C%d" % rng.randrange(c)
+        out.append("class C%d inherits %s {\n" % (c, parent))
+        out.append("  a%d : Int <- %d;\n" % (c, rng.randrange(1000)))
+        out.append("  s%d : String <- \"class %d\";\n" % (c, c))
+        out.append("  b%d : Bool <- %s;\n" % (c, rng.choice(["true", "false"])))
+        out.append("  m%d(x : Int, y : Int) : Int {\n" % c)
+        out.append("    if x < y then x + a%d else y * %d fi\n" % (c, rng.randrange(1, 9)))
+        out.append("  };\n")
+        out.append("  n%d() : Object { self.m%d(a%d, %d) };\n" % (c, c, c, rng.randrange(1000)))
+        out.append("};\n\n")
+    return out
+
+def gen_let(scale, rng):
+    # Methods whose bodies are let chains 300 deep.
+    out = ["class Main {\n"]
+    for m in range(300 * scale):
+        out.append("  m%d() : Int {\n" % m)
+        let_chain(out, rng, 300)
+        out.append("  };\n")
+    out.append("};\n")
+    return out
+
+def gen_plus(scale, rng):
+    # Methods whose bodies are long left-associative + chains.
+    out = ["class Main {\n"]
+    for m in range(20 * scale):
+        terms = ["%d" % rng.randrange(1000) for i in range(20000)]
+        out.append("  m%d() : Int {\n    " % m)
+        for i in range(0, len(terms), 20):
+            out.append(" + ".join(terms[i:i + 20]))
+            out.append(" +\n    " if i + 20 < len(terms) else "\n")
+        out.append("  };\n")
+    out.append("};\n")
+    return out
+
+def gen_dispatch(scale, rng):
+    # Dispatches with thousands of actual arguments.
+    out = ["class Main {\n  f(x : Int) : Int { x };\n"]
+    for m in range(40 * scale):
+        out.append("  m%d(a : Int) : Object {\n    self.f(\n" % m)
+        args = []
+        for i in range(5000):
+            k = rng.randrange(3)
+            if k == 0:
+                args.append("%d" % rng.randrange(1000))
+            elif k == 1:
+                args.append("a")
+            else:
+                args.append("f(%d)" % i)
+        out.append(",\n".join("      " + a for a in args))
+        out.append("\n    )\n  };\n")
+    out.append("};\n")
+    return out
+
+def gen_block(scale, rng):
+    # Methods whose bodies are { } blocks of many thousand expressions.
+    out = ["class Main {\n  x : Int;\n"]
+    for m in range(10 * scale):
+        out.append("  m%d() : Int {\n  {\n" % m)
+        for i in range(10000):
+            k = rng.randrange(4)
+            if k == 0:
+                out.append("    x <- x + %d;\n" % rng.randrange(1000))
+            elif k == 1:
+                out.append("    out_int(x);\n")
+            elif k == 2:
+                out.append("    if x < %d then x else 0 fi;\n" % rng.randrange(1000))
+            else:
+                out.append("    \"line %d\";\n" % i)
+        out.append("    x;\n  }\n  };\n")
+    out.append("};\n")
+    return out
+
+def gen_case(scale, rng):
+    # case expressions with thousands of branches.
+    out = ["class Main {\n"]
+    for m in range(20 * scale):
+        out.append("  m%d(o : Object) : Int {\n    case o of\n" % m)
+        for i in range(5000):
+            out.append("      v%d : T%d => %d;\n" % (i, rng.randrange(100000), rng.randrange(1000)))
+        out.append("    esac\n  };\n")
+    out.append("};\n")
+    return out
+
+WORKLOADS = {
+    "classes": gen_classes,
+    "let": gen_let,
+    "plus": gen_plus,
+    "dispatch": gen_dispatch,
+    "block": gen_block,
+    "case": gen_case,
+}
+
+def generate(name, scale=1):
+    rng = random.Random(name)           # the same program every time
+    return "".join(WORKLOADS[name](scale, rng))
+
+def main():
+    if len(sys.argv) not in (2, 3) or sys.argv[1] not in WORKLOADS:
+        print("Usage: python3 gen_cool.py WORKLOAD [SCALE]")
+        print("Workloads: " + " ".join(sorted(WORKLOADS)))
+        sys.exit(1)
+    scale = int(sys.argv[2]) if len(sys.argv) == 3 else 1
+    sys.stdout.write(generate(sys.argv[1], scale))
+
+if __name__ == "__main__":
+    main()
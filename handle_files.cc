@@ -0,0 +1,438 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////////
+//
+//  handle_files.cc
+//
+//  Parses the files named on the command line (or standard input) one
+//  after another and joins their classes into one program.  With -j the
+//  files are parsed on several threads, or when there is only one, its
+//  classes are; the result is the same.  With --cache-dir, a source file
+//  that was parsed before is read from the cache instead (ast-cache.h).
+//
+//  stream_files (--stream) parses the files one after another in the
+//  same way, but hands each class on as it is parsed instead.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "cool-io.h"
+#include "cool-tree.h"
+#include "handle_flags.h"
+#include "cool-lex.h"
+#include "ast-cache.h"
+#include "parse-stats.h"
+
+FILE *token_file;              // the file being parsed
+extern char *curr_filename;
+extern int curr_lineno;
+
+int omerrs = 0;                // number of errors in lexing and parsing
+Classes parse_results;         // the classes of the last file parsed
+
+static Classes all_classes = nil_Classes();
+static Class_Sink *class_sink;  // when streaming
+
+static bool parse_classes_in_parallel(const Source_Text *src);
+
+//
+// Run work(i) for each i in [0, n) on up to parse_jobs threads.
+//
+template <class Work> static void run_in_parallel(int n, Work work)
+{
+  std::atomic<int> next(0);
+  std::vector<std::thread> threads;
+
+  int nthreads = parse_jobs < n ? parse_jobs : n;
+  STATS_BEGIN(PHASE_PARSE);     // -P's wall time of the threads' work
+  for (int t = 0; t < nthreads; t++)
+    threads.push_back(std::thread([&]() {
+      for (int i; (i = next++) < n; )
+        work(i);
+      if (report_stats)
+        add_thread_stats();
+    }));
+  for (int t = 0; t < nthreads; t++)
+    threads[t].join();
+  STATS_BEGIN(PHASE_OTHER);
+}
+
+//
+// The line of the first token of src.  A file with no syntax errors
+// begins with a class, and the program node gets the line of the first
+// class of the last file parsed.
+//
+static int first_token_line(const Source_Text *src)
+{
+  Lex_State lex = Lex_State();
+  YYSTYPE value;
+
+  start_lex(&lex, src->text, src->len);
+  lex_token(&lex, &value);
+  finish_lex(&lex);
+  return lex.lineno;
+}
+
+static int first_token_line(const char *filename)
+{
+  FILE *f = fopen(filename, "r");
+  if (f == NULL)
+    return 1;                  // handle_file will say it cannot be opened
+
+  Source_Text src = Source_Text();
+  load_source(f, filename, &src);
+  int line = first_token_line(&src);
+  free_source(&src);
+  fclose(f);
+  return line;
+}
+
+//
+// Parse token_file.  Error messages go to cerr as they are found; the
+// count carries over from file to file, and parsing stops after 50.
+//
+static void parse_token_file()
+{
+  Parse_State ps;
+  Source_Text src = Source_Text();
+  Ast_Cache_Key key;
+
+  init_parse_state(&ps, lex_input, curr_filename, &cerr);
+  ps.errors = omerrs;
+  if (lex_input == LEX_SOURCE) {
+    load_source(token_file, curr_filename, &src);
+    if (class_sink) {
+      if (token_file == stdin)
+        class_sink->start(first_token_line(&src));
+      ps.sink = class_sink;
+      ps.mark = mark_tree_nodes();
+    }
+    else {
+      if (cache_dir) {
+        ast_cache_key(src.text, src.len, &key);
+        if (ast_cache_lookup(&key, curr_filename, &parse_results,
+                             &node_lineno)) {
+          free_source(&src);
+          return;
+        }
+      }
+      if (parse_jobs > 1 && parse_classes_in_parallel(&src)) {
+        free_source(&src);
+        if (cache_dir)
+          ast_cache_store(&key, parse_results, node_lineno);
+        return;
+      }
+    }
+    start_lex(&ps.lex, src.text, src.len);
+  }
+
+  STATS_BEGIN(PHASE_PARSE);
+  run_parser(&ps);
+  STATS_BEGIN(PHASE_OTHER);
+
+  finish_lex(&ps.lex);
+  free_source(&src);
+  if (cache_dir && !class_sink && lex_input == LEX_SOURCE &&
+      ps.errors == omerrs)
+    ast_cache_store(&key, ps.classes, node_lineno);
+  omerrs = ps.errors;
+  if (omerrs > 50) {
+    if (class_sink)
+      class_sink->flush();
+    exit(1);                   // yyerror said "More than 50 errors"
+  }
+  parse_results = class_sink ? nil_Classes() : ps.classes;
+}
+
+void handle_file(const char *filename)
+{
+  curr_lineno = 1;
+  curr_filename = (char *) filename;
+  token_file = fopen(filename, "r");
+  if (token_file == NULL) {
+    if (class_sink)
+      class_sink->flush();
+    cerr << "Could not open input file " << filename << endl;
+    exit(1);
+  }
+  parse_token_file();
+  all_classes = append_Classes(all_classes, parse_results);
+  parse_results = nil_Classes();
+  fclose(token_file);
+}
+
+//////////////////////////////////////////////////////////////////////////
+//
+//  Parallel parsing (-j)
+//
+//  Each file is parsed on its own, into a node arena and an error stream
+//  of its own.  The results are then taken in command-line order: the
+//  messages are printed and the classes appended just as they would
+//  have been had the files been parsed one after another, stopping at
+//  the same file that cannot be opened or at the same 51st error.
+//
+//////////////////////////////////////////////////////////////////////////
+
+struct File_Job {
+  const char *filename;
+  bool opened;
+  Classes classes;
+  int errors;
+  std::string messages;
+  Tree_Arena nodes;
+  int node_lineno;              // as the parse left it
+};
+
+static void parse_job(File_Job *job)
+{
+  FILE *f = fopen(job->filename, "r");
+  job->opened = f != NULL;
+  if (f == NULL)
+    return;
+
+  Source_Text src = Source_Text();
+  std::ostringstream err;
+  Parse_State ps;
+  Ast_Cache_Key key;
+  Tree_Arena thread_nodes = swap_tree_nodes(Tree_Arena());
+
+  load_source(f, job->filename, &src);
+  if (cache_dir) {
+    ast_cache_key(src.text, src.len, &key);
+    if (ast_cache_lookup(&key, job->filename, &job->classes,
+                         &job->node_lineno)) {
+      free_source(&src);
+      fclose(f);
+      job->errors = 0;
+      job->nodes = swap_tree_nodes(thread_nodes);
+      return;
+    }
+  }
+  init_parse_state(&ps, LEX_SOURCE, job->filename, &err);
+  start_lex(&ps.lex, src.text, src.len);
+  STATS_BEGIN(PHASE_PARSE);
+  run_parser(&ps);
+  STATS_BEGIN(PHASE_OTHER);
+  finish_lex(&ps.lex);
+  free_source(&src);
+  fclose(f);
+  if (cache_dir && ps.errors == 0)
+    ast_cache_store(&key, ps.classes, node_lineno);
+
+  job->classes = ps.classes;
+  job->errors = ps.errors;
+  job->messages = err.str();
+  job->nodes = swap_tree_nodes(thread_nodes);
+  job->node_lineno = node_lineno;
+}
+
+// Print the messages of job, as parse_token_file would have.
+static void report_job(File_Job *job)
+{
+  if (!job->opened) {
+    cerr << "Could not open input file " << job->filename << endl;
+    exit(1);
+  }
+
+  const char *m = job->messages.c_str();
+  for (int i = 0; i < job->errors; i++) {
+    const char *nl = strchr(m, '\n');
+    cerr.write(m, nl + 1 - m);
+    m = nl + 1;
+    if (++omerrs > 50) {
+      cerr << "More than 50 errors" << endl;
+      exit(1);
+    }
+  }
+}
+
+static void parse_files_in_parallel(int nfiles, const char *files[])
+{
+  std::vector<File_Job> jobs(nfiles);
+
+  for (int i = 0; i < nfiles; i++)
+    jobs[i].filename = files[i];
+  run_in_parallel(nfiles, [&](int i) { parse_job(&jobs[i]); });
+
+  for (int i = 0; i < nfiles; i++) {
+    report_job(&jobs[i]);
+    node_lineno = jobs[i].node_lineno;
+    all_classes = append_Classes(all_classes, jobs[i].classes);
+    adopt_tree_arena(&jobs[i].nodes);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////
+//
+//  Parsing the classes of one file in parallel (-j, one input)
+//
+//  The file is scanned once, and its tokens are cut before each CLASS
+//  that is outside any braces.  The top-level classes of a program are
+//  independent, so runs of them can be parsed apart and their class
+//  lists appended, giving the classes and line numbers of one parse of
+//  the whole file.
+//
+//  Anything that would produce a message, an ERROR token or a syntax
+//  error in any run, sends the file back to the ordinary parse, so
+//  messages and error recovery are exactly those of the sequential
+//  parser; -P then counts only what that parse does.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#define RUNS_PER_JOB 8          // runs of classes per thread, for balance
+
+struct Class_Run {
+  const Scanned_Token *begin, *end;
+  Classes classes;
+  int errors;
+  Tree_Arena nodes;
+  int node_lineno;              // as the parse left it
+  Parse_Stats counts;           // -P's, taken back if the file is parsed again
+};
+
+static void parse_run(Class_Run *run)
+{
+  Parse_State ps;
+  std::ostringstream err;       // not shown; the file is parsed again
+  Tree_Arena thread_nodes = swap_tree_nodes(Tree_Arena());
+  Parse_Stats before = parse_stats;
+
+  init_parse_state(&ps, LEX_SOURCE, curr_filename, &err);
+  ps.scanned = run->begin;
+  ps.scanned_end = run->end;
+  STATS_BEGIN(PHASE_PARSE);
+  run_parser(&ps);
+  STATS_BEGIN(PHASE_OTHER);
+
+  run->classes = ps.classes;
+  run->errors = ps.errors;
+  run->nodes = swap_tree_nodes(thread_nodes);
+  run->node_lineno = node_lineno;
+  counts_since(&run->counts, &before);
+}
+
+static bool parse_classes_in_parallel(const Source_Text *src)
+{
+  std::vector<Scanned_Token> tokens;
+  std::vector<int> cuts;        // indices of the top-level CLASS tokens
+  Lex_State lex = Lex_State();
+  Scanned_Token t;
+  int depth = 0;
+
+  STATS_BEGIN(PHASE_SCAN);
+  start_lex(&lex, src->text, src->len);
+  while ((t.token = lex_token(&lex, &t.value)) != 0) {
+    t.lineno = lex.lineno;
+    switch (t.token) {
+    case CLASS:
+      if (depth == 0)
+        cuts.push_back(tokens.size());
+      break;
+    case '{':
+      depth++;
+      break;
+    case '}':
+      depth--;
+      break;
+    case ERROR:
+      finish_lex(&lex);
+      STATS_BEGIN(PHASE_OTHER);
+      return false;
+    }
+    tokens.push_back(t);
+  }
+  finish_lex(&lex);
+  STATS_BEGIN(PHASE_OTHER);
+  if (cuts.size() < 2 || cuts[0] != 0)
+    return false;
+
+  // Runs of whole classes of about the same number of tokens.
+  std::vector<Class_Run> runs;
+  size_t run_size = tokens.size() / (parse_jobs * RUNS_PER_JOB) + 1;
+  for (size_t c = 0; c < cuts.size(); ) {
+    Class_Run run = Class_Run();
+    run.begin = &tokens[cuts[c]];
+    while (++c < cuts.size() && &tokens[cuts[c]] - run.begin < (long) run_size)
+      ;
+    run.end = c < cuts.size() ? &tokens[cuts[c]] : &tokens[0] + tokens.size();
+    runs.push_back(run);
+  }
+
+  run_in_parallel(runs.size(), [&](int i) { parse_run(&runs[i]); });
+
+  for (size_t i = 0; i < runs.size(); i++)
+    if (runs[i].errors) {
+      for (size_t j = 0; j < runs.size(); j++) {
+        release_tree_arena(&runs[j].nodes);
+        discard_counts(&runs[j].counts);
+      }
+      return false;
+    }
+
+  // One parse of the file ends by reducing the class list of its first
+  // class to a program, and leaves node_lineno there.
+  parse_results = runs[0].classes;
+  for (size_t i = 1; i < runs.size(); i++)
+    parse_results = append_Classes(parse_results, runs[i].classes);
+  for (size_t i = 0; i < runs.size(); i++)
+    adopt_tree_arena(&runs[i].nodes);
+  node_lineno = runs[0].node_lineno;
+  parse_stats.tokens += tokens.size();   // counted once the runs are kept
+  parse_stats.reductions -= runs.size() - 1;  // each run's to a program
+  return true;
+}
+
+Program handle_files(int argc, const char *argv[])
+{
+  if (optind >= argc) {
+    token_file = stdin;
+    parse_token_file();
+    all_classes = parse_results;
+  }
+  // The token-stream readers (-k, -b) share token_file, so only source
+  // files are parsed in parallel.
+  else if (parse_jobs > 1 && lex_input == LEX_SOURCE && argc - optind > 1 &&
+           !class_sink) {
+    parse_files_in_parallel(argc - optind, argv + optind);
+    optind = argc;
+  }
+  for (; optind < argc; optind++)
+    handle_file(argv[optind]);
+  if (cache_dir)
+    ast_cache_trim();
+
+  if (omerrs) {
+    if (class_sink)
+      class_sink->flush();
+    cerr << "Compilation halted due to lex and parse errors\n";
+    exit(1);
+  }
+  return program(all_classes);
+}
+
+//
+// Parse the files as handle_files does, giving each class to sink as it
+// is parsed rather than keeping it.  The messages and the exit on errors
+// are those of handle_files, but the classes before the first error
+// have been handed on, and written out, by then.  Only Cool source can be streamed.
+//
+void stream_files(int argc, const char *argv[], Class_Sink *sink)
+{
+  class_sink = sink;
+  if (optind < argc)
+    sink->start(first_token_line(argv[argc - 1]));
+  handle_files(argc, argv);
+  class_sink = NULL;
+}
@@ -0,0 +1,294 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////////
+//
+//  handle_flags.cc
+//
+//  Command line processing shared by all phases of the compiler.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include "cool-io.h"
+#include "handle_flags.h"
+
+extern int cool_yydebug;
+
+int semant_debug;
+int cgen_optimize;
+char *out_filename;
+
+int lex_verbose;
+int cgen_debug;
+bool disable_reg_alloc;
+int check_stack;
+int no_source;
+int emode;
+int emit_stabs;
+int emit_openver;
+int emit_tryfinally;
+
+Memmgr cgen_Memmgr = GC_NOGC;
+Memmgr_Test cgen_Memmgr_Test = GC_NORMAL;
+Memmgr_Debug cgen_Memmgr_Debug = GC_QUICK;
+
+Lex_Input lex_input = LEX_SOURCE;
+Parse_Engine parse_engine = ENGINE_BISON;
+int emit_tokens;
+int parse_jobs = 1;
+int emit_ast;
+int read_ast_input;
+int stream_classes;
+char *cache_dir;
+long cache_size = 256;
+long max_parse_depth = 10000000;
+int report_stats;
+char *stats_file;
+int run_program;
+int native_code;
+
+enum { OPT_CACHE_DIR = 256, OPT_CACHE_SIZE, OPT_STREAM, OPT_STATS_FILE,
+       OPT_MAX_PARSE_DEPTH, OPT_ENGINE, OPT_RUN, OPT_NATIVE };
+
+static struct option long_options[] = {
+  { "cache-dir",  required_argument, NULL, OPT_CACHE_DIR },
+  { "cache-size", required_argument, NULL, OPT_CACHE_SIZE },
+  { "stream",     no_argument,       NULL, OPT_STREAM },
+  { "stats-file", required_argument, NULL, OPT_STATS_FILE },
+  { "max-parse-depth", required_argument, NULL, OPT_MAX_PARSE_DEPTH },
+  { "engine",     required_argument, NULL, OPT_ENGINE },
+  { "run",        no_argument,       NULL, OPT_RUN },
+  { "native",     no_argument,       NULL, OPT_NATIVE },
+  { NULL, 0, NULL, 0 },
+};
+
+void handle_flags(int argc, const char *argv[])
+{
+  int c;
+  int unknownopt = 0;
+
+  // no debugging or optimization by default
+  yy_flex_debug = 0;
+  cool_yydebug = 0;
+  lex_verbose  = 0;
+  semant_debug = 0;
+  cgen_debug   = 0;
+  cgen_optimize = 0;
+  disable_reg_alloc = 0;
+  emit_tryfinally = 0;
+  no_source = 0;
+  emode = 1;
+
+  // -run and -native are spelled with one dash, which getopt would read
+  // as -r -u -n and so on.
+  for (int i = 1; i < argc; i++)
+    if (strcmp(argv[i], "-run") == 0)
+      argv[i] = "--run";
+    else if (strcmp(argv[i], "-native") == 0)
+      argv[i] = "--native";
+    else if (strcmp(argv[i], "--") == 0)
+      break;
+
+  while ((c = getopt_long(argc, (char **) argv, "lpscvrOo:gtTSANJKLVFkbEBdPj:",
+                          long_options, NULL)) != -1) {
+    switch (c) {
+#ifdef DEBUG
+    case 'l':
+      yy_flex_debug = 1;
+      break;
+    case 'p':
+      cool_yydebug = 1;
+      break;
+    case 's':
+      semant_debug = 1;
+      break;
+    case 'c':
+      cgen_debug = 1;
+      break;
+    case 'v':
+      lex_verbose = 1;
+      break;
+    case 'r':
+      disable_reg_alloc = 1;
+      break;
+#else
+    case 'l':
+    case 'p':
+    case 's':
+    case 'c':
+    case 'v':
+    case 'r':
+      cerr << "No debugging available\n";
+      break;
+#endif
+    case 'F':
+      emit_tryfinally = 1;
+      break;
+    case 'S':
+      check_stack = 1;
+      break;
+    case 'V':
+      emit_openver = 1;
+      break;
+    case 'g':  // enable garbage collection
+      cgen_Memmgr = GC_GENGC;
+      break;
+    case 't':  // run garbage collection on every allocation
+      cgen_Memmgr_Test = GC_TEST;
+      break;
+    case 'T':  // enable garbage collector debugging
+      cgen_Memmgr_Debug = GC_DEBUG;
+      break;
+    case 'o':  // set the name of the output file
+      out_filename = optarg;
+      break;
+    case 'O':  // enable optimization
+      cgen_optimize = 1;
+      break;
+    case 'A':
+      break;
+    case 'N':
+      no_source = 1;
+      break;
+    case 'J':
+      emode = 1;
+      break;
+    case 'K':
+      emode = 2;
+      break;
+    case 'L':
+      emit_stabs = 1;
+      break;
+    case 'k':  // tokens come from a separate ./lexer process
+      lex_input = LEX_TEXT_TOKENS;
+      break;
+    case 'b':  // tokens come from "parser -E" in binary
+      lex_input = LEX_BINARY_TOKENS;
+      break;
+    case 'E':  // write the binary token stream instead of parsing
+      emit_tokens = 1;
+      break;
+    case 'B':  // hand the tree on in binary
+      emit_ast = 1;
+      break;
+    case 'd':  // print a tree from "parser -B" as text
+      read_ast_input = 1;
+      break;
+    case 'P':  // report where the time went
+      report_stats = 1;
+      break;
+    case 'j':  // parse the input files on this many threads
+      parse_jobs = atoi(optarg);
+      if (parse_jobs < 1)
+        unknownopt = 1;
+      break;
+    case OPT_CACHE_DIR:  // keep parsed files here, by their contents
+      cache_dir = optarg;
+      break;
+    case OPT_CACHE_SIZE:  // megabytes the cache may take
+      cache_size = atol(optarg);
+      if (cache_size < 1)
+        unknownopt = 1;
+      break;
+    case OPT_STREAM:  // hand on each class as soon as it is parsed
+      stream_classes = 1;
+      break;
+    case OPT_STATS_FILE:  // the report of -P, as JSON
+      report_stats = 1;
+      stats_file = optarg;
+      break;
+    case OPT_MAX_PARSE_DEPTH:  // how deep the parser's stack may grow
+      max_parse_depth = atol(optarg);
+      if (max_parse_depth < 1)
+        unknownopt = 1;
+      break;
+    case OPT_RUN:  // execute the program
+      run_program = 1;
+      break;
+    case OPT_NATIVE:  // compile the program to x86-64 assembly
+      native_code = 1;
+      break;
+    case OPT_ENGINE:  // which parser: bison or descent
+      if (strcmp(optarg, "bison") == 0)
+        parse_engine = ENGINE_BISON;
+      else if (strcmp(optarg, "descent") == 0)
+        parse_engine = ENGINE_DESCENT;
+      else
+        unknownopt = 1;
+      break;
+    case '?':
+      unknownopt = 1;
+      break;
+    case ':':
+      unknownopt = 1;
+      break;
+    }
+  }
+
+  // Only Cool source can be streamed; see stream_files.
+  if (stream_classes && lex_input != LEX_SOURCE)
+    unknownopt = 1;
+  // A program is run whole, and its output is its own.
+  if (run_program && (stream_classes || emit_tokens || emit_ast))
+    unknownopt = 1;
+  // So is a program compiled.
+  if (native_code && (run_program || stream_classes || emit_tokens || emit_ast))
+    unknownopt = 1;
+
+  if (unknownopt) {
+    cerr << "Usage: " << argv[0]
+	 << " [-lvpscOgtrANJKLVFkbEBdP -j jobs -o outname]\n"
+	 << "\t[--cache-dir dir --cache-size megabytes --stream --stats-file file]\n"
+	 << "\t[--max-parse-depth entries --engine bison|descent -run -native]\n"
+	 << "\t[input-files]\n"
+	 << "\n\tGeneral Settings:\n"
+	 << "\t-O,\t\tEnable optimization\n"
+	 << "\t-g,\t\tEnable garbage collection\n"
+	 << "\t-t,\t\tRun garbage collection on every allocation\n"
+	 << "\t-L,\t\tEmit stabs (source directives)\n"
+	 << "\t-V,\t\tEmit openver entry point\n"
+	 << "\n\tFront End:\n"
+	 << "\t-k,\t\tRead a token stream from ./lexer instead of Cool source\n"
+	 << "\t-b,\t\tRead a binary token stream from parser -E\n"
+	 << "\t-E,\t\tWrite the binary token stream of the input and stop\n"
+	 << "\t-B,\t\tWrite the tree in binary, for the later phases\n"
+	 << "\t-d,\t\tPrint a binary tree from parser -B as text\n"
+	 << "\t-j N,\t\tParse files (or the classes of one file) on N threads\n"
+	 << "\t--cache-dir D,\tKeep the trees of parsed files in D, and reuse them\n"
+	 << "\t--cache-size M,\tLimit the cache to M megabytes (default 256)\n"
+	 << "\t--stream,\tWrite each class as soon as it is parsed, then free it\n"
+	 << "\t--max-parse-depth N,\tLet the parser's stack grow to N entries\n"
+	 << "\t\t\t(default 10000000)\n"
+	 << "\t--engine E,\tParse with Bison's tables (bison, the default) or\n"
+	 << "\t\t\tthe hand-written parser (descent)\n"
+	 << "\t-run,\t\tExecute the program, with no simulator\n"
+	 << "\t-native,\tCompile the program to x86-64 assembly, to be linked\n"
+	 << "\t\t\twith x86-runtime.c\n"
+	 << "\t-P,\t\tReport the time of each phase, and counts, on stderr\n"
+	 << "\t--stats-file F,\tWrite that report to F, as JSON\n"
+	 << "\n\tDebugging:\n"
+	 << "\t-l,\t\tEnable lexer debugging\n"
+	 << "\t-p,\t\tEnable parser debugging\n"
+	 << "\t-s,\t\tEnable semantic debugging\n"
+	 << "\t-c,\t\tEnable code gen debugging\n"
+	 << "\t-v,\t\tEnable verbose lexer debugging\n"
+	 << "\t-r,\t\tDisable register allocation\n"
+	 << "\n\tAnnotations:\n"
+	 << "\t-S,\t\tEmit stack checks\n"
+	 << "\t-N,\t\tEmit only annotations (no source)\n"
+	 << "\n\tExceptions:\n"
+	 << "\t-J,\t\tGenerate code for exceptions with long jumps (default)\n"
+	 << "\t-K,\t\tGenerate code for exceptions with table lookups method\n"
+	 << "\t-F,\t\tGenerate code for try-finally expressions\n"
+	 << "\n\n";
+    exit(1);
+  }
+}
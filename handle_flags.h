@@ -0,0 +1,69 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#ifndef HANDLE_FLAGS_H
+#define HANDLE_FLAGS_H
+
+//
+// Flags shared by every phase of the compiler.  They are set from the
+// command line by handle_flags().
+//
+
+enum Memmgr { GC_NOGC, GC_GENGC, GC_SNCGC };
+enum Memmgr_Test { GC_NORMAL, GC_TEST };
+enum Memmgr_Debug { GC_QUICK, GC_DEBUG };
+
+extern Memmgr cgen_Memmgr;
+extern Memmgr_Test cgen_Memmgr_Test;
+extern Memmgr_Debug cgen_Memmgr_Debug;
+
+//
+// Where cool_yylex gets its tokens from.  By default the parser scans
+// Cool source directly; LEX_TEXT_TOKENS reads the "#<line> TOKEN lexeme"
+// stream printed by a separate lexer process (./lexer foo.cl | ./parser -k)
+// and LEX_BINARY_TOKENS the binary stream of token-stream.h
+// (./parser -E foo.cl | ./parser -b).
+//
+enum Lex_Input { LEX_SOURCE, LEX_TEXT_TOKENS, LEX_BINARY_TOKENS };
+
+extern Lex_Input lex_input;
+
+//
+// Which parser to run (--engine): the tables Bison makes of cool.y, or
+// the hand-written parser of descent-parse.cc.
+//
+enum Parse_Engine { ENGINE_BISON, ENGINE_DESCENT };
+
+extern Parse_Engine parse_engine;
+extern int emit_tokens;     // -E: write the binary token stream and stop
+extern int parse_jobs;      // -j N: parse files, or the classes of one file,
+                            // on up to N threads
+extern int emit_ast;        // -B: write the tree in binary (ast-binary.h)
+extern int read_ast_input;  // -d: print the binary tree on stdin as text
+extern int stream_classes;  // --stream: write each class as it is parsed
+extern char *cache_dir;     // --cache-dir: where parsed files are cached
+extern long cache_size;     // --cache-size: its limit, in megabytes
+extern long max_parse_depth; // --max-parse-depth: entries on the parser stack
+extern int report_stats;    // -P: time the phases and count (parse-stats.h)
+extern char *stats_file;    // --stats-file: where, as JSON, instead of cerr
+extern int run_program;     // -run: execute the program instead (vm.h)
+extern int native_code;     // -native: compile it to x86-64 (x86-cgen.h)
+extern char *out_filename;  // -o: where its assembly goes, not stdout
+
+extern int yy_flex_debug;
+extern int lex_verbose;
+extern int cgen_debug;
+extern bool disable_reg_alloc;
+extern int check_stack;
+extern int no_source;
+extern int emode;
+extern int emit_stabs;
+extern int emit_openver;
+extern int emit_tryfinally;
+
+void handle_flags(int argc, const char *argv[]);
+
+#endif
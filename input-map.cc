@@ -0,0 +1,58 @@
+//
+// input-map.cc
+//
+//  Mapping of regular input files; see input-map.h.
+//
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "input-map.h"
+
+bool map_input(FILE *f, Input_Map *map)
+{
+  int fd = fileno(f);
+  struct stat st;
+
+  if (fd < 0 || fstat(fd, &st) < 0 || !S_ISREG(st.st_mode))
+    return false;
+  if (lseek(fd, 0, SEEK_CUR) != 0)
+    return false;
+
+  size_t page = sysconf(_SC_PAGESIZE);
+  size_t len = st.st_size;
+  size_t size = (len + 2 + page - 1) & ~(page - 1);
+
+  //
+  // Reserve room for the file and the two '\0's with an anonymous mapping,
+  // then map the file over the front of it.  The kernel zero-fills the
+  // last page of the file past its end, and if the file ends on a page
+  // boundary the '\0's come from the anonymous page after it.
+  //
+  char *base = (char *) mmap(NULL, size, PROT_READ | PROT_WRITE,
+			     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED)
+    return false;
+  if (len > 0) {
+    if (mmap(base, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED,
+	     fd, 0) == MAP_FAILED) {
+      munmap(base, size);
+      return false;
+    }
+    madvise(base, len, MADV_SEQUENTIAL);
+  }
+
+  map->base = base;
+  map->len = len;
+  map->size = size;
+  return true;
+}
+
+void unmap_input(Input_Map *map)
+{
+  if (map->base)
+    munmap(map->base, map->size);
+  map->base = NULL;
+  map->len = map->size = 0;
+}
@@ -0,0 +1,28 @@
+#ifndef INPUT_MAP_H
+#define INPUT_MAP_H
+
+//
+// input-map.h
+//
+//  Scanning an input file in place.  A regular file is mapped copy-on-write
+//  and followed by two '\0' bytes, as flex's yy_scan_buffer wants, so the
+//  scanners read it with no read() calls or copies into their own buffers.
+//  Pipes and terminals cannot be mapped and are still read through stdio.
+//
+
+#include <stdio.h>
+#include <stddef.h>
+
+struct Input_Map {
+  char *base;      // the file contents, then "\0\0"
+  size_t len;      // length of the file
+  size_t size;     // length of the mapping
+};
+
+// Map the rest of f, which must not have been read from yet.  Returns
+// false, leaving f untouched, if f is not a regular file.
+bool map_input(FILE *f, Input_Map *map);
+
+void unmap_input(Input_Map *map);
+
+#endif
@@ -0,0 +1,40 @@
+//
+// parse-api.cc
+//
+//  parse(): one run of the reentrant parser over a buffer; see
+//  parse-api.h.
+//
+
+#include <sstream>
+#include "parse-api.h"
+#include "cool-lex.h"
+
+ParseResult parse(const char *buf, size_t len, const char *filename)
+{
+  ParseResult r;
+  std::ostringstream err;
+  Parse_State ps;
+
+  // The nodes of this parse go in an arena of their own.
+  Tree_Arena caller_nodes = swap_tree_nodes(Tree_Arena());
+  int caller_lineno = node_lineno;
+
+  init_parse_state(&ps, LEX_SOURCE, filename, &err);
+  ps.make_program = true;
+  start_lex(&ps.lex, buf, len);
+  run_parser(&ps);
+  finish_lex(&ps.lex);
+
+  r.errors = ps.errors;
+  r.program = ps.errors ? NULL : ps.program;
+  r.messages = err.str();
+  r.nodes = swap_tree_nodes(caller_nodes);
+  node_lineno = caller_lineno;
+  return r;
+}
+
+void release_parse_result(ParseResult *r)
+{
+  release_tree_arena(&r->nodes);
+  r->program = NULL;
+}
@@ -0,0 +1,41 @@
+#ifndef PARSE_API_H
+#define PARSE_API_H
+
+//
+// parse-api.h
+//
+//  The front end as a library.  parse() keeps no state between calls and
+//  touches no globals but the string tables, which are locked, so any
+//  number of threads may parse at once:
+//
+//    ParseResult r = parse(text, len, "foo.cl");
+//    if (r.program)
+//      r.program->dump_with_types(cout, 0);
+//    else
+//      cerr << r.messages;
+//    release_parse_result(&r);
+//
+//  The string tables (idtable, inttable, stringtable) are shared by all
+//  parses and are never emptied.
+//
+
+#include <stddef.h>
+#include <string>
+#include "cool-tree.h"
+
+struct ParseResult {
+  Program program;              // NULL if there were errors
+  int errors;                   // number of lex and parse errors
+  std::string messages;         // the error messages, one per line
+  Tree_Arena nodes;             // where program's nodes live
+};
+
+// Parse the Cool source buf[0 .. len-1]; filename is used in messages and
+// in the class nodes.  Messages are as parser prints them, including
+// "More than 50 errors" when it gives up.
+ParseResult parse(const char *buf, size_t len, const char *filename);
+
+// Free the nodes of r->program.
+void release_parse_result(ParseResult *r);
+
+#endif
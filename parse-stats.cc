@@ -0,0 +1,257 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//
+// parse-stats.cc
+//
+//  The stopwatch and counters of -P; see parse-stats.h.
+//
+
+#include <stdio.h>
+#include <time.h>
+#include <mutex>
+#include "cool-io.h"
+#include "stringtab.h"
+#include "parse-stats.h"
+
+thread_local Parse_Stats parse_stats;
+
+static Parse_Stats totals;      // of the threads that have finished
+static std::mutex totals_lock;
+
+static const char *phase_names[STATS_PHASES] = {
+  "other", "read", "scan", "parse", "build", "dump", "compile", "run",
+  "gc",
+};
+
+// As dump_with_types names them.
+static const char *kind_names[STATS_KINDS] = {
+  NULL, "program", "class_", "method", "attr", "formal", "branch",
+  "assign", "static_dispatch", "dispatch", "cond", "loop", "typcase",
+  "block", "let", "plus", "sub", "mul", "divide", "neg", "lt", "eq", "leq",
+  "comp", "int_const", "bool_const", "string_const", "new_", "isvoid",
+  "no_expr", "object",
+};
+
+static long long clock_ns(clockid_t c)
+{
+  struct timespec t;
+  clock_gettime(c, &t);
+  return t.tv_sec * 1000000000LL + t.tv_nsec;
+}
+
+void stats_switch(Stats_Phase p)
+{
+  Parse_Stats &s = parse_stats;
+  long long now = clock_ns(CLOCK_MONOTONIC);
+
+  if (s.since)                  // a new thread's stopwatch starts here
+    s.wall[s.phase] += now - s.since;
+  s.phase = p;
+  s.since = now;
+}
+
+void stats_begin(Stats_Phase p)
+{
+  Parse_Stats &s = parse_stats;
+  long long now = clock_ns(CLOCK_THREAD_CPUTIME_ID);
+
+  if (s.cpu_since)
+    s.cpu[s.cpu_phase] += now - s.cpu_since;
+  s.cpu_phase = p == PHASE_SCAN || p == PHASE_BUILD ? PHASE_PARSE : p;
+  s.cpu_since = now;
+  stats_switch(p);
+}
+
+// The counters of the parser, added to *to sign times.
+static void add_counts(Parse_Stats *to, const Parse_Stats *s, int sign)
+{
+  to->tokens += sign * s->tokens;
+  to->reductions += sign * s->reductions;
+  to->syntax_errors += sign * s->syntax_errors;
+  to->recoveries += sign * s->recoveries;
+  to->nodes += sign * s->nodes;
+  for (int i = 0; i < STATS_KINDS; i++)
+    to->kinds[i] += sign * s->kinds[i];
+}
+
+static void add_stats(Parse_Stats *to, const Parse_Stats *s)
+{
+  for (int i = 0; i < STATS_PHASES; i++) {
+    to->wall[i] += s->wall[i];
+    to->cpu[i] += s->cpu[i];
+  }
+  add_counts(to, s, 1);
+  to->vm_insns += s->vm_insns;
+  to->vm_calls += s->vm_calls;
+  to->vm_objects += s->vm_objects;
+  to->vm_cache_hits += s->vm_cache_hits;
+  to->vm_poly_hits += s->vm_poly_hits;
+  to->vm_cache_misses += s->vm_cache_misses;
+  to->vm_poly_sites += s->vm_poly_sites;
+  to->vm_mega_sites += s->vm_mega_sites;
+  to->vm_minor_gcs += s->vm_minor_gcs;
+  to->vm_major_gcs += s->vm_major_gcs;
+  to->vm_promoted += s->vm_promoted;
+}
+
+void counts_since(Parse_Stats *counts, const Parse_Stats *before)
+{
+  *counts = Parse_Stats();
+  add_counts(counts, &parse_stats, 1);
+  add_counts(counts, before, -1);
+}
+
+void discard_counts(const Parse_Stats *counts)
+{
+  add_counts(&parse_stats, counts, -1);
+}
+
+void add_thread_stats()
+{
+  STATS_BEGIN(PHASE_OTHER);     // stop the clocks
+  std::lock_guard<std::mutex> hold(totals_lock);
+  add_stats(&totals, &parse_stats);
+}
+
+template <class Elem> static int table_size(StringTable<Elem> &table)
+{
+  int n = 0;
+  for (int i = table.first(); table.more(i); i = table.next(i))
+    n++;
+  return n;
+}
+
+//
+// The time of each phase, in milliseconds.  The wall times are those of
+// the main thread, main, so they add up to the time the parser took;
+// with -j it waits in PARSE while the other threads parse.  The CPU
+// times are those of all the threads, s.  Only READ, PARSE, DUMP and
+// OTHER have CPU times of their own; PARSE's is shared out among SCAN,
+// PARSE and BUILD by the wall time all the threads spent in them.
+//
+static void phase_times(const Parse_Stats *s, const Parse_Stats *main,
+                        double wall[], double cpu[])
+{
+  double in_parse = s->wall[PHASE_SCAN] + s->wall[PHASE_PARSE] +
+                    s->wall[PHASE_BUILD];
+
+  for (int i = 0; i < STATS_PHASES; i++) {
+    wall[i] = main->wall[i] / 1e6;
+    cpu[i] = s->cpu[i] / 1e6;
+  }
+  for (int i = PHASE_SCAN; i <= PHASE_BUILD; i++)
+    cpu[i] = in_parse ? s->cpu[PHASE_PARSE] / 1e6 * s->wall[i] / in_parse : 0;
+}
+
+static void print_text(const Parse_Stats *s, const Parse_Stats *main)
+{
+  double wall[STATS_PHASES], cpu[STATS_PHASES];
+  double total_wall = 0, total_cpu = 0;
+  char line[128];
+
+  phase_times(s, main, wall, cpu);
+  cerr << "phase          wall ms      cpu ms\n";
+  for (int i = PHASE_READ; i <= STATS_PHASES; i++) {
+    int p = i % STATS_PHASES;   // other last
+    bool share = p >= PHASE_SCAN && p <= PHASE_BUILD;
+    snprintf(line, sizeof(line), "%-10s %11.3f %11.3f%s\n", phase_names[p],
+             wall[p], cpu[p], share ? " (share)" : "");
+    cerr << line;
+    total_wall += wall[p];
+    total_cpu += cpu[p];
+  }
+  snprintf(line, sizeof(line), "%-10s %11.3f %11.3f\n", "total",
+           total_wall, total_cpu);
+  cerr << line;
+
+  long long kinds = 0;
+  for (int i = 1; i < STATS_KINDS; i++)
+    kinds += s->kinds[i];
+  cerr << "tokens " << s->tokens << "\n"
+       << "reductions " << s->reductions << "\n"
+       << "syntax errors " << s->syntax_errors << "\n"
+       << "errors recovered " << s->recoveries << "\n"
+       << "nodes " << s->nodes << " (" << s->nodes - kinds << " in lists)\n";
+  for (int i = 1; i < STATS_KINDS; i++)
+    if (s->kinds[i])
+      cerr << "  " << kind_names[i] << " " << s->kinds[i] << "\n";
+  cerr << "idtable " << table_size(idtable) << "\n"
+       << "inttable " << table_size(inttable) << "\n"
+       << "stringtable " << table_size(stringtable) << endl;
+  if (s->vm_insns)              // a program was run
+    cerr << "instructions " << s->vm_insns << "\n"
+         << "calls " << s->vm_calls << "\n"
+         << "objects " << s->vm_objects << "\n"
+         << "dispatch cache hits " << s->vm_cache_hits << " monomorphic, "
+         << s->vm_poly_hits << " polymorphic\n"
+         << "dispatch cache misses " << s->vm_cache_misses << "\n"
+         << "polymorphic sites " << s->vm_poly_sites
+         << " (megamorphic " << s->vm_mega_sites << ")\n"
+         << "collections " << s->vm_minor_gcs << " minor, "
+         << s->vm_major_gcs << " major\n"
+         << "bytes promoted " << s->vm_promoted << endl;
+}
+
+static void print_json(const Parse_Stats *s, const Parse_Stats *main,
+                       FILE *f)
+{
+  double wall[STATS_PHASES], cpu[STATS_PHASES];
+
+  phase_times(s, main, wall, cpu);
+  fprintf(f, "{\n  \"phases\": {\n");
+  for (int i = PHASE_READ; i <= STATS_PHASES; i++) {
+    int p = i % STATS_PHASES;
+    fprintf(f, "    \"%s\": { \"wall_ms\": %.3f, \"cpu_ms\": %.3f }%s\n",
+            phase_names[p], wall[p], cpu[p], i < STATS_PHASES ? "," : "");
+  }
+  fprintf(f, "  },\n  \"tokens\": %lld,\n  \"reductions\": %lld,\n"
+          "  \"syntax_errors\": %lld,\n  \"errors_recovered\": %lld,\n"
+          "  \"nodes\": %lld,\n  \"nodes_by_kind\": {",
+          s->tokens, s->reductions, s->syntax_errors, s->recoveries,
+          s->nodes);
+  for (int i = 1; i < STATS_KINDS; i++)
+    fprintf(f, "%s\n    \"%s\": %lld", i > 1 ? "," : "", kind_names[i],
+            s->kinds[i]);
+  fprintf(f, "\n  },\n  \"string_tables\": { \"idtable\": %d, "
+          "\"inttable\": %d, \"stringtable\": %d }",
+          table_size(idtable), table_size(inttable), table_size(stringtable));
+  if (s->vm_insns)
+    fprintf(f, ",\n  \"run\": { \"instructions\": %lld, \"calls\": %lld, "
+            "\"objects\": %lld,\n    \"cache_hits\": %lld, \"poly_hits\": %lld, "
+            "\"cache_misses\": %lld,\n    \"poly_sites\": %lld, "
+            "\"mega_sites\": %lld,\n    \"minor_gcs\": %lld, "
+            "\"major_gcs\": %lld, \"promoted_bytes\": %lld }",
+            s->vm_insns, s->vm_calls, s->vm_objects,
+            s->vm_cache_hits, s->vm_poly_hits, s->vm_cache_misses,
+            s->vm_poly_sites, s->vm_mega_sites, s->vm_minor_gcs,
+            s->vm_major_gcs, s->vm_promoted);
+  fprintf(f, "\n}\n");
+}
+
+void report_parse_stats()
+{
+  Parse_Stats all = Parse_Stats();
+
+  STATS_BEGIN(PHASE_OTHER);
+  {
+    std::lock_guard<std::mutex> hold(totals_lock);
+    add_stats(&all, &totals);
+  }
+  add_stats(&all, &parse_stats);
+
+  if (stats_file == NULL) {
+    print_text(&all, &parse_stats);
+    return;
+  }
+  FILE *f = fopen(stats_file, "w");
+  if (f == NULL) {
+    cerr << "Could not open " << stats_file << endl;
+    return;
+  }
+  print_json(&all, &parse_stats, f);
+  fclose(f);
+}
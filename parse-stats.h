@@ -0,0 +1,94 @@
+#ifndef PARSE_STATS_H
+#define PARSE_STATS_H
+
+//
+// parse-stats.h
+//
+//  Where the parser's time goes (-P, or --stats-file for JSON).  Each
+//  thread keeps a stopwatch that is moved from phase to phase as the
+//  work moves between reading input, scanning tokens, the parser's
+//  automaton, the grammar actions that build the tree, and dumping it,
+//  and counts what was done.  report_parse_stats() adds up the threads'
+//  counts and CPU times; the wall times it reports are the main
+//  thread's, which add up to the time taken.
+//
+//  The stopwatch reads the monotonic clock at every token and reduction,
+//  so it only runs with -P.  CPU time costs a system call to read, so it
+//  is taken only when the coarse phases change (input, parse, dump); the
+//  CPU time of scan, parse and build is the parse's, shared out in
+//  proportion to their wall time.
+//
+//  The counters are kept always; they cost an increment each.
+//
+
+#include "handle_flags.h"
+#include "ast-binary.h"
+
+enum Stats_Phase {
+  PHASE_OTHER,                  // none of the below
+  PHASE_READ,                   // loading input files
+  PHASE_SCAN,                   // in the scanner
+  PHASE_PARSE,                  // in the parser proper
+  PHASE_BUILD,                  // in the grammar actions, making nodes
+  PHASE_DUMP,                   // writing the tree out
+  PHASE_COMPILE,                // -run: compiling it to bytecode (-native: to x86-64)
+  PHASE_RUN,                    //   and running that
+  PHASE_GC,                     //   and collecting its garbage
+  STATS_PHASES
+};
+
+#define STATS_KINDS (AST_OBJECT + 1)    // indexed by Ast_Kind
+
+struct Parse_Stats {
+  Stats_Phase phase;            // where the stopwatch is
+  long long since;              //   and when it got there, in ns
+  Stats_Phase cpu_phase;        // where CPU time is charged: READ, PARSE
+  long long cpu_since;          //   (covering SCAN and BUILD), DUMP, OTHER
+  long long wall[STATS_PHASES];
+  long long cpu[STATS_PHASES];
+
+  long long tokens;             // scanned or read from a token stream
+  long long reductions;
+  long long syntax_errors;
+  long long recoveries;         // errors recovered from by an error rule
+  long long nodes;              // allocated, list nodes included
+  long long kinds[STATS_KINDS]; // nodes made, by kind
+
+  long long vm_insns;           // -run: instructions executed
+  long long vm_calls;           //   methods called, built-in ones too
+  long long vm_objects;         //   objects allocated
+  long long vm_cache_hits;      //   dispatches found in the monomorphic
+  long long vm_poly_hits;       //   or a polymorphic inline cache entry
+  long long vm_cache_misses;    //   or looked up
+  long long vm_poly_sites;      //   sites that saw more than one class
+  long long vm_mega_sites;      //   and more than the cache holds
+  long long vm_minor_gcs;       //   collections of the nursery
+  long long vm_major_gcs;       //   and of the whole heap
+  long long vm_promoted;        //   bytes copied to the old generation
+};
+
+extern thread_local Parse_Stats parse_stats;
+
+void stats_switch(Stats_Phase p);       // move the stopwatch to p
+void stats_begin(Stats_Phase p);        // ... and charge CPU time to p
+
+#define STATS_PHASE(p) do { if (report_stats) stats_switch(p); } while (0)
+#define STATS_BEGIN(p) do { if (report_stats) stats_begin(p); } while (0)
+#define COUNT_NODE(kind) (parse_stats.kinds[kind]++)
+
+// For a parse whose tree may be thrown away and the work done again:
+// counts_since leaves in *counts what the parser has counted on this
+// thread since parse_stats was copied to *before, and discard_counts
+// takes such counts back off this thread's.  The times are kept, as the
+// time was spent.
+void counts_since(Parse_Stats *counts, const Parse_Stats *before);
+void discard_counts(const Parse_Stats *counts);
+
+// Add the counts of this thread to the totals; each parsing thread but
+// the main one calls this when it is done.
+void add_thread_stats();
+
+// Print the totals on cerr, or as JSON to --stats-file.
+void report_parse_stats();
+
+#endif
@@ -0,0 +1,159 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//////////////////////////////////////////////////////////////////////////
+//
+//  parser-phase.cc
+//
+//  Reads a COOL program from the given files (or standard input) and
+//  prints its abstract syntax tree, as text or (-B) in binary, or (-run)
+//  executes it, or (-native) compiles it to x86-64 assembly.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sstream>
+#include "cool-io.h"
+#include "cool-tree.h"
+#include "utilities.h"
+#include "handle_flags.h"
+#include "token-stream.h"
+#include "ast-binary.h"
+#include "dump-buffer.h"
+#include "cool-lex.h"
+#include "parse-stats.h"
+#include "vm.h"
+#include "x86-cgen.h"
+
+FILE *fin;
+FILE *ast_file = stdin;
+char *curr_filename = "<stdin>";  // until handle_files opens a file
+
+Program ast_root;          // root of the abstract syntax tree
+Program handle_files(int argc, const char *argv[]);
+void stream_files(int argc, const char *argv[], Class_Sink *sink);
+
+//
+// --stream: each class is written out as soon as it is parsed, as text or
+// (-B) as a record of its own.  emit is called from a grammar action.
+//
+struct Dump_Sink : Class_Sink {
+  Dump_Buffer out;
+  Dump_Sink() : out(STDOUT_FILENO) { }
+  void start(int line) { dump_program_header(out, 0, line); }
+  void emit(Class_ c) {
+    STATS_BEGIN(PHASE_DUMP);
+    c->dump_with_types(out, 2);
+    STATS_BEGIN(PHASE_BUILD);
+  }
+  void flush() { out.flush(); }
+};
+
+struct Ast_Sink : Class_Sink {
+  void start(int line) {
+    node_lineno = line;
+    write_ast_file(program(nil_Classes()), stdout);
+  }
+  void emit(Class_ c) {
+    std::string record;
+    STATS_BEGIN(PHASE_DUMP);
+    write_ast(single_Classes(c), &record);
+    if (fwrite(record.data(), 1, record.size(), stdout) != record.size()) {
+      cerr << "Could not write the tree" << endl;
+      exit(1);
+    }
+    STATS_BEGIN(PHASE_BUILD);
+  }
+};
+
+//
+// -native: the assembly, which x86_cgen has made whole before any of it
+// is written, goes to -o out_filename by way of a temporary file that
+// is renamed into place, so a failed run leaves no part of a file
+// behind for make to take as up to date.  What is not a regular file,
+// such as a pipe, is written directly.
+//
+static void write_native(const std::string &code)
+{
+  struct stat st;
+  const char *name = out_filename ? out_filename : "the assembly";
+  std::string temp;
+  FILE *f = stdout;
+
+  if (out_filename) {
+    if (stat(out_filename, &st) == 0 && !S_ISREG(st.st_mode))
+      f = fopen(out_filename, "w");
+    else {
+      temp = std::string(out_filename) + ".tmp";
+      f = fopen(temp.c_str(), "w");
+    }
+  }
+  bool ok = f != NULL && fwrite(code.data(), 1, code.size(), f) == code.size();
+  if (f != NULL && fclose(f) != 0)
+    ok = false;
+  if (ok && !temp.empty() && rename(temp.c_str(), out_filename) != 0)
+    ok = false;
+  if (!ok) {
+    if (!temp.empty())
+      unlink(temp.c_str());
+    cerr << "Could not write " << name << endl;
+    exit(1);
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  handle_flags(argc, (const char **) argv);
+  if (report_stats) {           // also when exiting on errors
+    stats_begin(PHASE_OTHER);
+    atexit(report_parse_stats);
+  }
+  if (emit_tokens) {
+    STATS_BEGIN(PHASE_SCAN);
+    emit_token_stream(argc, (const char **) argv, stdout);
+    return 0;
+  }
+  if (stream_classes) {
+    Class_Sink *sink = emit_ast ? (Class_Sink *) new Ast_Sink
+                                : (Class_Sink *) new Dump_Sink;
+    stream_files(argc, (const char **) argv, sink);
+    STATS_BEGIN(PHASE_DUMP);
+    delete sink;
+    fflush(stdout);
+    return 0;
+  }
+  if (read_ast_input) {
+    STATS_BEGIN(PHASE_BUILD);
+    ast_root = read_ast_file(ast_file, "<stdin>");
+    STATS_BEGIN(PHASE_OTHER);
+  }
+  else
+    ast_root = handle_files(argc, (const char **) argv);
+  if (run_program)
+    return vm_run(ast_root);
+  if (native_code) {
+    std::ostringstream code;
+    STATS_BEGIN(PHASE_COMPILE);
+    x86_cgen(ast_root, code);
+    STATS_BEGIN(PHASE_DUMP);
+    write_native(code.str());
+    STATS_BEGIN(PHASE_OTHER);
+    return 0;
+  }
+  STATS_BEGIN(PHASE_DUMP);
+  if (emit_ast)
+    write_ast_file(ast_root, stdout);
+  else {
+    Dump_Buffer out(STDOUT_FILENO);
+    ast_root->dump_with_types(out, 0);
+  }
+  STATS_BEGIN(PHASE_OTHER);
+  release_tree_nodes();
+  return 0;
+}
@@ -0,0 +1,206 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//
+// rep.cc
+//
+//  Works out how each expression's value is held; see rep.h.
+//
+
+#include "cool-tree.h"
+#include "stringtab.h"
+#include "rep.h"
+
+Vm_Rep type_rep(Symbol type)
+{
+  static Symbol Int = idtable.add_string("Int");
+  static Symbol Bool = idtable.add_string("Bool");
+
+  if (type == Int)
+    return REP_INT;
+  if (type == Bool)
+    return REP_BOOL;
+  return REP_BOXED;
+}
+
+//
+// How e's value is held.  It depends only on e and the variables in
+// scope, so it is worked out once for each node.
+//
+Vm_Rep Rep_Analysis::rep(Expression e)
+{
+  std::unordered_map<Expression, Vm_Rep>::iterator i = reps.find(e);
+  if (i != reps.end())
+    return i->second;
+  enter(e);
+  Vm_Rep r = e->rep(*this);
+  leave();
+  reps[e] = r;
+  return r;
+}
+
+//
+// A method with these declared reps: where they differ from those of
+// another of the same signature, the value is passed boxed.
+//
+void Rep_Analysis::declare(Symbol name, const std::vector<Vm_Rep> &args, Vm_Rep ret)
+{
+  std::pair<Symbol, int> key(name, args.size());
+  std::map<std::pair<Symbol, int>, Signature>::iterator i = signatures.find(key);
+  if (i == signatures.end()) {
+    Signature sig = { args, ret };
+    signatures[key] = sig;
+    return;
+  }
+  for (size_t j = 0; j < args.size(); j++)
+    if (i->second.args[j] != args[j])
+      i->second.args[j] = REP_BOXED;
+  if (i->second.ret != ret)
+    i->second.ret = REP_BOXED;
+}
+
+// How a call of name with args arguments passes them; NULL if no method
+// could take it.
+const Rep_Analysis::Signature *Rep_Analysis::signature(Symbol name, int args)
+{
+  std::map<std::pair<Symbol, int>, Signature>::iterator i =
+    signatures.find(std::make_pair(name, args));
+  return i == signatures.end() ? NULL : &i->second;
+}
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  Expressions
+//
+/////////////////////////////////////////////////////////////////////////
+
+Vm_Rep assign_class::rep(Rep_Analysis &c)
+{
+  return c.local_rep(name);
+}
+
+// As its signature says.
+Vm_Rep static_dispatch_class::rep(Rep_Analysis &c)
+{
+  const Rep_Analysis::Signature *sig = c.signature(name, actual->len());
+  return sig ? sig->ret : REP_BOXED;
+}
+
+Vm_Rep dispatch_class::rep(Rep_Analysis &c)
+{
+  const Rep_Analysis::Signature *sig = c.signature(name, actual->len());
+  return sig ? sig->ret : REP_BOXED;
+}
+
+// Unboxed if both branches are, and the same.
+Vm_Rep cond_class::rep(Rep_Analysis &c)
+{
+  Vm_Rep then_rep = c.rep(then_exp);
+  return c.rep(else_exp) == then_rep ? then_rep : REP_BOXED;
+}
+
+Vm_Rep loop_class::rep(Rep_Analysis &c)
+{
+  return REP_BOXED;
+}
+
+Vm_Rep typcase_class::rep(Rep_Analysis &c)
+{
+  return REP_BOXED;
+}
+
+Vm_Rep block_class::rep(Rep_Analysis &c)
+{
+  return c.rep(body->nth(body->len() - 1));
+}
+
+Vm_Rep let_class::rep(Rep_Analysis &c)
+{
+  c.bind_rep(identifier, type_rep(type_decl));
+  Vm_Rep r = c.rep(body);
+  c.unbind();
+  return r;
+}
+
+Vm_Rep plus_class::rep(Rep_Analysis &c)
+{
+  return REP_INT;
+}
+
+Vm_Rep sub_class::rep(Rep_Analysis &c)
+{
+  return REP_INT;
+}
+
+Vm_Rep mul_class::rep(Rep_Analysis &c)
+{
+  return REP_INT;
+}
+
+Vm_Rep divide_class::rep(Rep_Analysis &c)
+{
+  return REP_INT;
+}
+
+Vm_Rep lt_class::rep(Rep_Analysis &c)
+{
+  return REP_BOOL;
+}
+
+Vm_Rep eq_class::rep(Rep_Analysis &c)
+{
+  return REP_BOOL;
+}
+
+Vm_Rep leq_class::rep(Rep_Analysis &c)
+{
+  return REP_BOOL;
+}
+
+Vm_Rep neg_class::rep(Rep_Analysis &c)
+{
+  return REP_INT;
+}
+
+Vm_Rep comp_class::rep(Rep_Analysis &c)
+{
+  return REP_BOOL;
+}
+
+Vm_Rep isvoid_class::rep(Rep_Analysis &c)
+{
+  return REP_BOOL;
+}
+
+Vm_Rep int_const_class::rep(Rep_Analysis &c)
+{
+  return REP_INT;
+}
+
+Vm_Rep bool_const_class::rep(Rep_Analysis &c)
+{
+  return REP_BOOL;
+}
+
+Vm_Rep string_const_class::rep(Rep_Analysis &c)
+{
+  return REP_BOXED;
+}
+
+Vm_Rep new__class::rep(Rep_Analysis &c)
+{
+  return REP_BOXED;
+}
+
+Vm_Rep no_expr_class::rep(Rep_Analysis &c)
+{
+  return REP_BOXED;
+}
+
+Vm_Rep object_class::rep(Rep_Analysis &c)
+{
+  return c.local_rep(name);
+}
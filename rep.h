@@ -0,0 +1,66 @@
+#ifndef REP_H
+#define REP_H
+
+//
+// rep.h
+//
+//  How the value of each expression is held, worked out from the tree
+//  for both -run (vm-compile.cc) and -native (x86-cgen.cc): as an
+//  object, or as an unboxed Int or Bool.  With no type checker to say
+//  so, an expression is unboxed if it is a constant, an arithmetic
+//  operation or a comparison, a variable or attribute declared Int or
+//  Bool, a call whose result is passed unboxed, or an if, block, let or
+//  assignment whose value is one of those; anything else, such as a new
+//  or a case, is an object.
+//
+//  How the arguments and the result of a call are passed is decided for
+//  each method name and number of arguments, its signature: unboxed if
+//  every method with that name and number of arguments declares it Int,
+//  or every one Bool, as a call may reach any of them.  The built-in
+//  methods take and return objects.
+//
+//  A compiler derives from Rep_Analysis and says how the variables in
+//  its scope are held.
+//
+
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include "cool-tree.h"
+
+// How a value is held: as an object, or as an unboxed Int or Bool.
+enum Vm_Rep : int { REP_BOXED, REP_INT, REP_BOOL };
+
+// How a value of the given declared type is held.
+Vm_Rep type_rep(Symbol type);
+
+class Rep_Analysis {
+  std::unordered_map<Expression, Vm_Rep> reps;
+
+public:
+  struct Signature {
+    std::vector<Vm_Rep> args;
+    Vm_Rep ret;
+  };
+
+private:
+  std::map<std::pair<Symbol, int>, Signature> signatures;
+
+public:
+  virtual ~Rep_Analysis() {}
+
+  Vm_Rep rep(Expression e);
+  void declare(Symbol name, const std::vector<Vm_Rep> &args, Vm_Rep ret);
+  const Signature *signature(Symbol name, int args);
+
+  // How a variable in scope, or else an attribute, is held.
+  virtual Vm_Rep local_rep(Symbol name) = 0;
+  // A let variable, in scope while its body is looked at.
+  virtual void bind_rep(Symbol name, Vm_Rep rep) = 0;
+  virtual void unbind() = 0;
+  // Going into and out of e, which stops at too deep a nesting.
+  virtual void enter(Expression e) = 0;
+  virtual void leave() = 0;
+};
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef SHA256_H
+#define SHA256_H
+
+//
+// sha256.h
+//
+//  SHA-256 (FIPS 180-4), for naming the entries of the AST cache by the
+//  contents of the source they came from.
+//
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHA256_SIZE 32
+
+struct Sha256 {
+  uint32_t h[8];
+  uint64_t len;                 // bytes hashed so far
+  unsigned char block[64];      // the partial block
+};
+
+void sha256_init(Sha256 *s);
+void sha256_update(Sha256 *s, const void *data, size_t len);
+void sha256_final(Sha256 *s, unsigned char digest[SHA256_SIZE]);
+
+#endif
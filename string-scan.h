@@ -0,0 +1,87 @@
+#ifndef STRING_SCAN_H
+#define STRING_SCAN_H
+
+//
+// string-scan.h
+//
+//  Runs of ordinary characters in string constants, found 16 bytes at a
+//  time with SSE2, so that the loops that decode and escape string
+//  constants copy such runs in bulk and look at characters one at a time
+//  only where something has to be done.
+//
+//    string_run     the length of the run at s of characters other than
+//                   '"', '\\', '\n' and '\0', which end or escape
+//                   something in a string constant being scanned.
+//    printable_run  the length of the run at s of printable characters
+//                   other than '"' and '\\', which print_escaped_string
+//                   writes as they are.
+//
+//  Neither reads at or beyond end.
+//
+
+#include <stddef.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static inline bool string_plain(char c)
+{
+  return c != '"' && c != '\\' && c != '\n' && c != '\0';
+}
+
+static inline bool string_printable(char c)
+{
+  return c >= ' ' && c < 0177 && c != '"' && c != '\\';
+}
+
+static inline size_t string_run(const char *s, const char *end)
+{
+  const char *p = s;
+
+#if defined(__SSE2__)
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i newline = _mm_set1_epi8('\n');
+  const __m128i nul = _mm_setzero_si128();
+  for (; end - p >= 16; p += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *) p);
+    __m128i stop = _mm_or_si128(
+      _mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+      _mm_or_si128(_mm_cmpeq_epi8(v, newline), _mm_cmpeq_epi8(v, nul)));
+    unsigned mask = _mm_movemask_epi8(stop);
+    if (mask)
+      return p - s + __builtin_ctz(mask);
+  }
+#endif
+  while (p < end && string_plain(*p))
+    p++;
+  return p - s;
+}
+
+static inline size_t printable_run(const char *s, const char *end)
+{
+  const char *p = s;
+
+  // As signed bytes, the printable characters are those > 037 and
+  // < 0177; the bytes from 0200 up are negative.
+#if defined(__SSE2__)
+  const __m128i low = _mm_set1_epi8(037);
+  const __m128i del = _mm_set1_epi8(0177);
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  for (; end - p >= 16; p += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *) p);
+    __m128i ok = _mm_and_si128(_mm_cmpgt_epi8(v, low), _mm_cmplt_epi8(v, del));
+    __m128i special = _mm_or_si128(_mm_cmpeq_epi8(v, quote),
+                                   _mm_cmpeq_epi8(v, backslash));
+    unsigned mask = ~_mm_movemask_epi8(_mm_andnot_si128(special, ok)) & 0xffff;
+    if (mask)
+      return p - s + __builtin_ctz(mask);
+  }
+#endif
+  while (p < end && string_printable(*p))
+    p++;
+  return p - s;
+}
+
+#endif
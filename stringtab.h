@@ -0,0 +1,165 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#ifndef _STRINGTAB_H_
+#define _STRINGTAB_H_
+
+#include <assert.h>
+#include <string.h>
+#include <mutex>
+#include "list.h" // list template
+#include "cool-io.h"
+
+class Entry;
+typedef Entry* Symbol;
+
+extern ostream& operator<<(ostream& s, const Entry& sym);
+extern ostream& operator<<(ostream& s, Symbol sym);
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  String Table Entries
+//
+/////////////////////////////////////////////////////////////////////////
+
+class Entry {
+protected:
+  char *str;     // the string
+  int  len;      // the length of the string (without trailing \0)
+  int index;     // a unique index for each string
+  unsigned hash; // hash_string(str, len), cached for the string tables
+public:
+  Entry(const char *s, int l, int i);
+
+  // is string argument equal to the str of this Entry?
+  int equal_string(const char *s, int len) const;  
+
+  // the same test, rejecting most mismatches on the cached hash
+  bool equal_string(const char *s, int l, unsigned h) const
+    { return h == hash && l == len && memcmp(s, str, l) == 0; }
+                         
+  // is the integer argument equal to the index of this Entry?
+  bool equal_index(int ind) const           { return ind == index; }
+
+  ostream& print(ostream& s) const;
+
+  // Return the str and len components of the Entry.
+  const char *get_string() const;
+  int get_len() const;
+  unsigned get_hash() const                 { return hash; }
+};
+
+// The hash of the first len characters of s.
+unsigned hash_string(const char *s, int len);
+
+//
+// There are three kinds of string table entries:
+//   a true string, an string representation of an identifier, and 
+//   a string representation of an integer.
+//
+// Having separate tables is convenient for code generation.  Different
+// data definitions are generated for string constants (StringEntry) and 
+// integer  constants (IntEntry).  Identifiers (IdEntry) don't produce
+// static data definitions.
+//
+// code_def and code_ref are used by the code to produce definitions and
+// references (respectively) to constants.  
+//
+class StringEntry : public Entry {
+public:
+  void code_def(ostream& str, int stringclasstag);
+  void code_ref(ostream& str);
+  StringEntry(const char *s, int l, int);
+};
+
+class IdEntry : public Entry {
+public:
+  IdEntry(const char *s, int l, int);
+};
+
+class IntEntry: public Entry {
+public:
+  void code_def(ostream& str, int intclasstag);
+  void code_ref(ostream& str);
+  IntEntry(const char *s, int l, int);
+};
+
+typedef StringEntry *StringEntryP;
+typedef IdEntry *IdEntryP;
+typedef IntEntry *IntEntryP;
+
+//////////////////////////////////////////////////////////////////////////
+//
+//  String Tables
+//
+//  A string table is an open-addressing hash table of its entries, keyed
+//  on the hash cached in each Entry, plus an array of the entries in
+//  index order for lookup(int) and the iterator.
+//
+//  The tables are shared by every parse in the process, so adding and
+//  looking up strings is serialized by a lock.  The iterator and print()
+//  are not locked; use them once the parsing is done.
+//
+//////////////////////////////////////////////////////////////////////////
+
+template <class Elem> 
+class StringTable
+{
+protected:
+   Elem **slots;      // hash table; NULL marks an empty slot
+   int nslots;        // a power of two, at least twice index
+   Elem **elems;      // the entries by index
+   int nelems;        // room in elems
+   int index;         // the current index
+   std::mutex lock;   // held by add_string and the lookups
+
+   void grow();
+public:
+   StringTable(): slots(NULL), nslots(0), elems(NULL), nelems(0), index(0) { }   // an empty table
+   // The following methods each add a string to the string table.  
+   // Only one copy of each string is maintained.  
+   // Returns a pointer to the string table entry with the string.
+
+   // add the prefix of s of length maxchars
+   Elem *add_string(const char *s, int maxchars);
+
+   // add the (null terminated) string s
+   Elem *add_string(const char *s);
+
+   // add the string representation of an integer
+   Elem *add_int(int i);
+
+
+   // An iterator.
+   int first();       // first index
+   int more(int i);   // are there more indices?
+   int next(int i);   // next index
+
+   Elem *lookup(int index);      // lookup an element using its index
+   Elem *lookup_string(const char *s); // lookup an element using its string
+
+   void print();  // print the entire table; for debugging
+
+};
+
+class IdTable : public StringTable<IdEntry> { };
+
+class StrTable : public StringTable<StringEntry>
+{
+public: 
+   void code_string_table(ostream&, int classtag);
+};
+
+class IntTable : public StringTable<IntEntry>
+{
+public:
+   void code_string_table(ostream&, int classtag);
+};
+
+extern IdTable idtable;
+extern IntTable inttable;
+extern StrTable stringtable;
+#endif
@@ -0,0 +1,142 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#include "cool-io.h"
+#include "stringtab.h"
+#include <stdio.h>
+
+#define MAXSIZE 1000000
+
+template <class Elem>
+Elem *StringTable<Elem>::add_string(const char *s)
+{
+ return add_string(s,MAXSIZE);
+}
+
+//
+// Double the hash table (and the index array, if it is full) and rehash.
+// The hashes are cached in the entries, so no strings are read.
+//
+template <class Elem>
+void StringTable<Elem>::grow()
+{
+  int n = nslots ? 2 * nslots : 64;
+  Elem **t = new Elem *[n];
+  for (int i = 0; i < n; i++)
+    t[i] = NULL;
+
+  for (int i = 0; i < index; i++) {
+    unsigned h = elems[i]->get_hash() & (n - 1);
+    while (t[h])
+      h = (h + 1) & (n - 1);
+    t[h] = elems[i];
+  }
+  delete [] slots;
+  slots = t;
+  nslots = n;
+
+  if (nelems < n / 2) {
+    Elem **e = new Elem *[n / 2];
+    for (int i = 0; i < index; i++)
+      e[i] = elems[i];
+    delete [] elems;
+    elems = e;
+    nelems = n / 2;
+  }
+}
+
+template <class Elem>
+Elem *StringTable<Elem>::add_string(const char *s, int maxchars)
+{
+  int len = strlen(s);
+  if (len > maxchars)
+    len = maxchars;
+  unsigned hash = hash_string(s,len);
+  std::lock_guard<std::mutex> hold(lock);
+
+  if (2 * (index + 1) > nslots)
+    grow();
+
+  unsigned h = hash & (nslots - 1);
+  for (; slots[h]; h = (h + 1) & (nslots - 1))
+    if (slots[h]->equal_string(s,len,hash))
+      return slots[h];
+
+  Elem *e = new Elem(s,len,index);
+  slots[h] = e;
+  elems[index++] = e;
+  return e;
+}
+
+template <class Elem>
+Elem *StringTable<Elem>::lookup(int ind)
+{
+  std::lock_guard<std::mutex> hold(lock);
+  assert(ind >= 0 && ind < index);   // fail if ind not in table
+  return elems[ind];
+}
+
+template <class Elem>
+Elem *StringTable<Elem>::lookup_string(const char *s)
+{
+  int len = strlen(s);
+  unsigned hash = hash_string(s,len);
+  std::lock_guard<std::mutex> hold(lock);
+
+  if (nslots)
+    for (unsigned h = hash & (nslots - 1); slots[h]; h = (h + 1) & (nslots - 1))
+      if (slots[h]->equal_string(s,len,hash))
+	return slots[h];
+  assert(0);   // fail if string not in table
+  return NULL;
+}
+
+template <class Elem>
+Elem *StringTable<Elem>::add_int(int i)
+{
+  char buf[20];
+  snprintf(buf, sizeof(buf), "%d", i);
+  return add_string(buf);
+}
+
+template <class Elem>
+int StringTable<Elem>::first()
+{
+  return 0;
+}
+
+template <class Elem>
+int StringTable<Elem>::more(int i)
+{
+  return i < index;
+}
+
+template <class Elem>
+int StringTable<Elem>::next(int i)
+{
+  assert(i < index);
+  return i+1;
+}
+
+//
+// Prints the entries newest first, as the list-based table did.
+//
+template <class Elem>
+void StringTable<Elem>::print()
+{
+  cerr << "[\n";
+  for (int i = index - 1; i >= 0; i--)
+    cerr << *elems[i] << " ";
+  cerr << "]\n";
+}
+
+//
+// Explicit template instantiations.
+// Comment out for versions of g++ prior to 2.7
+//
+template class StringTable<IdEntry>;
+template class StringTable<StringEntry>;
+template class StringTable<IntEntry>;
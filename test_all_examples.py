@@ -23,7 +23,7 @@ def run_pipeline(file_path, parser_cmd):
 
 def compare_outputs(file_path):
     ref_out, ref_err = run_pipeline(file_path, [REFERENCE_PARSER])
-    custom_out, custom_err = run_pipeline(file_path, [CUSTOM_PARSER])
+    custom_out, custom_err = run_pipeline(file_path, [CUSTOM_PARSER, "-k"])
 
     # Normalize lines to ignore line numbers
     ref_out = [normalize_line(line) for line in ref_out]
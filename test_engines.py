@@ -0,0 +1,76 @@
+#!/usr/bin/env python3
+
+# Parses expressions nested DEPTH deep (200000 by default), one program for
+# each form of nesting, with --engine bison and with --engine descent, and
+# checks that both parse it and write the same tree and messages.
+#
+#   python3 test_engines.py [DEPTH]
+
+import os
+import subprocess
+import sys
+import tempfile
+
+CUSTOM_PARSER = "./parser"
+ENGINES = ["bison", "descent"]
+
+# Each form is (before, innermost, after): the program nests before and
+# after around innermost n times.
+FORMS = {
+    "paren":    ("(", "1", ")"),
+    "neg":      ("~", "1", ""),
+    "not":      ("not ", "true", ""),
+    "isvoid":   ("isvoid ", "1", ""),
+    "if":       ("if ", "true", " then 1 else 2 fi"),
+    "while":    ("while ", "true", " loop 0 pool"),
+    "block":    ("{ ", "1", "; }"),
+    "assign":   ("x <- ", "1", ""),
+    "dispatch": ("f(", "1", ")"),
+    "case":     ("case ", "x", " of y : Int => 1; esac"),
+    "let":      ("let y : Int <- ", "1", " in y"),
+}
+
+def program(form, n):
+    before, innermost, after = FORMS[form]
+    return ("class Main {\n  x : Int;\n  f(y : Int) : Int { y };\n"
+            "  main() : Object {\n    " + before * n + innermost + after * n +
+            "\n  };\n};\n")
+
+def check(form, n, tmp):
+    path = os.path.join(tmp, form + ".cl")
+    with open(path, "w") as f:
+        f.write(program(form, n))
+    results = {}
+    for engine in ENGINES:
+        results[engine] = subprocess.run(
+            [CUSTOM_PARSER, "--engine", engine, path], capture_output=True)
+    bison, descent = results["bison"], results["descent"]
+
+    if bison.returncode != 0:
+        print(f"❌ {form} ({n} deep): bison exited with status "
+              f"{bison.returncode}\n{bison.stderr.decode()}")
+        return False
+    if (bison.stdout, bison.stderr, bison.returncode) != \
+       (descent.stdout, descent.stderr, descent.returncode):
+        print(f"❌ {form} ({n} deep): the engines differ")
+        print(f"descent exited with status {descent.returncode}\n"
+              f"{descent.stderr.decode()}")
+        return False
+
+    print(f"✅ {form} ({n} deep) passed.")
+    return True
+
+def main():
+    n = int(sys.argv[1]) if len(sys.argv) > 1 else 200000
+    with tempfile.TemporaryDirectory() as tmp:
+        failed = [form for form in FORMS if not check(form, n, tmp)]
+
+    print("=== Test Summary ===")
+    if failed:
+        print(f"{len(failed)} form(s) failed: " + " ".join(failed))
+        sys.exit(1)
+    else:
+        print("Both engines agree on every form! ✅")
+
+if __name__ == "__main__":
+    main()
@@ -20,7 +20,7 @@ def run_pipeline(file_name, parser_cmd):
 def compare_outputs(file_name):
     print(f"Testing file: {file_name}")
     ref_out, ref_err = run_pipeline(file_name, [REFERENCE_PARSER])
-    custom_out, custom_err = run_pipeline(file_name, [CUSTOM_PARSER])
+    custom_out, custom_err = run_pipeline(file_name, [CUSTOM_PARSER, "-k"])
 
     # Compare stdout line by line
     for i, (ref_line, custom_line) in enumerate(zip(ref_out, custom_out), start=1):
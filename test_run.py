@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+
+# Runs the programs of tests/ under -run and as -native executables, each
+# also with its collector stressed (-t -T, COOL_GC_TEST), and compares
+# what each writes with tests/<name>.out, and with tests/<name>.err if
+# the program is meant to stop with an error.
+
+import subprocess
+import os
+import sys
+import tempfile
+
+CUSTOM_PARSER = "./parser"
+RUNTIME = "./x86-runtime.c"
+TESTS_DIR = "tests"
+MODES = ["-run", "-run -t -T", "-native", "-native COOL_GC_TEST"]
+
+def read(path):
+    if not os.path.exists(path):
+        return ""
+    with open(path) as f:
+        return f.read()
+
+def run_program(file_path, mode, tmp):
+    env = dict(os.environ)
+    if not mode.startswith("-native"):
+        cmd = [CUSTOM_PARSER] + mode.split() + [file_path]
+    else:
+        asm = os.path.join(tmp, "prog.s")
+        exe = os.path.join(tmp, "prog")
+        build = subprocess.run([CUSTOM_PARSER, "-native", "-o", asm, file_path],
+                               capture_output=True, text=True)
+        if build.returncode != 0:
+            return None, build.stderr, build.returncode
+        link = subprocess.run(["gcc", "-O2", asm, RUNTIME, "-o", exe],
+                              capture_output=True, text=True)
+        if link.returncode != 0:
+            return None, link.stderr, link.returncode
+        cmd = [exe]
+        if "COOL_GC_TEST" in mode:
+            env["COOL_GC_TEST"] = "1"
+    result = subprocess.run(cmd, capture_output=True, text=True, env=env)
+    return result.stdout, result.stderr, result.returncode
+
+def check(file_path, mode, tmp):
+    base = file_path[:-len(".cl")]
+    want_out = read(base + ".out")
+    want_err = read(base + ".err")
+    out, err, status = run_program(file_path, mode, tmp)
+
+    if out is None:
+        print(f"❌ {file_path} ({mode}) did not build:\n{err}")
+        return False
+    if out != want_out:
+        print(f"❌ Mismatch in stdout for {file_path} ({mode})")
+        print(f"Expected:\n{want_out}")
+        print(f"Got:\n{out}")
+        return False
+    if err != want_err:
+        print(f"❌ Mismatch in stderr for {file_path} ({mode})")
+        print(f"Expected:\n{want_err}")
+        print(f"Got:\n{err}")
+        return False
+    if (status != 0) != (want_err != ""):
+        print(f"❌ {file_path} ({mode}) exited with status {status}")
+        return False
+
+    print(f"✅ {file_path} ({mode}) passed.")
+    return True
+
+def main():
+    files = sorted([
+        os.path.join(TESTS_DIR, f) for f in os.listdir(TESTS_DIR)
+        if f.endswith(".cl")
+    ])
+    if not files:
+        print(f"No .cl files found in {TESTS_DIR}.")
+        sys.exit(1)
+
+    failed = []
+    with tempfile.TemporaryDirectory() as tmp:
+        for file_path in files:
+            for mode in MODES:
+                if not check(file_path, mode, tmp):
+                    failed.append(f"{file_path} ({mode})")
+
+    print("=== Test Summary ===")
+    if failed:
+        print(f"{len(failed)} run(s) failed:\n" + "\n".join(failed))
+        sys.exit(1)
+    else:
+        print("All programs passed! ✅")
+
+if __name__ == "__main__":
+    main()
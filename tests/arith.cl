@@ -0,0 +1,30 @@
+(* Int arithmetic: truncating division, wrap-around and comparisons. *)
+class Main inherits IO {
+  line(i : Int) : Object { out_int(i).out_string("\n") };
+
+  main() : Object {
+    let min : Int <- ~2147483647 - 1, max : Int <- 2147483647 in {
+      line(7 / 2);
+      line(~7 / 2);
+      line(7 / ~2);
+      line(~7 / ~2);
+      line(0 / 5);
+      line(min / ~1);
+      line(min / 1);
+      line(max / ~1);
+      line(max + 1);
+      line(min - 1);
+      line(max * 2);
+      line(~min);
+      line(3 - 5 * 2 + 8 / 4);
+      out_string(if min < max then "lt " else "ge " fi);
+      out_string(if max <= max then "le " else "gt " fi);
+      out_string(if 3 = 1 + 2 then "eq " else "ne " fi);
+      out_string(if not (2 < 1) then "not\n" else "\n" fi);
+      let b : Bool <- 1 < 2, o : Object <- 5 in {
+        out_string(if b = true then "bool eq " else "bool ne " fi);
+        out_string(case o of i : Int => if i = 5 then "boxed eq\n" else "boxed ne\n" fi; esac);
+      };
+    }
+  };
+};
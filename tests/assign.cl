@@ -0,0 +1,37 @@
+(* Assignments whose value is not used, in blocks and loop bodies. *)
+class Main inherits IO {
+  count(n : Int) : Int {
+    let i : Int <- 0 in {
+      while i < n loop i <- i + 1 pool;
+      i;
+    }
+  };
+
+  build(n : Int) : String {
+    let s : String <- "", i : Int <- 0 in {
+      while i < n loop {
+        s <- s.concat("x");
+        i <- i + 1;
+      } pool;
+      s;
+    }
+  };
+
+  swap(a : Int, b : Int) : Int {
+    let t : Int in {
+      t <- a;
+      a <- b;
+      b <- t;
+      a * 10 + b;
+    }
+  };
+
+  main() : Object {{
+    count(3);
+    out_int(7).out_string("\n");
+    out_int(count(1000)).out_string("\n");
+    out_string(build(5)).out_string("\n");
+    out_int(swap(1, 2)).out_string("\n");
+    let x : Int <- 1 in out_int(x + (x <- 5) + x).out_string("\n");
+  }};
+};
@@ -0,0 +1,33 @@
+(* case picks the branch of the closest ancestor of the value's class. *)
+class A { };
+class B inherits A { };
+class C inherits B { };
+class D inherits A { };
+
+class Main inherits IO {
+  kind(x : Object) : String {
+    case x of
+      c : C => "C";
+      b : B => "B";
+      a : A => "A";
+      i : Int => "Int ".concat(if i < 0 then "negative" else "non-negative" fi);
+      s : String => "String of ".concat(s);
+      b : Bool => if b then "true" else "false" fi;
+      o : Object => "Object";
+    esac
+  };
+
+  main() : Object {{
+    out_string(kind(new A)).out_string("\n");
+    out_string(kind(new B)).out_string("\n");
+    out_string(kind(new C)).out_string("\n");
+    out_string(kind(new D)).out_string("\n");
+    out_string(kind(42)).out_string("\n");
+    out_string(kind(~3)).out_string("\n");
+    out_string(kind("abc")).out_string("\n");
+    out_string(kind(1 < 2)).out_string("\n");
+    out_string(kind(not true)).out_string("\n");
+    out_string(kind(self)).out_string("\n");
+    out_string(kind(new IO)).out_string("\n");
+  }};
+};
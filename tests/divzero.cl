@@ -0,0 +1,10 @@
+(* A division by zero stops the program after what it has written. *)
+class Main inherits IO {
+  zero : Int;
+
+  main() : Object {{
+    out_int(10 / 3).out_string("\n");
+    out_int(10 / zero).out_string("\n");
+    out_string("not reached\n");
+  }};
+};
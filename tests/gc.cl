@@ -0,0 +1,57 @@
+(* Allocates far more than any heap holds, keeping a long-lived list
+   whose old cells are made to point at young objects. *)
+class Cell {
+  val : Object;
+  next : Cell;
+  init(v : Object, n : Cell) : SELF_TYPE {{ val <- v; next <- n; self; }};
+  val() : Object { val };
+  set_val(v : Object) : Object { val <- v };
+  next() : Cell { next };
+};
+
+class Main inherits IO {
+  keep : Cell;
+
+  length(c : Cell) : Int {
+    let n : Int <- 0 in {
+      while not isvoid c loop { n <- n + 1; c <- c.next(); } pool;
+      n;
+    }
+  };
+
+  sum(c : Cell) : Int {
+    let n : Int <- 0 in {
+      while not isvoid c loop {
+        n <- n + (case c.val() of i : Int => i; s : String => s.length(); esac);
+        c <- c.next();
+      } pool;
+      n;
+    }
+  };
+
+  garbage(n : Int) : Cell {
+    let c : Cell, i : Int <- 0 in {
+      while i < n loop { c <- new Cell.init(i, c); i <- i + 1; } pool;
+      c;
+    }
+  };
+
+  main() : Object {
+    let i : Int <- 0, s : String <- "" in {
+      while i < 200 loop { keep <- new Cell.init(i, keep); i <- i + 1; } pool;
+      i <- 0;
+      while i < 100 loop {
+        garbage(500);
+        let c : Cell <- keep, j : Int <- 0 in {
+          while j < i loop { c <- c.next(); j <- j + 1; } pool;
+          c.set_val("x".concat(s));
+        };
+        s <- s.concat("y");
+        i <- i + 1;
+      } pool;
+      out_int(length(keep)).out_string("\n");
+      out_int(sum(keep)).out_string("\n");
+      out_int(s.length()).out_string("\n");
+    }
+  };
+};
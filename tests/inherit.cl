@@ -0,0 +1,42 @@
+(* Dynamic and static dispatch, overriding and attribute initialisation. *)
+class Animal {
+  name : String <- "animal";
+  legs : Int <- 4;
+  init(n : String) : SELF_TYPE {{ name <- n; self; }};
+  name() : String { name };
+  legs() : Int { legs };
+  speak() : String { "..." };
+  describe() : String { name().concat(" says ").concat(speak()) };
+};
+
+class Dog inherits Animal {
+  speak() : String { "woof" };
+};
+
+class Puppy inherits Dog {
+  speak() : String { "yip (".concat(self@Dog.speak()).concat(")") };
+};
+
+class Bird inherits Animal {
+  wings : Int <- legs() - 2;
+  speak() : String { "tweet" };
+  wings() : Int { wings };
+};
+
+class Main inherits IO {
+  show(a : Animal) : Object {
+    out_string(a.describe()).out_string("\n")
+  };
+
+  main() : Object {{
+    show(new Animal);
+    show(new Dog.init("rex"));
+    show(new Puppy.init("bit"));
+    show(new Bird.init("tweety"));
+    let p : Animal <- new Puppy.init("pup") in {
+      out_string(p@Animal.speak()).out_string("\n");
+      out_string(p.type_name()).out_string("\n");
+    };
+    out_int(new Bird.wings()).out_string("\n");
+  }};
+};
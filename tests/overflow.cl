@@ -0,0 +1,9 @@
+(* A recursion too deep for the stack is reported, not a crash. *)
+class Main inherits IO {
+  rec(n : Int) : Int { if n = 0 then 0 else 1 + rec(n - 1) fi };
+
+  main() : Object {{
+    out_int(rec(1000)).out_string("\n");
+    out_int(rec(100000000)).out_string("\n");
+  }};
+};
@@ -0,0 +1,32 @@
+(* SELF_TYPE: new SELF_TYPE, copy and methods that return self. *)
+class Counter {
+  n : Int;
+  get() : Int { n };
+  inc() : SELF_TYPE {{ n <- n + 1; self; }};
+  fresh() : SELF_TYPE { new SELF_TYPE };
+  clone() : SELF_TYPE { copy() };
+};
+
+class Named inherits Counter {
+  label : String <- "named";
+  label() : String { label };
+  rename(s : String) : SELF_TYPE {{ label <- s; self; }};
+};
+
+class Main inherits IO {
+  main() : Object {
+    let c : Counter <- new Counter.inc().inc(),
+        d : Counter <- c.clone().inc(),
+        m : Named <- new Named.rename("first").inc(),
+        f : Named <- m.fresh(),
+        k : Named <- m.clone().rename("second")
+    in {
+      out_int(c.get()).out_string(" ").out_int(d.get()).out_string("\n");
+      out_string(m.fresh().type_name()).out_string("\n");
+      out_string(f.label()).out_string(" ").out_int(f.get()).out_string("\n");
+      out_string(m.label()).out_string(" ").out_string(k.label()).out_string("\n");
+      out_int(k.inc().get()).out_string(" ").out_int(m.get()).out_string("\n");
+      out_string(copy().type_name()).out_string("\n");
+    }
+  };
+};
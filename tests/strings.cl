@@ -0,0 +1,27 @@
+(* The methods of String, string equality and escapes. *)
+class Main inherits IO {
+  reverse(s : String) : String {
+    let r : String <- "", i : Int <- s.length() in {
+      while 0 < i loop {
+        i <- i - 1;
+        r <- r.concat(s.substr(i, 1));
+      } pool;
+      r;
+    }
+  };
+
+  main() : Object {
+    let s : String <- "hello", t : String <- "world" in {
+      out_int(s.length()).out_string("\n");
+      out_string(s.concat(", ").concat(t)).out_string("\n");
+      out_string(s.substr(1, 3)).out_string("\n");
+      out_string(s.substr(5, 0)).out_string("|\n");
+      out_string(reverse("stressed")).out_string("\n");
+      out_string(if s = "hel".concat("lo") then "equal" else "different" fi).out_string("\n");
+      out_string(if s = t then "equal" else "different" fi).out_string("\n");
+      out_int("".length()).out_string("\n");
+      out_string("tab\there\\ \"quoted\"\n");
+      out_string("type ".concat(s.type_name())).out_string("\n");
+    }
+  };
+};
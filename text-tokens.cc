@@ -0,0 +1,495 @@
+//
+// text-tokens.cc
+//
+//  The cool_yylex backend for -k: a reader for the "#<line> TOKEN lexeme"
+//  stream printed by a separate ./lexer process, in place of the flex
+//  scanner of tokens-lex.cc (which is still used with -l, for its trace).
+//
+//  Nearly every line of the stream has the shape the lexer prints,
+//
+//      #12 OBJECTID foo\n
+//
+//  so the newline and the spaces of the line are found together, 32
+//  bytes at a time, and the token name is looked up in a perfect hash.
+//  Anything else -- tabs, long lines, string constants, file names,
+//  errors -- goes through scan_token below, which accepts exactly what
+//  the flex rules do and stops with the same messages.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "cool-tree.h"
+#include "stringtab.h"
+#include "utilities.h"
+#include "cool-lex.h"
+#include "string-scan.h"
+
+extern FILE *token_file;
+extern int curr_lineno;
+extern char *curr_filename;
+extern YYSTYPE cool_yylval;
+
+static Source_Text src;
+static FILE *in_file;           // the token_file src came from
+static const char *pos;         // next character to scan
+static const char *end;
+
+static char string_buf[MAX_STR_CONST];
+static char *lexeme_buf;        // '\0' terminated copy of a lexeme
+static int lexeme_cap;
+
+// As the flex scanner does, and with its exit status.
+static void unmatched(const char *expected)
+{
+  cerr << "unmatched text in token lexer; " << expected << " expected" << endl;
+  exit(2);
+}
+
+static const char *lexeme(const char *s, int len)
+{
+  if (len >= lexeme_cap) {
+    lexeme_cap = len + 64 > 2 * lexeme_cap ? len + 64 : 2 * lexeme_cap;
+    lexeme_buf = (char *) realloc(lexeme_buf, lexeme_cap);
+    if (lexeme_buf == NULL) {
+      cerr << "out of memory in token lexer" << endl;
+      exit(1);
+    }
+  }
+  memcpy(lexeme_buf, s, len);
+  lexeme_buf[len] = '\0';
+  return lexeme_buf;
+}
+
+// The white space of the flex rule, which includes '\b'.
+static inline bool is_space(char c)
+{
+  return c == ' ' || (c >= '\b' && c <= '\r');
+}
+static inline bool is_digit(char c) { return c >= '0' && c <= '9'; }
+static inline bool is_letter(char c)
+{
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+static inline bool is_idchar(char c)
+{
+  return is_letter(c) || is_digit(c) || c == '_';
+}
+static inline bool is_namechar(char c)
+{
+  return (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+// The single character tokens, written 'c'.
+static inline bool is_char_token(char c)
+{
+  return c != '\0' && strchr("()*+,-./:;<=@{}~", c) != NULL;
+}
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  Token names
+//
+//  NAME_HASH is collision free over the names below; a name is checked
+//  against the one entry in its slot.
+//
+/////////////////////////////////////////////////////////////////////////
+
+static const struct {
+  const char *name;
+  int len;
+  int token;
+} token_names[] = {
+  { "CLASS", 5, CLASS },         { "ELSE", 4, ELSE },
+  { "FI", 2, FI },               { "IF", 2, IF },
+  { "IN", 2, IN },               { "INHERITS", 8, INHERITS },
+  { "LET", 3, LET },             { "LOOP", 4, LOOP },
+  { "POOL", 4, POOL },           { "THEN", 4, THEN },
+  { "WHILE", 5, WHILE },         { "ASSIGN", 6, ASSIGN },
+  { "CASE", 4, CASE },           { "ESAC", 4, ESAC },
+  { "OF", 2, OF },               { "DARROW", 6, DARROW },
+  { "NEW", 3, NEW },             { "LE", 2, LE },
+  { "NOT", 3, NOT },             { "ISVOID", 6, ISVOID },
+  { "STR_CONST", 9, STR_CONST }, { "INT_CONST", 9, INT_CONST },
+  { "BOOL_CONST", 10, BOOL_CONST }, { "TYPEID", 6, TYPEID },
+  { "OBJECTID", 8, OBJECTID },   { "ERROR", 5, ERROR },
+};
+
+#define NAME_SLOTS 64
+#define NAME_HASH(s, len) \
+  ((7 * (unsigned char) (s)[0] + 2 * (unsigned char) (s)[1] + 3 * (len)) \
+   & (NAME_SLOTS - 1))
+
+static unsigned char name_slot[NAME_SLOTS];   // index + 1 into token_names
+static bool names_ready;
+
+static void init_names()
+{
+  names_ready = true;
+  for (int i = 0; i < (int) (sizeof(token_names) / sizeof(token_names[0])); i++)
+    name_slot[NAME_HASH(token_names[i].name, token_names[i].len)] = i + 1;
+}
+
+// The token named by the len characters at s, or 0.
+static inline int token_name(const char *s, int len)
+{
+  if (len < 2)
+    return 0;
+  int i = name_slot[NAME_HASH(s, len)];
+  if (i == 0 || token_names[i - 1].len != len ||
+      memcmp(token_names[i - 1].name, s, len) != 0)
+    return 0;
+  return token_names[i - 1].token;
+}
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  The general scanner
+//
+/////////////////////////////////////////////////////////////////////////
+
+static void skip_space()
+{
+  while (pos < end && is_space(*pos))
+    pos++;
+}
+
+// atoi() of the digits at pos, as flex's rule uses it.
+static int line_number()
+{
+  long n = 0;
+
+  for (; pos < end && is_digit(*pos); pos++) {
+    int d = *pos - '0';
+    n = n > (LONG_MAX - d) / 10 ? LONG_MAX : 10 * n + d;
+  }
+  return (int) n;
+}
+
+//
+// The string constant after the opening quote, decoded into string_buf.
+// A newline in it is dropped, and a backslash that does not start one of
+// the escapes the lexer writes is kept.  The lexer never prints a string
+// longer than MAX_STR_CONST - 1; one that is longer is cut short here.
+// False at EOF before the closing quote.
+//
+static bool scan_string()
+{
+  char *out = string_buf;
+  char *limit = string_buf + MAX_STR_CONST - 1;
+
+  while (pos < end) {
+    size_t n = string_run(pos, end);
+    if (n) {
+      size_t room = limit - out;
+      memcpy(out, pos, n < room ? n : room);
+      out += n < room ? n : room;
+      pos += n;
+      if (pos == end)
+	break;
+    }
+
+    char c = *pos++;
+    if (c == '"') {
+      *out = '\0';
+      return true;
+    }
+    if (c == '\n')
+      continue;
+    if (c == '\\' && pos < end) {
+      switch (*pos) {
+      case 'n':  c = '\n'; pos++; break;
+      case 't':  c = '\t'; pos++; break;
+      case 'b':  c = '\b'; pos++; break;
+      case 'f':  c = '\f'; pos++; break;
+      case '\\': c = '\\'; pos++; break;
+      case '"':  c = '"';  pos++; break;
+      default:
+	if (end - pos >= 3 && pos[0] >= '0' && pos[0] <= '3' &&
+	    pos[1] >= '0' && pos[1] <= '7' && pos[2] >= '0' && pos[2] <= '7') {
+	  c = (char) ((pos[0] - '0') * 64 + (pos[1] - '0') * 8 + (pos[2] - '0'));
+	  pos += 3;
+	}
+	break;
+      }
+    }
+    if (out < limit)
+      *out++ = c;
+  }
+  return false;
+}
+
+//
+// The lexeme of token, which has just been read, if it has one, into
+// cool_yylval.  Returns token, or 0 at EOF.
+//
+static int scan_value(int token)
+{
+  const char *start;
+
+  switch (token) {
+  case STR_CONST: case ERROR: case INT_CONST: case BOOL_CONST:
+  case TYPEID: case OBJECTID:
+    break;
+  default:
+    return token;
+  }
+  skip_space();
+  if (pos == end)
+    return 0;
+
+  switch (token) {
+  case STR_CONST:
+  case ERROR:
+    if (*pos != '"')
+      unmatched(token == ERROR ? "error message" : "string constant");
+    pos++;
+    if (!scan_string())
+      return 0;
+    if (token == ERROR)
+      cool_yylval.error_msg = strdup(string_buf);
+    else
+      cool_yylval.symbol = stringtable.add_string(string_buf, MAX_STR_CONST);
+    return token;
+
+  case INT_CONST:
+    start = pos;
+    while (pos < end && is_digit(*pos))
+      pos++;
+    if (pos == start)
+      unmatched("int constant");
+    cool_yylval.symbol = inttable.add_string(lexeme(start, pos - start), pos - start);
+    return token;
+
+  case BOOL_CONST:
+    if (end - pos >= 4 && memcmp(pos, "true", 4) == 0) {
+      cool_yylval.boolean = 1;
+      pos += 4;
+    } else if (end - pos >= 5 && memcmp(pos, "false", 5) == 0) {
+      cool_yylval.boolean = 0;
+      pos += 5;
+    } else
+      unmatched("bool constant");
+    return token;
+
+  case TYPEID:
+  case OBJECTID:
+    start = pos;
+    if (!is_letter(*pos))
+      unmatched(token == TYPEID ? "type symbol" : "object symbol");
+    while (pos < end && is_idchar(*pos))
+      pos++;
+    cool_yylval.symbol = idtable.add_string(lexeme(start, pos - start), pos - start);
+    return token;
+  }
+  return token;
+}
+
+//
+// The token after a line number: the longest token name at pos, as flex
+// would match it, or a single character token.  Returns 0 at EOF.
+//
+static int scan_token()
+{
+  skip_space();
+  if (pos == end)
+    return 0;
+
+  if (*pos == '\'') {
+    if (end - pos < 3 || !is_char_token(pos[1]) || pos[2] != '\'')
+      unmatched("token");
+    pos += 3;
+    return pos[-2];
+  }
+
+  int run = 0;
+  while (pos + run < end && is_namechar(pos[run]))
+    run++;
+  for (; run >= 2; run--) {
+    int token = token_name(pos, run);
+    if (token) {
+      pos += run;
+      return scan_value(token);
+    }
+  }
+  unmatched("token");
+  return 0;
+}
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  Lines of the usual shape
+//
+/////////////////////////////////////////////////////////////////////////
+
+//
+// Bit i of *newlines and *spaces is set if p[i] is '\n' or ' ', for the
+// 32 bytes at p: two SSE2 compares of 16 bytes each, which every x86-64
+// has, so no other path is chosen at run time.
+//
+static inline void line_masks(const char *p, uint32_t *newlines, uint32_t *spaces)
+{
+#if defined(__SSE2__)
+  __m128i lo = _mm_loadu_si128((const __m128i *) p);
+  __m128i hi = _mm_loadu_si128((const __m128i *) (p + 16));
+  __m128i nl = _mm_set1_epi8('\n');
+  __m128i sp = _mm_set1_epi8(' ');
+  *newlines = (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(lo, nl)) |
+              (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(hi, nl)) << 16;
+  *spaces = (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(lo, sp)) |
+            (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(hi, sp)) << 16;
+#else
+  uint32_t n = 0, s = 0;
+  for (int i = 0; i < 32; i++) {
+    n |= (uint32_t) (p[i] == '\n') << i;
+    s |= (uint32_t) (p[i] == ' ') << i;
+  }
+  *newlines = n;
+  *spaces = s;
+#endif
+}
+
+//
+// The token of a line "#<line> NAME[ lexeme]\n" at pos, with at least 32
+// bytes left.  Returns -1, having consumed nothing, if the line is not
+// of that shape or its lexeme is a string; scan_token then sees it.
+//
+static int scan_line()
+{
+  uint32_t newlines, spaces;
+
+  line_masks(pos, &newlines, &spaces);
+  if (newlines == 0)
+    return -1;
+  int eol = __builtin_ctz(newlines);
+  spaces &= (1u << eol) - 1;
+  if (spaces == 0)
+    return -1;
+
+  // The line number: at most 9 digits, so that it cannot overflow.
+  int sp1 = __builtin_ctz(spaces);
+  if (sp1 < 2 || sp1 > 10)
+    return -1;
+  int line = 0;
+  for (int i = 1; i < sp1; i++) {
+    if (!is_digit(pos[i]))
+      return -1;
+    line = 10 * line + (pos[i] - '0');
+  }
+
+  spaces &= spaces - 1;
+  int sp2 = spaces ? __builtin_ctz(spaces) : eol;
+  const char *name = pos + sp1 + 1;
+  int len = sp2 - sp1 - 1;
+  int token;
+  if (len == 3 && name[0] == '\'' && name[2] == '\'' && is_char_token(name[1]))
+    token = name[1];
+  else if (!(token = token_name(name, len)))
+    return -1;
+
+  const char *value = pos + sp2 + 1;
+  int value_len = eol - sp2 - 1;
+  switch (token) {
+  case STR_CONST:
+  case ERROR:
+    return -1;
+
+  case INT_CONST:
+  case BOOL_CONST:
+  case TYPEID:
+  case OBJECTID:
+    if (value_len <= 0 || (spaces & (spaces - 1)))
+      return -1;
+    if (token == INT_CONST) {
+      for (int i = 0; i < value_len; i++)
+	if (!is_digit(value[i]))
+	  return -1;
+      cool_yylval.symbol = inttable.add_string(lexeme(value, value_len), value_len);
+    } else if (token == BOOL_CONST) {
+      if (value_len == 4 && memcmp(value, "true", 4) == 0)
+	cool_yylval.boolean = 1;
+      else if (value_len == 5 && memcmp(value, "false", 5) == 0)
+	cool_yylval.boolean = 0;
+      else
+	return -1;
+    } else {
+      if (!is_letter(value[0]))
+	return -1;
+      for (int i = 1; i < value_len; i++)
+	if (!is_idchar(value[i]))
+	  return -1;
+      cool_yylval.symbol = idtable.add_string(lexeme(value, value_len), value_len);
+    }
+    break;
+
+  default:
+    if (sp2 != eol)
+      return -1;
+    break;
+  }
+
+  curr_lineno = line;
+  pos += eol + 1;
+  return token;
+}
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  text_yylex
+//
+/////////////////////////////////////////////////////////////////////////
+
+int text_yylex()
+{
+  if (in_file != token_file) {
+    if (!names_ready)
+      init_names();
+    load_source(token_file, curr_filename, &src);
+    pos = src.text;
+    end = src.text + src.len;
+    in_file = token_file;
+  }
+
+  for (;;) {
+    skip_space();
+    if (pos == end)
+      break;
+
+    if (*pos == '#' && end - pos >= 32) {
+      int token = scan_line();
+      if (token >= 0)
+	return token;
+    }
+
+    if (*pos != '#')
+      unmatched("line number");
+    if (end - pos >= 2 && is_digit(pos[1])) {
+      pos++;
+      curr_lineno = line_number();
+      int token = scan_token();
+      if (token)
+	return token;
+      break;
+    }
+
+    // #name "file"
+    if (end - pos < 5 || memcmp(pos, "#name", 5) != 0)
+      unmatched("line number");
+    pos += 5;
+    skip_space();
+    if (pos == end || *pos != '"')
+      unmatched("line number");
+    pos++;
+    if (!scan_string())
+      break;
+    curr_filename = strdup(string_buf);
+  }
+
+  in_file = NULL;       // the next token_file may reuse the same FILE
+  return 0;
+}
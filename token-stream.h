@@ -0,0 +1,49 @@
+#ifndef TOKEN_STREAM_H
+#define TOKEN_STREAM_H
+
+//
+// token-stream.h
+//
+//  The binary token stream passed from a lexer process to the parser with
+//  "./parser -E foo.cl | ./parser -b".  It carries the same information as
+//  the textual "#<line> TOKEN lexeme" stream in a fraction of the bytes:
+//
+//    stream  := MAGIC record*
+//    record  := kind line-delta [operand]
+//             | TS_FILE  varint-length name-bytes
+//             | TS_SYMBOL table varint-length text-bytes
+//
+//  kind is the character itself for the single character tokens and
+//  TS_TOKEN_BASE + (token - CLASS) for the others.  line-delta is an
+//  unsigned varint added to the line of the previous token; TS_FILE sets
+//  the file name and resets the line to 1.
+//
+//  The text of an identifier, integer or string constant is sent once, in
+//  a TS_SYMBOL record that appends it to the stream's copy of that table;
+//  TYPEID, OBJECTID, INT_CONST and STR_CONST are followed by a varint index
+//  into it.  BOOL_CONST is followed by one byte, 0 or 1, and ERROR by a
+//  varint length and the message.
+//
+//  Varints are little endian, seven bits per byte, high bit set on every
+//  byte but the last.
+//
+
+#include <stdio.h>
+
+#define TS_MAGIC       "\177CTK\001"
+#define TS_MAGIC_LEN   5
+
+#define TS_TOKEN_BASE  0x80
+#define TS_FILE        0xF0
+#define TS_SYMBOL      0xF1
+
+enum TS_Table { TS_IDTABLE, TS_INTTABLE, TS_STRINGTABLE };
+
+// Write the tokens of the files named in argv (after the options) or of
+// standard input to out, scanning them as cool_yylex does.
+void emit_token_stream(int argc, const char *argv[], FILE *out);
+
+// cool_yylex backend for a binary token stream on token_file.
+int binary_yylex();
+
+#endif
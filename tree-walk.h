@@ -0,0 +1,96 @@
+#ifndef TREE_WALK_H
+#define TREE_WALK_H
+
+//
+// tree-walk.h
+//
+//  Walking the tree without recursion.  A chain of '+' or of lets gives
+//  a tree as deep as the chain is long, much deeper than the C++ stack
+//  has room for a frame per level, so the walks over the tree (dump,
+//  dump_with_types, copy and write_ast) keep their own stack, on the
+//  heap, of the nodes they are part way through.
+//
+//  A node of k = t->children() subtrees is visited in k + 1 parts:
+//
+//      part 0, subtree 0, part 1, subtree 1, ..., subtree k-1, part k
+//
+//  An operation on the tree is a class with a method
+//
+//      int part(tree_node *t, int i, int arg);
+//
+//  that does part i of t.  arg is what was passed down for t, and the
+//  value returned is passed down to subtree i (the indentation, for the
+//  dumps); the value returned by the last part is not used.  Since the
+//  last part of a node comes after all of its subtrees, an operation can
+//  work top down, bottom up or both.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include "tree.h"
+
+struct Walk_Frame {
+  tree_node *t;
+  int i;                        // the next part of t
+  int n;                        // t->children()
+  int arg;
+};
+
+//
+// A stack of the frames of the nodes a walk is part way through.  The
+// first WALK_FRAMES are in the walk's own C++ frame; a deeper tree moves
+// them to the heap, doubling their room each time it runs out.
+//
+#define WALK_FRAMES 256
+
+template <class Frame> struct Walk_Stack {
+  Frame *base, *top, *end;
+  Frame local[WALK_FRAMES];
+
+  Walk_Stack() : base(local), top(local), end(local + WALK_FRAMES) { }
+  ~Walk_Stack() { if (base != local) free(base); }
+  bool empty() { return top == base; }
+  void push(const Frame &f) { if (top == end) grow(); *top++ = f; }
+  Frame pop() { return *--top; }
+  void grow();
+};
+
+template <class Frame> void Walk_Stack<Frame>::grow()
+{
+  size_t n = end - base;
+  Frame *frames = (Frame *) malloc(2 * n * sizeof(Frame));
+  if (frames == NULL) {
+    cerr << "out of memory for walking the tree\n";
+    exit(1);
+  }
+  memcpy(frames, base, n * sizeof(Frame));
+  if (base != local)
+    free(base);
+  base = frames;
+  top = frames + n;
+  end = frames + 2 * n;
+}
+
+template <class Op> void walk_tree(tree_node *root, Op &op, int arg)
+{
+  Walk_Stack<Walk_Frame> stack;
+  Walk_Frame f = { root, 0, root->children(), arg };
+
+  for (;;) {
+    int a = op.part(f.t, f.i, f.arg);
+    if (f.i < f.n) {
+      tree_node *c = f.t->child(f.i++);
+      stack.push(f);
+      f.t = c;
+      f.i = 0;
+      f.n = c->children();
+      f.arg = a;
+    } else if (stack.empty()) {
+      return;
+    } else {
+      f = stack.pop();
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,207 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+///////////////////////////////////////////////////////////////////////////
+//
+// file: tree.cc
+//
+// This file defines the basic class of tree node
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <stdlib.h>
+#include "tree.h"
+#include "tree-walk.h"
+#include "parse-stats.h"
+
+/* line number to assign to the current node being constructed */
+thread_local int node_lineno = 1;
+
+///////////////////////////////////////////////////////////////////////////
+//
+// tree_node::tree_node
+//
+// constructor of tree node
+//
+///////////////////////////////////////////////////////////////////////////
+tree_node::tree_node()
+{
+    line_number = node_lineno;
+}
+
+///////////////////////////////////////////////////////////////////////////
+//
+// tree_node::get_line_number
+//
+// access to the line number
+//
+///////////////////////////////////////////////////////////////////////////
+int tree_node::get_line_number()
+{
+    return line_number;
+}
+
+//
+// Set up common area from existing node
+//
+tree_node *tree_node::set(tree_node *t) {
+   line_number = t->line_number;
+   return this;
+}
+
+///////////////////////////////////////////////////////////////////////////
+//
+// copy_tree / dump_tree
+//
+// The deep copy and the plain dump of a tree, as walks (tree-walk.h).  A
+// copy is made bottom up: the copies of the subtrees are kept on a stack
+// until their parent's last part makes the parent's copy out of them.
+//
+///////////////////////////////////////////////////////////////////////////
+
+struct Copy_Walk {
+    std::vector<tree_node *> copies;
+
+    int part(tree_node *t, int i, int)
+    {
+        int k = t->children();
+        if (i == k) {
+            tree_node *c = t->copy_with(copies.data() + copies.size() - k);
+            copies.resize(copies.size() - k);
+            copies.push_back(c);
+        }
+        return 0;
+    }
+};
+
+tree_node *copy_tree(tree_node *t)
+{
+    Copy_Walk w;
+    walk_tree(t, w, 0);
+    return w.copies[0];
+}
+
+struct Dump_Walk {
+    ostream& stream;
+    Dump_Walk(ostream& s) : stream(s) { }
+    int part(tree_node *t, int i, int n) { return t->dump_part(stream, n, i); }
+};
+
+void dump_tree(tree_node *t, ostream& stream, int n)
+{
+    Dump_Walk w(stream);
+    walk_tree(t, w, n);
+}
+
+///////////////////////////////////////////////////////////////////////////
+//
+// alloc_tree_node / release_tree_nodes
+//
+// The node arena of this thread.  Chunks are chained through their first
+// word; a node too big to share a chunk gets one of its own.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#define ARENA_CHUNK_SIZE (1 << 20)
+#define ARENA_ALIGN 16
+
+static thread_local Tree_Arena arena;
+
+static char *new_arena_chunk(size_t size)
+{
+    char *c = (char *) malloc(size);
+    if (c == NULL) {
+        cerr << "out of memory for tree nodes\n";
+        exit(1);
+    }
+    *(char **) c = arena.chunks;
+    arena.chunks = c;
+    return c + ARENA_ALIGN;
+}
+
+void *alloc_tree_node(size_t size)
+{
+    parse_stats.nodes++;
+    size = (size + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1);
+    if (size > ARENA_CHUNK_SIZE / 4)
+        return new_arena_chunk(size + ARENA_ALIGN);
+
+    if (size > (size_t) (arena.end - arena.next)) {
+        arena.next = new_arena_chunk(ARENA_CHUNK_SIZE);
+        arena.end = arena.next + ARENA_CHUNK_SIZE - ARENA_ALIGN;
+    }
+    void *p = arena.next;
+    arena.next += size;
+    return p;
+}
+
+void release_tree_nodes()
+{
+    release_tree_arena(&arena);
+}
+
+Tree_Arena mark_tree_nodes()
+{
+    return arena;
+}
+
+//
+// Free the chunks begun since mark and go back to allocating where it
+// left off.  The nodes made before the mark are untouched.
+//
+void release_tree_nodes_to(Tree_Arena mark)
+{
+    while (arena.chunks != mark.chunks) {
+        char *c = arena.chunks;
+        arena.chunks = *(char **) c;
+        free(c);
+    }
+    arena.next = mark.next;
+    arena.end = mark.end;
+}
+
+///////////////////////////////////////////////////////////////////////////
+//
+// swap_tree_nodes
+//
+// Make a the arena new nodes of this thread come from, and return the one
+// it replaces.  An arena of all NULLs is empty.
+//
+///////////////////////////////////////////////////////////////////////////
+
+Tree_Arena swap_tree_nodes(Tree_Arena a)
+{
+    Tree_Arena old = arena;
+    arena = a;
+    return old;
+}
+
+//
+// Move the chunks of a into this thread's arena, to be freed along with
+// its own nodes.  a is left empty.
+//
+void adopt_tree_arena(Tree_Arena *a)
+{
+    if (a->chunks == NULL)
+        return;
+
+    char *last = a->chunks;
+    while (*(char **) last)
+        last = *(char **) last;
+    *(char **) last = arena.chunks;
+    arena.chunks = a->chunks;
+    a->chunks = a->next = a->end = NULL;
+}
+
+void release_tree_arena(Tree_Arena *a)
+{
+    while (a->chunks) {
+        char *c = a->chunks;
+        a->chunks = *(char **) c;
+        free(c);
+    }
+    a->next = a->end = NULL;
+}
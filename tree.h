@@ -0,0 +1,427 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+#ifndef TREE_H
+#define TREE_H
+///////////////////////////////////////////////////////////////////////////
+//
+// file: tree.h
+//
+// This file defines the basic class of tree node and list
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <stddef.h>
+#include <vector>
+#include "stringtab.h"
+#include "cool-io.h"
+
+/////////////////////////////////////////////////////////////////////
+//
+//  Node allocation
+//
+//   Tree nodes are bump-allocated in large chunks from a per-compilation
+//   arena, so nodes made one after another sit next to each other in
+//   memory.  They are never deleted one at a time; release_tree_nodes()
+//   frees every node made so far at once, after the tree has been dumped
+//   or handed off.
+//
+//   mark_tree_nodes() notes where the arena is, and release_tree_nodes_to()
+//   frees every node made since, so a tree can be dropped once it has
+//   been written out (--stream).
+//
+//   Each thread allocates from its own arena.  swap_tree_nodes() puts
+//   another arena in its place, so that the nodes of one parse can be
+//   kept apart and freed with release_tree_arena(), or handed to another
+//   thread's arena with adopt_tree_arena().
+//
+//   New nodes take their line number from node_lineno, which is also
+//   per thread.
+//
+/////////////////////////////////////////////////////////////////////
+
+struct Tree_Arena {
+    char *chunks;               // most recent chunk
+    char *next;                 // free space in the current chunk
+    char *end;
+};
+
+void *alloc_tree_node(size_t size);
+void release_tree_nodes();
+Tree_Arena mark_tree_nodes();
+void release_tree_nodes_to(Tree_Arena mark);
+Tree_Arena swap_tree_nodes(Tree_Arena arena);
+void adopt_tree_arena(Tree_Arena *arena);
+void release_tree_arena(Tree_Arena *arena);
+
+extern thread_local int node_lineno;
+
+/////////////////////////////////////////////////////////////////////
+//
+//  tree_node
+//
+//   All APS nodes are derived from tree_node.  There is a
+//   protected field:
+//       int line_number     line in the source file from which this node came;
+//                           this is normally set by the parser
+//   
+//   Every node can be copied, dumped, and set the line number.
+//
+//   Copying and dumping walk the tree with a stack of their own (see
+//   tree-walk.h), so each node gives its subtrees, child(0) up to
+//   child(children() - 1), and does its own part of each walk one part
+//   at a time.  The defaults of dump_with_types_part and write_ast_part
+//   are what a list does.
+//
+/////////////////////////////////////////////////////////////////////
+
+class Dump_Buffer;
+class Ast_Writer;
+
+class tree_node {
+protected:
+    int line_number;            // stash the line number when node is made
+public:
+    static void *operator new(size_t size) { return alloc_tree_node(size); }
+    static void operator delete(void *)    { }   // see release_tree_nodes
+    tree_node();
+    virtual tree_node *copy() = 0;
+    virtual ~tree_node() { }
+    virtual void dump(ostream& stream, int n) = 0;
+    int get_line_number();
+    tree_node *set(tree_node *);
+
+    virtual int children() = 0;
+    virtual tree_node *child(int i) = 0;
+    virtual tree_node *copy_with(tree_node **subtrees) = 0;
+    virtual int dump_part(ostream& stream, int n, int i) = 0;
+    virtual int dump_with_types_part(Dump_Buffer& stream, int n, int i);
+    virtual void write_ast_part(Ast_Writer& w, int i);
+};
+
+tree_node *copy_tree(tree_node *t);
+void dump_tree(tree_node *t, ostream& stream, int n);
+
+
+///////////////////////////////////////////////////////////////////
+//
+//  Lists of APS objects are implemented by the "list_node"
+//  template.
+//
+//  Lists are made of three classes:
+//
+//     "list_node" is the abstract superclass of lists.
+//
+//     "nil_node" is the empty list.
+//
+//     "single_list_node" is a list containing a single element
+//
+//     "append_node" is the result of appending two lists
+//
+//  Lists support the iterator interface: first(), next(i), more(i),
+//  and nth(i), as well as copying, length, and dumping.
+//
+//  An append_node keeps its elements in a growable array, a list_store,
+//  so nth() and len() take constant time.  The array is filled the first
+//  time the list is used, not when it is made, since the parser's error
+//  rules can leave lists it never looks at holding garbage.  The lists
+//  built by the left-recursive rules, append(append(...), single(e)),
+//  share one store: the list that ends a store is extended in place, and
+//  any other list is copied first, so a list never changes once made.
+//
+///////////////////////////////////////////////////////////////////
+
+template <class Elem> class list_node : public tree_node {
+public:
+    tree_node *copy()            { return copy_list(); }
+    Elem nth(int n);             // this is the n-th element in the list
+    int first()                  { return 0; }
+    int next(int n)              { return n + 1; }
+    int more(int n)              { return (n < len()); }
+
+    list_node<Elem> *copy_list() { return (list_node<Elem> *) copy_tree(this); }
+    void dump(ostream& stream, int n) { dump_tree(this, stream, n); }
+    int children()               { return len(); }
+    tree_node *child(int i)      { return nth(i); }
+    virtual ~list_node() { }
+    virtual int len() = 0;
+    virtual Elem nth_length(int n, int &len) = 0;
+
+    static list_node<Elem> *nil();
+    static list_node<Elem> *single(Elem);
+    static list_node<Elem> *append(list_node<Elem> *l1,list_node<Elem> *l2);
+};
+
+char *pad(int n);
+
+extern int info_size;
+
+template <class Elem> class nil_node : public list_node<Elem> {
+public:
+    int len();
+    Elem nth_length(int n, int &len);
+    tree_node *copy_with(tree_node **subtrees);
+    int dump_part(ostream& stream, int n, int i);
+};
+
+template <class Elem> class single_list_node : public list_node<Elem> {
+    Elem elem;
+public:
+    single_list_node(Elem t) {
+        elem = t;
+    }
+    int len();
+    Elem nth_length(int n, int &len);
+    tree_node *copy_with(tree_node **subtrees);
+    int dump_part(ostream& stream, int n, int i);
+};
+
+
+template <class Elem> struct list_store {
+    Elem *elems;
+    int size;                   // elements in use by the longest list
+    int cap;
+};
+
+template <class Elem> class append_node : public list_node<Elem> {
+private:
+    list_node<Elem> *some, *rest;
+    list_store<Elem> *store;    // NULL until flattened
+    int length;                 // this list is store->elems[0 .. length-1]
+
+    void flatten();
+    void new_store();
+    void push(Elem e);
+    void push_all(list_node<Elem> *l);
+public:
+    append_node(list_node<Elem> *l1, list_node<Elem> *l2) {
+        some = l1;
+        rest = l2;
+        store = NULL;
+        length = 0;
+    }
+    int len();
+    Elem nth_length(int n, int &len);
+    tree_node *copy_with(tree_node **subtrees);
+    int dump_part(ostream& stream, int n, int i);
+};
+
+template <class Elem> single_list_node<Elem> *list(Elem x);
+template <class Elem> append_node<Elem> *cons(Elem x, list_node<Elem> *l);
+template <class Elem> append_node<Elem> *xcons(list_node<Elem> *l, Elem x);
+
+template <class Elem> list_node<Elem> *list_node<Elem>::nil()
+{
+    return new nil_node<Elem>();
+}
+
+template <class Elem> list_node<Elem> *list_node<Elem>::single(Elem e)
+{
+    return new single_list_node<Elem>(e);
+}
+
+template <class Elem> list_node<Elem> *list_node<Elem>::append(list_node<Elem> *l1,list_node<Elem> *l2)
+{
+    return new append_node<Elem>(l1,l2);
+}
+
+///////////////////////////////////////////////////////////////////////////
+//
+// list_node::nth
+//
+// function to find the N-th element of the list
+//
+///////////////////////////////////////////////////////////////////////////
+
+template <class Elem> Elem list_node<Elem>::nth(int n)
+{
+    int len;
+    Elem tmp = nth_length(n ,len);
+
+    if (tmp)
+        return tmp;
+    else {
+        cerr << "error: outside the range of the list\n";
+        exit(1);
+    }
+}
+
+// added 10/30/06 cgs: avoid g++ warnings. code never reached.
+// (actually, no such warning in this copy.)
+
+///////////////////////////////////////////////////////////////////////////
+//
+// nil_node::copy_with
+//
+// a new nil_node, for copy_list
+//
+///////////////////////////////////////////////////////////////////////////
+
+template <class Elem> tree_node *nil_node<Elem>::copy_with(tree_node **)
+{
+    return new nil_node<Elem>();
+}
+
+template <class Elem> int nil_node<Elem>::len()
+{
+    return 0;
+}
+
+template <class Elem> Elem nil_node<Elem>::nth_length(int n, int &len)
+{
+    len = 0;
+    return NULL;
+}
+
+template <class Elem> int nil_node<Elem>::dump_part(ostream& stream, int n, int)
+{
+    stream << pad(n) << "(nil)\n";
+    return n;
+}
+
+template <class Elem> tree_node *single_list_node<Elem>::copy_with(tree_node **subtrees)
+{
+    return new single_list_node<Elem>((Elem) subtrees[0]);
+}
+
+template <class Elem> int single_list_node<Elem>::len()
+{
+    return 1;
+}
+
+template <class Elem> Elem single_list_node<Elem>::nth_length(int n, int &len)
+{
+    len = 1;
+    if (n)
+        return NULL;
+    else
+        return elem;
+}
+
+template <class Elem> int single_list_node<Elem>::dump_part(ostream&, int n, int)
+{
+    return n;                   // just the element
+}
+
+///////////////////////////////////////////////////////////////////////////
+//
+// append_node::flatten
+//
+// Fill in the store of this list and of the unflattened appends down its
+// left spine, bottom up.  A list is added to the end of its left
+// operand's store when that operand ends the store; otherwise both
+// operands are copied into a new one.  Stores live in the node arena.
+//
+///////////////////////////////////////////////////////////////////////////
+
+template <class Elem> void append_node<Elem>::flatten()
+{
+    std::vector<append_node<Elem> *> spine;
+    append_node<Elem> *a = this;
+
+    for (;;) {
+        spine.push_back(a);
+        append_node<Elem> *b = dynamic_cast<append_node<Elem> *>(a->some);
+        if (!b || b->store)
+            break;
+        a = b;
+    }
+
+    while (!spine.empty()) {
+        a = spine.back();
+        spine.pop_back();
+        append_node<Elem> *b = dynamic_cast<append_node<Elem> *>(a->some);
+        if (b && b->length == b->store->size) {
+            a->store = b->store;
+            a->length = b->length;
+        } else {
+            a->new_store();
+            a->push_all(a->some);
+        }
+        a->push_all(a->rest);
+    }
+}
+
+template <class Elem> void append_node<Elem>::new_store()
+{
+    store = (list_store<Elem> *) alloc_tree_node(sizeof(list_store<Elem>));
+    store->elems = NULL;
+    store->size = store->cap = 0;
+    length = 0;
+}
+
+template <class Elem> void append_node<Elem>::push(Elem e)
+{
+    if (store->size == store->cap) {
+        int cap = store->cap ? 2 * store->cap : 4;
+        Elem *elems = (Elem *) alloc_tree_node(cap * sizeof(Elem));
+        for (int i = 0; i < store->size; i++)
+            elems[i] = store->elems[i];
+        store->elems = elems;
+        store->cap = cap;
+    }
+    store->elems[store->size++] = e;
+    length = store->size;
+}
+
+template <class Elem> void append_node<Elem>::push_all(list_node<Elem> *l)
+{
+    int size = l->len();
+    for (int i = 0; i < size; i++)
+        push(l->nth(i));
+}
+
+template <class Elem> tree_node *append_node<Elem>::copy_with(tree_node **subtrees)
+{
+    append_node<Elem> *c = new append_node<Elem>(NULL, NULL);
+    c->new_store();
+    for (int i = 0; i < len(); i++)
+        c->push((Elem) subtrees[i]);
+    return c;
+}
+
+template <class Elem> int append_node<Elem>::len()
+{
+    if (!store)
+        flatten();
+    return length;
+}
+
+template <class Elem> Elem append_node<Elem>::nth_length(int n, int &len)
+{
+    if (!store)
+        flatten();
+    len = length;
+    if (n < 0 || n >= length)
+        return NULL;
+    return store->elems[n];
+}
+
+template <class Elem> int append_node<Elem>::dump_part(ostream& stream, int n, int i)
+{
+    if (i == 0)
+        stream << pad(n) << "list\n";
+    if (i == len())
+        stream << pad(n) << "(end_of_list)\n";
+    return n + 2;
+}
+
+template <class Elem> single_list_node<Elem> *list(Elem x)
+{
+    return new single_list_node<Elem>(x);
+}
+
+template <class Elem> append_node<Elem> *cons(Elem x, list_node<Elem> *l)
+{
+    return new append_node<Elem>(list(x), l);
+}
+
+template <class Elem> append_node<Elem> *xcons(list_node<Elem> *l, Elem x)
+{
+    return new append_node<Elem>(l, list(x));
+}
+
+#endif /* TREE_H */
@@ -0,0 +1,1176 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//
+// vm-compile.cc
+//
+//  Lays out the classes of a program for -run and compiles their
+//  methods into the bytecode of vm.h.
+//
+//  The classes are laid out parents first.  An object has its inherited
+//  attributes first, so an attribute has the same index in a class and
+//  all its descendants; a class starts with a copy of its parent's
+//  method table and then adds or overrides its own methods.  The
+//  attribute initializers of a class become a method, init, that runs
+//  those of the parent and then its own; new runs it on the new object.
+//
+//  Each expression is compiled by its compile(c, target), which returns
+//  the register that holds its value.  If target is a register (not -1)
+//  the value ends up there, written by the last instruction on each
+//  path, so that "x <- x + 1" can compute into x directly.  A variable
+//  is its register; other values are put in temporaries, allocated as a
+//  stack above the variables in scope and given back once used.
+//
+//  Ints and Bools are unboxed wherever they need not be objects (see
+//  vm.h).  How an expression's value is held, its rep, is worked out
+//  by the analysis of rep.h.  value(e, target, want) boxes or unboxes e's
+//  value if it is not held as wanted; unboxing checks the class of the
+//  object, so an ill-typed program still fails where it ran.
+//
+//  How the arguments and the result of a call are passed is decided for
+//  each method name and number of arguments, its signature, from the
+//  declared types of all the methods that have it (see vm.h).  A formal
+//  declared Int or Bool that is passed boxed anyway is unboxed into a
+//  variable of its own when its method starts.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <algorithm>
+#include <map>
+#include "cool-io.h"
+#include "cool-tree.h"
+#include "stringtab.h"
+#include "vm.h"
+#include "rep.h"
+
+// How deeply expressions may nest; compile recurses on the tree.
+#define VM_MAX_NESTING 10000
+
+class Vm_Compiler : public Rep_Analysis {
+  std::unordered_map<Vm_Method *, int> static_index;
+  std::unordered_map<int, int> int_constants;
+  std::unordered_map<Symbol, int> string_constants;
+  int bool_constants[2];
+
+  struct Variable {
+    Symbol name;
+    int reg;
+    Vm_Rep rep;
+  };
+  std::vector<Variable> scope;  // innermost last
+  int depth;
+
+public:
+  Vm_Class *cls;                // being compiled
+  Vm_Method *method;
+  int top;                      // the first free register
+  Expression unused;            // being compiled by effect()
+  Symbol self, SELF_TYPE;
+
+  Vm_Compiler();
+  void start(Vm_Class *c, Vm_Method *m);
+
+  void error(tree_node *t, const char *msg, Symbol name = NULL);
+
+  int temp()
+  {
+    if (top >= method->regs)
+      method->regs = top + 1;
+    return top++;
+  }
+  int dest(int target) { return target >= 0 ? target : temp(); }
+
+  int local(Symbol name);
+  Vm_Rep local_rep(Symbol name);
+  void bind(Symbol name, int reg, Vm_Rep rep = REP_BOXED)
+  {
+    Variable v = { name, reg, rep };
+    scope.push_back(v);
+  }
+  void bind_rep(Symbol name, Vm_Rep rep) { bind(name, -1, rep); }
+  void unbind() { scope.pop_back(); }
+  Vm_Rep attr_rep(int index);
+
+  void enter(Expression e)
+  {
+    if (++depth > VM_MAX_NESTING)
+      error(e, "Expression nested too deeply to run");
+  }
+  void leave() { depth--; }
+  int value(Expression e, int target, Vm_Rep want);
+  int value(Expression e, int target) { return value(e, target, rep(e)); }
+  int effect(Expression e);
+  int emit(tree_node *t, Vm_Op op, int a = 0, int b = 0, int c = 0);
+  void move(tree_node *t, int to, int from)
+  {
+    if (to != from)
+      emit(t, OP_MOVE, to, from);
+  }
+  int here() { return method->code.size(); }
+  Vm_Insn &at(int pc) { return method->code[pc]; }
+
+  int int_constant(int val);
+  int string_constant(Symbol token);
+  int bool_constant(bool b);
+  int default_value(tree_node *t, Symbol type, int target);
+  int site(Symbol name, Vm_Rep ret);
+  int static_method(Vm_Method *m);
+  Vm_Class *class_named(tree_node *t, Symbol name);
+};
+
+Vm_Compiler::Vm_Compiler() : depth(0), cls(NULL), method(NULL), top(0), unused(NULL)
+{
+  bool_constants[0] = bool_constants[1] = -1;
+  self = idtable.add_string("self");
+  SELF_TYPE = idtable.add_string("SELF_TYPE");
+}
+
+//
+// Start compiling method m of class c.  Its formals, if any, have to be
+// bound by the caller.
+//
+void Vm_Compiler::start(Vm_Class *c, Vm_Method *m)
+{
+  cls = c;
+  method = m;
+  top = m->args + 1;
+  m->regs = top;
+  scope.clear();
+}
+
+void Vm_Compiler::error(tree_node *t, const char *msg, Symbol name)
+{
+  cerr << cls->filename << ":" << t->get_line_number() << ": " << msg;
+  if (name)
+    cerr << " " << name;
+  cerr << "." << endl;
+  exit(1);
+}
+
+// The register of a local variable (self, a formal, let or case), or -1.
+int Vm_Compiler::local(Symbol name)
+{
+  for (int i = scope.size() - 1; i >= 0; i--)
+    if (scope[i].name == name)
+      return scope[i].reg;
+  return name == self ? 0 : -1;
+}
+
+// How a local variable is held; an attribute, if there is none.
+Vm_Rep Vm_Compiler::local_rep(Symbol name)
+{
+  for (int i = scope.size() - 1; i >= 0; i--)
+    if (scope[i].name == name)
+      return scope[i].rep;
+  if (name == self)
+    return REP_BOXED;
+  std::unordered_map<Symbol, int>::iterator i = cls->attr_index.find(name);
+  return i == cls->attr_index.end() ? REP_BOXED : attr_rep(i->second);
+}
+
+Vm_Rep Vm_Compiler::attr_rep(int index)
+{
+  return type_rep(cls->attr_types[index]);
+}
+
+static const Vm_Op box_op[] = { OP_MOVE, OP_BOX_INT, OP_BOX_BOOL };
+static const Vm_Op unbox_op[] = { OP_MOVE, OP_UNBOX_INT, OP_UNBOX_BOOL };
+
+//
+// Compile e, with its value held as want.  A constant is boxed by
+// making it an object constant.
+//
+int Vm_Compiler::value(Expression e, int target, Vm_Rep want)
+{
+  enter(e);
+  Vm_Rep have = rep(e);
+  int r;
+
+  if (have == want)
+    r = e->compile(*this, target);
+  else {
+    r = dest(target);
+    int start = here();
+    int v = e->compile(*this, -1);
+    if (want == REP_BOXED && here() == start + 1 &&
+        at(start).op == (const void *) (intptr_t) OP_INT) {
+      int val = at(start).b;
+      method->code.pop_back();
+      method->lines.pop_back();
+      emit(e, OP_CONST, r, have == REP_INT ? int_constant(val) : bool_constant(val));
+    }
+    else if (have == REP_BOXED)
+      emit(e, unbox_op[want], r, v);
+    else if (want == REP_BOXED)
+      emit(e, box_op[have], r, v);
+    else {                      // an Int for a Bool, or a Bool for an Int
+      emit(e, box_op[have], r, v);
+      emit(e, unbox_op[want], r, r);
+    }
+  }
+  leave();
+  return r;
+}
+
+//
+// Compile e for its effect alone.  As its value is not used, it need not
+// be held one way: an if, a block or a let that ends in one leaves each
+// branch's value as it is, rather than boxing them all.
+//
+int Vm_Compiler::effect(Expression e)
+{
+  Expression outer = unused;
+  unused = e;
+  int r = value(e, -1);
+  unused = outer;
+  return r;
+}
+
+int Vm_Compiler::emit(tree_node *t, Vm_Op op, int a, int b, int c)
+{
+  Vm_Insn insn = { (const void *) (intptr_t) op, a, b, c };
+  method->code.push_back(insn);
+  method->lines.push_back(t->get_line_number());
+  return method->code.size() - 1;
+}
+
+static int add_constant(Vm_Object *o)
+{
+  vm.constants.push_back(o);
+  return vm.constants.size() - 1;
+}
+
+int Vm_Compiler::int_constant(int val)
+{
+  std::unordered_map<int, int>::iterator i = int_constants.find(val);
+  if (i != int_constants.end())
+    return i->second;
+  int k = add_constant(vm_int(val));
+  int_constants[val] = k;
+  return k;
+}
+
+int Vm_Compiler::string_constant(Symbol token)
+{
+  std::unordered_map<Symbol, int>::iterator i = string_constants.find(token);
+  if (i != string_constants.end())
+    return i->second;
+  int k = add_constant(vm_string(token->get_string(), token->get_len()));
+  string_constants[token] = k;
+  return k;
+}
+
+int Vm_Compiler::bool_constant(bool b)
+{
+  if (bool_constants[b] < 0)
+    bool_constants[b] = add_constant(b ? vm.true_obj : vm.false_obj);
+  return bool_constants[b];
+}
+
+//
+// The value a variable of the given type starts with: 0, "" or false for
+// the basic types, void for others.  An Int or Bool one is unboxed.
+//
+int Vm_Compiler::default_value(tree_node *t, Symbol type, int target)
+{
+  if (type_rep(type) != REP_BOXED)
+    emit(t, OP_INT, target, 0);
+  else if (type == vm.String->name)
+    emit(t, OP_CONST, target, add_constant(vm.String->proto));
+  else
+    emit(t, OP_VOID, target);
+  return target;
+}
+
+int Vm_Compiler::site(Symbol name, Vm_Rep ret)
+{
+  Vm_Site s = Vm_Site();
+  s.name = name;
+  s.ret = ret;
+  vm.sites.push_back(s);
+  return vm.sites.size() - 1;
+}
+
+int Vm_Compiler::static_method(Vm_Method *m)
+{
+  std::unordered_map<Vm_Method *, int>::iterator i = static_index.find(m);
+  if (i != static_index.end())
+    return i->second;
+  vm.methods.push_back(m);
+  static_index[m] = vm.methods.size() - 1;
+  return vm.methods.size() - 1;
+}
+
+Vm_Class *Vm_Compiler::class_named(tree_node *t, Symbol name)
+{
+  std::unordered_map<Symbol, Vm_Class *>::iterator i = vm.class_named.find(name);
+  if (i == vm.class_named.end())
+    error(t, "Undefined class", name);
+  return i->second;
+}
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  Expressions
+//
+/////////////////////////////////////////////////////////////////////////
+
+// Whether evaluating e cannot change a variable.
+static bool simple(Expression e)
+{
+  return dynamic_cast<object_class *>(e) || dynamic_cast<int_const_class *>(e) ||
+    dynamic_cast<string_const_class *>(e) || dynamic_cast<bool_const_class *>(e);
+}
+
+int assign_class::compile(Vm_Compiler &c, int target)
+{
+  int reg = c.local(name);
+  if (name == c.self)
+    c.error(this, "Cannot assign to 'self'");
+  if (reg >= 0) {
+    c.value(expr, reg, c.local_rep(name));
+    if (target < 0)
+      return reg;
+    c.move(this, target, reg);
+    return target;
+  }
+  std::unordered_map<Symbol, int>::iterator i = c.cls->attr_index.find(name);
+  if (i == c.cls->attr_index.end())
+    c.error(this, "Undefined identifier", name);
+  Vm_Rep r_rep = c.attr_rep(i->second);
+  int r = c.value(expr, target, r_rep);
+  c.emit(this, r_rep == REP_BOXED ? OP_SET_ATTR : OP_SET_RAW, i->second, r);
+  return r;
+}
+
+//
+// The arguments are evaluated into the registers of the call, in order,
+// then the receiver; see vm.h.  They are passed as sig says, or boxed if
+// no method could take them.
+//
+static int call(Vm_Compiler &c, tree_node *t, Expression receiver,
+                Expressions actual, int target, Vm_Op op, int operand,
+                const Vm_Compiler::Signature *sig)
+{
+  int mark = c.top;
+  int base = c.temp();
+  int argc = actual->len();
+
+  for (int i = 0; i < argc; i++)
+    c.temp();
+  for (int i = 0; i < argc; i++) {
+    c.value(actual->nth(i), base + 1 + i, sig ? sig->args[i] : REP_BOXED);
+    c.top = base + 1 + argc;
+  }
+  c.value(receiver, base, REP_BOXED);
+  c.emit(t, op, base, argc, operand);
+  if (target < 0) {
+    c.top = base + 1;
+    return base;
+  }
+  c.move(t, target, base);
+  c.top = mark;
+  return target;
+}
+
+int static_dispatch_class::compile(Vm_Compiler &c, int target)
+{
+  if (type_name == c.SELF_TYPE)
+    c.error(this, "Static dispatch to SELF_TYPE");
+  Vm_Class *k = c.class_named(this, type_name);
+  std::unordered_map<Symbol, Vm_Method *>::iterator i = k->methods.find(name);
+  if (i == k->methods.end())
+    c.error(this, "Undefined method", name);
+  if (i->second->args != actual->len())
+    c.error(this, "Wrong number of arguments to", name);
+  return call(c, this, expr, actual, target, OP_STATIC, c.static_method(i->second),
+              c.signature(name, actual->len()));
+}
+
+int dispatch_class::compile(Vm_Compiler &c, int target)
+{
+  Vm_Rep r_rep = c.rep(this);
+  return call(c, this, expr, actual, target, OP_DISPATCH, c.site(name, r_rep),
+              c.signature(name, actual->len()));
+}
+
+int cond_class::compile(Vm_Compiler &c, int target)
+{
+  bool discarded = c.unused == this;
+  int r = c.dest(target);
+  int mark = c.top;
+  Vm_Rep r_rep = c.rep(this);
+  int p = c.value(pred, -1, REP_BOOL);
+  int to_else = c.emit(this, OP_JUMP_FALSE, p);
+  c.top = mark;
+  if (discarded)
+    c.effect(then_exp);
+  else
+    c.value(then_exp, r, r_rep);
+  c.top = mark;
+  int to_end = c.emit(this, OP_JUMP);
+  c.at(to_else).b = c.here();
+  if (discarded)
+    c.effect(else_exp);
+  else
+    c.value(else_exp, r, r_rep);
+  c.top = mark;
+  c.at(to_end).a = c.here();
+  return r;
+}
+
+int loop_class::compile(Vm_Compiler &c, int target)
+{
+  int r = c.dest(target);
+  int mark = c.top;
+  int start = c.here();
+  int p = c.value(pred, -1, REP_BOOL);
+  int to_end = c.emit(this, OP_JUMP_FALSE, p);
+  c.top = mark;
+  c.effect(body);
+  c.top = mark;
+  c.emit(this, OP_JUMP, start);
+  c.at(to_end).b = c.here();
+  c.emit(this, OP_VOID, r);
+  return r;
+}
+
+//
+// The value being matched goes in a register of its own, which becomes
+// the variable of the branch taken.
+//
+int typcase_class::compile(Vm_Compiler &c, int target)
+{
+  int r = c.dest(target);
+  int mark = c.top;
+  int v = c.temp();
+  Vm_Case table;
+  std::vector<int> to_end;
+
+  c.value(expr, v, REP_BOXED);
+  vm.cases.push_back(table);
+  int index = vm.cases.size() - 1;
+  c.emit(this, OP_CASE, v, index);
+  for (int i = cases->first(); cases->more(i); i = cases->next(i)) {
+    branch_class *b = (branch_class *) cases->nth(i);
+    if (b->get_type_decl() == c.SELF_TYPE)
+      c.error(b, "Case branch of type SELF_TYPE");
+    Vm_Class *k = c.class_named(b, b->get_type_decl());
+    for (size_t j = 0; j < vm.cases[index].branches.size(); j++)
+      if (vm.cases[index].branches[j].first == k)
+        c.error(b, "Duplicate branch in case statement for class", k->name);
+    vm.cases[index].branches.push_back(std::make_pair(k, c.here()));
+    c.bind(b->get_name(), v);
+    c.value(b->get_expr(), r, REP_BOXED);
+    c.unbind();
+    c.top = mark + 1;
+    to_end.push_back(c.emit(b, OP_JUMP));
+  }
+  for (size_t i = 0; i < to_end.size(); i++)
+    c.at(to_end[i]).a = c.here();
+  c.top = mark;
+  return r;
+}
+
+int block_class::compile(Vm_Compiler &c, int target)
+{
+  int mark = c.top;
+  int n = body->len();
+
+  for (int i = 0; i < n - 1; i++) {
+    c.effect(body->nth(i));
+    c.top = mark;
+  }
+  if (c.unused == this)
+    return c.effect(body->nth(n - 1));
+  return c.value(body->nth(n - 1), target);
+}
+
+int let_class::compile(Vm_Compiler &c, int target)
+{
+  if (identifier == c.self)
+    c.error(this, "'self' cannot be bound in a 'let' expression");
+  int r = c.dest(target);
+  int var = c.temp();
+  Vm_Rep var_rep = type_rep(type_decl);
+  if (dynamic_cast<no_expr_class *>(init))
+    c.default_value(this, type_decl, var);
+  else
+    c.value(init, var, var_rep);
+  c.bind(identifier, var, var_rep);
+  if (c.unused == this)
+    c.effect(body);
+  else
+    c.value(body, r);
+  c.unbind();
+  return r;
+}
+
+//
+// The first operand is copied if it is a variable that the second might
+// assign, as in "x + (x <- 1)".
+//
+static int arith(Vm_Compiler &c, tree_node *t, Vm_Op op, Expression e1,
+                 Expression e2, int target, Vm_Rep operands = REP_INT)
+{
+  int r = c.dest(target);
+  int mark = c.top;
+  int a = c.value(e1, -1, operands);
+  if (a < mark && !simple(e2)) {
+    int copy = c.temp();
+    c.move(t, copy, a);
+    a = copy;
+  }
+  int b = c.value(e2, -1, operands);
+  c.emit(t, op, r, a, b);
+  c.top = mark;
+  return r;
+}
+
+int plus_class::compile(Vm_Compiler &c, int target)
+{
+  return arith(c, this, OP_ADD, e1, e2, target);
+}
+
+int sub_class::compile(Vm_Compiler &c, int target)
+{
+  return arith(c, this, OP_SUB, e1, e2, target);
+}
+
+int mul_class::compile(Vm_Compiler &c, int target)
+{
+  return arith(c, this, OP_MUL, e1, e2, target);
+}
+
+int divide_class::compile(Vm_Compiler &c, int target)
+{
+  return arith(c, this, OP_DIV, e1, e2, target);
+}
+
+int lt_class::compile(Vm_Compiler &c, int target)
+{
+  return arith(c, this, OP_LT, e1, e2, target);
+}
+
+//
+// Two Ints or two Bools are compared unboxed; anything else as objects.
+//
+int eq_class::compile(Vm_Compiler &c, int target)
+{
+  Vm_Rep operands = c.rep(e1);
+  if (operands != REP_BOXED && c.rep(e2) == operands)
+    return arith(c, this, OP_SAME, e1, e2, target, operands);
+  return arith(c, this, OP_EQ, e1, e2, target, REP_BOXED);
+}
+
+int leq_class::compile(Vm_Compiler &c, int target)
+{
+  return arith(c, this, OP_LE, e1, e2, target);
+}
+
+static int unary(Vm_Compiler &c, tree_node *t, Vm_Op op, Expression e1,
+                 int target, Vm_Rep operand)
+{
+  int r = c.dest(target);
+  int mark = c.top;
+  c.emit(t, op, r, c.value(e1, -1, operand));
+  c.top = mark;
+  return r;
+}
+
+int neg_class::compile(Vm_Compiler &c, int target)
+{
+  return unary(c, this, OP_NEG, e1, target, REP_INT);
+}
+
+int comp_class::compile(Vm_Compiler &c, int target)
+{
+  return unary(c, this, OP_NOT, e1, target, REP_BOOL);
+}
+
+int isvoid_class::compile(Vm_Compiler &c, int target)
+{
+  return unary(c, this, OP_ISVOID, e1, target, REP_BOXED);
+}
+
+int int_const_class::compile(Vm_Compiler &c, int target)
+{
+  int r = c.dest(target);
+  c.emit(this, OP_INT, r, (int) strtoll(token->get_string(), NULL, 10));
+  return r;
+}
+
+int bool_const_class::compile(Vm_Compiler &c, int target)
+{
+  int r = c.dest(target);
+  c.emit(this, OP_INT, r, val ? 1 : 0);
+  return r;
+}
+
+int string_const_class::compile(Vm_Compiler &c, int target)
+{
+  int r = c.dest(target);
+  c.emit(this, OP_CONST, r, c.string_constant(token));
+  return r;
+}
+
+//
+// The new object is made in a register with nothing live above it,
+// since its init runs with its frame there.
+//
+int new__class::compile(Vm_Compiler &c, int target)
+{
+  int mark = c.top;
+  int base = c.temp();
+
+  if (type_name == c.SELF_TYPE)
+    c.emit(this, OP_NEW_SELF, base);
+  else
+    c.emit(this, OP_NEW, base, c.class_named(this, type_name)->tag);
+  if (target < 0)
+    return base;
+  c.move(this, target, base);
+  c.top = mark;
+  return target;
+}
+
+int no_expr_class::compile(Vm_Compiler &c, int target)
+{
+  int r = c.dest(target);
+  c.emit(this, OP_VOID, r);
+  return r;
+}
+
+int object_class::compile(Vm_Compiler &c, int target)
+{
+  int reg = c.local(name);
+  if (reg >= 0) {
+    if (target < 0)
+      return reg;
+    c.move(this, target, reg);
+    return target;
+  }
+  std::unordered_map<Symbol, int>::iterator i = c.cls->attr_index.find(name);
+  if (i == c.cls->attr_index.end())
+    c.error(this, "Undefined identifier", name);
+  int r = c.dest(target);
+  c.emit(this, OP_ATTR, r, i->second);
+  return r;
+}
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  Classes
+//
+/////////////////////////////////////////////////////////////////////////
+
+struct Class_Source {
+  Class_ tree;
+  Vm_Class *cls;
+  int state;                    // 0 not laid out, 1 under way, 2 done
+};
+
+static Vm_Class *lay_out(Vm_Compiler &c, Class_Source *src,
+                         std::unordered_map<Symbol, Class_Source *> &sources);
+
+//
+// Lay out a class whose parent has been laid out.
+//
+static void lay_out_class(Vm_Compiler &c, Class_ t, Vm_Class *k, Vm_Class *parent)
+{
+  Features features = t->get_features();
+  bool initializers = false;
+
+  k->parent = parent;
+  k->attrs = parent->attrs;
+  k->attr_types = parent->attr_types;
+  k->attr_index = parent->attr_index;
+  k->methods = parent->methods;
+  c.cls = k;
+
+  for (int i = features->first(); features->more(i); i = features->next(i)) {
+    Feature f = features->nth(i);
+    Symbol name = f->get_name();
+
+    if (!f->is_method()) {
+      attr_class *a = (attr_class *) f;
+      if (name == c.self)
+        c.error(f, "'self' cannot be the name of an attribute");
+      if (k->attr_index.count(name))
+        c.error(f, "Attribute redefined:", name);
+      k->attr_index[name] = k->attrs++;
+      k->attr_types.push_back(a->get_type_decl());
+      if (!dynamic_cast<no_expr_class *>(a->get_init()))
+        initializers = true;
+      continue;
+    }
+
+    method_class *m = (method_class *) f;
+    Vm_Method *vm_m = new Vm_Method();
+    vm_m->name = name;
+    vm_m->owner = k;
+    vm_m->args = m->get_formals()->len();
+    std::unordered_map<Symbol, Vm_Method *>::iterator old = k->methods.find(name);
+    if (old != k->methods.end()) {
+      if (old->second->owner == k)
+        c.error(f, "Method redefined:", name);
+      if (old->second->args != vm_m->args)
+        c.error(f, "Wrong number of formals in redefined method", name);
+    }
+    k->methods[name] = vm_m;
+  }
+
+  Vm_Plain *proto = (Vm_Plain *) vm_alloc(vm_plain_size(k->attrs));
+  proto->cls = k;
+  for (int i = 0; i < k->attrs; i++) {
+    Symbol type = k->attr_types[i];
+    if (type_rep(type) != REP_BOXED)
+      proto->attr[i] = vm_unboxed(0);
+    else if (type == vm.String->name)
+      proto->attr[i] = vm.String->proto;
+    else
+      proto->attr[i] = NULL;
+    if (type_rep(type) == REP_BOXED)
+      k->pointers.push_back(i);
+  }
+  k->proto = proto;
+
+  if (initializers) {
+    k->init = new Vm_Method();
+    k->init->name = idtable.add_string("_init");
+    k->init->owner = k;
+  }
+  else
+    k->init = parent->init;
+}
+
+static Vm_Class *lay_out(Vm_Compiler &c, Class_Source *src,
+                         std::unordered_map<Symbol, Class_Source *> &sources)
+{
+  if (src->state == 2)
+    return src->cls;
+  c.cls = src->cls;
+  if (src->state == 1)
+    c.error(src->tree, "Inheritance cycle through class", src->cls->name);
+  src->state = 1;
+
+  Symbol parent = src->tree->get_parent();
+  Vm_Class *p = NULL;
+  if (sources.count(parent))
+    p = lay_out(c, sources[parent], sources);
+  else if (vm.class_named.count(parent))
+    p = vm.class_named[parent];
+  else
+    c.error(src->tree, "Class inherits from an undefined class", parent);
+  if (p->kind != VM_PLAIN)
+    c.error(src->tree, "Class cannot inherit from", parent);
+
+  lay_out_class(c, src->tree, src->cls, p);
+  src->cls->tag = vm.classes.size();
+  vm.classes.push_back(src->cls);
+  src->state = 2;
+  return src->cls;
+}
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  Stack maps
+//
+//  At each instruction that can allocate, and so collect, or call, the
+//  collector has to know which registers hold objects that will be used
+//  again; any other may hold a pointer the collector has since freed.
+//  These are the registers live after the instruction, but for the one
+//  it sets, found by the usual backward data flow.  A call's receiver
+//  and arguments belong to the callee's frame by then.
+//
+//  Of those, the ones that may hold an unboxed Int or Bool are left out.
+//  Which ones may is found by a forward data flow, as a register holds
+//  what the instruction that last set it makes, and a move copies what
+//  its source holds; an argument passed unboxed holds one from the
+//  start.  The compiler never uses a register for both on
+//  two paths that meet.
+//
+/////////////////////////////////////////////////////////////////////////
+
+static Vm_Op op_of(Vm_Insn &insn)
+{
+  return (Vm_Op) (intptr_t) insn.op;
+}
+
+static bool gc_point(Vm_Op op)
+{
+  switch (op) {
+  case OP_NEW: case OP_NEW_SELF: case OP_BOX_INT: case OP_DISPATCH:
+  case OP_STATIC:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// The register insn sets, or -1; the registers it reads go in use.
+static int def_use(Vm_Insn &insn, std::vector<int> &use)
+{
+  use.clear();
+  switch (op_of(insn)) {
+  case OP_MOVE: case OP_NEG: case OP_NOT: case OP_ISVOID: case OP_BOX_INT:
+  case OP_BOX_BOOL: case OP_UNBOX_INT: case OP_UNBOX_BOOL:
+    use.push_back(insn.b);
+    return insn.a;
+  case OP_CONST: case OP_INT: case OP_VOID: case OP_NEW:
+    return insn.a;
+  case OP_ATTR: case OP_NEW_SELF:
+    use.push_back(0);
+    return insn.a;
+  case OP_SET_ATTR: case OP_SET_RAW:
+    use.push_back(0);
+    use.push_back(insn.b);
+    return -1;
+  case OP_ADD: case OP_SUB: case OP_MUL: case OP_DIV: case OP_LT: case OP_LE:
+  case OP_EQ: case OP_SAME:
+    use.push_back(insn.b);
+    use.push_back(insn.c);
+    return insn.a;
+  case OP_DISPATCH: case OP_STATIC:
+    for (int i = 0; i <= insn.b; i++)
+      use.push_back(insn.a + i);
+    return insn.a;
+  case OP_JUMP_FALSE: case OP_CASE: case OP_RETURN:
+    use.push_back(insn.a);
+    return -1;
+  default:
+    return -1;
+  }
+}
+
+//
+// Whether the register insn of m sets then holds an unboxed value, if
+// those in unboxed may.
+//
+static bool sets_unboxed(Vm_Method *m, Vm_Insn &insn, const unsigned long long *unboxed)
+{
+  switch (op_of(insn)) {
+  case OP_MOVE:
+    return unboxed[insn.b / 64] >> (insn.b % 64) & 1;
+  case OP_ATTR:
+    return type_rep(m->owner->attr_types[insn.b]) != REP_BOXED;
+  case OP_INT: case OP_UNBOX_INT: case OP_UNBOX_BOOL: case OP_ADD: case OP_SUB:
+  case OP_MUL: case OP_DIV: case OP_NEG: case OP_LT: case OP_LE: case OP_EQ:
+  case OP_SAME: case OP_NOT: case OP_ISVOID:
+    return true;
+  case OP_DISPATCH:
+    return vm.sites[insn.c].ret != REP_BOXED;
+  case OP_STATIC:
+    return vm.methods[insn.c]->ret_rep != REP_BOXED;
+  default:
+    return false;
+  }
+}
+
+// The instructions that may follow instruction pc of m.
+static void successors(Vm_Method *m, int pc, std::vector<int> &next)
+{
+  Vm_Insn &insn = m->code[pc];
+  int n = m->code.size();
+
+  next.clear();
+  switch (op_of(insn)) {
+  case OP_JUMP:
+    next.push_back(insn.a);
+    break;
+  case OP_JUMP_FALSE:
+    next.push_back(pc + 1);
+    next.push_back(insn.b);
+    break;
+  case OP_CASE:
+    for (size_t i = 0; i < vm.cases[insn.b].branches.size(); i++)
+      next.push_back(vm.cases[insn.b].branches[i].second);
+    break;
+  case OP_RETURN:
+    break;
+  default:
+    if (pc + 1 < n)
+      next.push_back(pc + 1);
+  }
+}
+
+typedef std::vector<unsigned long long> Reg_Set;
+
+// The registers live after instruction pc of m, from those live before
+// each instruction, in live, words to an instruction.  next is scratch.
+static void live_out(Vm_Method *m, int pc, Reg_Set &live, int words, Reg_Set &out,
+                     std::vector<int> &next)
+{
+  successors(m, pc, next);
+  out.assign(words, 0);
+  for (size_t i = 0; i < next.size(); i++)
+    for (int w = 0; w < words; w++)
+      out[w] |= live[next[i] * words + w];
+}
+
+// The first register from on that is in set, if in is true, or not.
+static int next_reg(const Reg_Set &set, int from, bool in)
+{
+  int words = set.size();
+  int w = from / 64;
+  if (w >= words)
+    return words * 64;
+  unsigned long long x = (in ? set[w] : ~set[w]) & (~0ULL << (from % 64));
+  while (x == 0) {
+    if (++w == words)
+      return words * 64;
+    x = in ? set[w] : ~set[w];
+  }
+  return w * 64 + __builtin_ctzll(x);
+}
+
+//
+// The registers that may hold unboxed values before each instruction of
+// m, words to an instruction.
+//
+static void unboxed_in(Vm_Method *m, int words, Reg_Set &unboxed)
+{
+  int n = m->code.size();
+  Reg_Set out;
+  std::vector<int> next, use;
+  bool changed = true;
+
+  unboxed.assign(n * words, 0);
+  for (size_t i = 0; i < m->arg_reps.size(); i++)
+    if (m->arg_reps[i] != REP_BOXED)
+      unboxed[(i + 1) / 64] |= 1ULL << ((i + 1) % 64);
+  while (changed) {
+    changed = false;
+    for (int pc = 0; pc < n; pc++) {
+      out.assign(unboxed.begin() + pc * words, unboxed.begin() + (pc + 1) * words);
+      int def = def_use(m->code[pc], use);
+      if (def >= 0) {
+        if (sets_unboxed(m, m->code[pc], &unboxed[pc * words]))
+          out[def / 64] |= 1ULL << (def % 64);
+        else
+          out[def / 64] &= ~(1ULL << (def % 64));
+      }
+      successors(m, pc, next);
+      for (size_t i = 0; i < next.size(); i++)
+        for (int w = 0; w < words; w++) {
+          unsigned long long &in = unboxed[next[i] * words + w];
+          if ((in | out[w]) != in) {
+            in |= out[w];
+            changed = true;
+          }
+        }
+    }
+  }
+}
+
+//
+// A map is a list of runs of registers, each its first register and how
+// many there are, so that the arguments gathered for a call, which are
+// consecutive, take one run however many there are.  It is made from
+// the bit sets a word at a time.
+//
+static void stack_maps(Vm_Method *m)
+{
+  int n = m->code.size();
+  int words = (m->regs + 63) / 64;
+  Reg_Set live(n * words), out, in, unboxed;
+  std::vector<int> use, next;
+  bool changed = true;
+
+  while (changed) {
+    changed = false;
+    for (int pc = n - 1; pc >= 0; pc--) {
+      live_out(m, pc, live, words, out, next);
+      in = out;
+      int def = def_use(m->code[pc], use);
+      if (def >= 0)
+        in[def / 64] &= ~(1ULL << (def % 64));
+      for (size_t i = 0; i < use.size(); i++)
+        in[use[i] / 64] |= 1ULL << (use[i] % 64);
+      if (!std::equal(in.begin(), in.end(), live.begin() + pc * words)) {
+        std::copy(in.begin(), in.end(), live.begin() + pc * words);
+        changed = true;
+      }
+    }
+  }
+
+  unboxed_in(m, words, unboxed);
+  m->map_start.assign(n, -1);
+  for (int pc = 0; pc < n; pc++) {
+    if (!gc_point(op_of(m->code[pc])))
+      continue;
+    live_out(m, pc, live, words, out, next);
+    int def = def_use(m->code[pc], use);
+    if (def >= 0)
+      out[def / 64] &= ~(1ULL << (def % 64));
+    for (int w = 0; w < words; w++)
+      out[w] &= ~unboxed[pc * words + w];
+    m->map_start[pc] = m->maps.size();
+    for (int r = next_reg(out, 0, true); r < words * 64; ) {
+      int end = next_reg(out, r, false);
+      m->maps.push_back(r);
+      m->maps.push_back(end - r);
+      r = next_reg(out, end, true);
+    }
+    m->maps.push_back(-1);
+  }
+}
+
+static void compile_init(Vm_Compiler &c, Class_ t, Vm_Class *k)
+{
+  Features features = t->get_features();
+
+  c.start(k, k->init);
+  if (k->parent->init) {
+    int base = c.temp();
+    c.move(t, base, 0);
+    c.emit(t, OP_STATIC, base, 0, c.static_method(k->parent->init));
+    c.top = base;
+  }
+  for (int i = features->first(); features->more(i); i = features->next(i)) {
+    Feature f = features->nth(i);
+    if (f->is_method())
+      continue;
+    attr_class *a = (attr_class *) f;
+    if (dynamic_cast<no_expr_class *>(a->get_init()))
+      continue;
+    int index = k->attr_index[a->get_name()];
+    Vm_Rep r_rep = type_rep(a->get_type_decl());
+    int r = c.value(a->get_init(), -1, r_rep);
+    c.emit(f, r_rep == REP_BOXED ? OP_SET_ATTR : OP_SET_RAW, index, r);
+    c.top = 1;
+  }
+  c.emit(t, OP_RETURN, 0);
+  stack_maps(k->init);
+}
+
+static void compile_method(Vm_Compiler &c, Vm_Class *k, method_class *m)
+{
+  Formals formals = m->get_formals();
+  Vm_Method *vm_m = k->methods[m->get_name()];
+
+  c.start(k, vm_m);
+  for (int i = formals->first(); formals->more(i); i = formals->next(i)) {
+    formal_class *f = (formal_class *) formals->nth(i);
+    Vm_Rep f_rep = type_rep(f->get_type_decl());
+    if (f->get_name() == c.self)
+      c.error(m, "'self' cannot be the name of a formal parameter");
+    if (f_rep == vm_m->arg_reps[i])
+      c.bind(f->get_name(), i + 1, f_rep);
+    else {
+      int var = c.temp();
+      c.emit(f, unbox_op[f_rep], var, i + 1);
+      c.bind(f->get_name(), var, f_rep);
+    }
+  }
+  c.emit(m, OP_RETURN, c.value(m->get_expr(), -1, vm_m->ret_rep));
+  stack_maps(vm_m);
+}
+
+void vm_compile(Program p)
+{
+  Classes classes = p->get_classes();
+  std::unordered_map<Symbol, Class_Source *> sources;
+  std::vector<Class_Source> order(classes->len());
+  Vm_Compiler c;
+
+  vm_basic_classes();
+  c.cls = vm.Object;
+
+  for (int i = classes->first(); classes->more(i); i = classes->next(i)) {
+    Class_ t = classes->nth(i);
+    Vm_Class *k = new Vm_Class();
+    k->name = t->get_name();
+    k->kind = VM_PLAIN;
+    k->filename = t->get_filename();
+    c.cls = k;
+    if (k->name == c.SELF_TYPE || vm.class_named.count(k->name))
+      c.error(t, "Redefinition of basic class", k->name);
+    if (sources.count(k->name))
+      c.error(t, "Class was previously defined:", k->name);
+    order[i].tree = t;
+    order[i].cls = k;
+    order[i].state = 0;
+    sources[k->name] = &order[i];
+  }
+  for (size_t i = 0; i < order.size(); i++)
+    lay_out(c, &order[i], sources);
+  for (size_t i = 0; i < order.size(); i++) {
+    Vm_Class *k = order[i].cls;
+    vm.class_named[k->name] = k;
+    k->type_name = vm_string(k->name->get_string(), k->name->get_len());
+  }
+
+  // Before any method is compiled, which may take a while.
+  Symbol Main = idtable.add_string("Main");
+  Symbol main = idtable.add_string("main");
+  if (!sources.count(Main)) {
+    cerr << "Class Main is not defined." << endl;
+    exit(1);
+  }
+  Vm_Class *main_class = sources[Main]->cls;
+  if (!main_class->methods.count(main)) {
+    cerr << "No 'main' method in class Main." << endl;
+    exit(1);
+  }
+
+  // The signatures, from the built-in methods and the program's.
+  for (size_t i = 0; i < vm.classes.size(); i++) {
+    Vm_Class *k = vm.classes[i];
+    for (std::unordered_map<Symbol, Vm_Method *>::iterator j = k->methods.begin();
+         j != k->methods.end(); j++)
+      if (j->second->owner == k && j->second->builtin)
+        c.declare(j->first, std::vector<Vm_Rep>(j->second->args, REP_BOXED), REP_BOXED);
+  }
+  for (size_t i = 0; i < order.size(); i++) {
+    Features features = order[i].tree->get_features();
+    for (int j = features->first(); features->more(j); j = features->next(j)) {
+      if (!features->nth(j)->is_method())
+        continue;
+      method_class *m = (method_class *) features->nth(j);
+      Formals formals = m->get_formals();
+      std::vector<Vm_Rep> args;
+      for (int f = formals->first(); formals->more(f); f = formals->next(f))
+        args.push_back(type_rep(((formal_class *) formals->nth(f))->get_type_decl()));
+      c.declare(m->get_name(), args, type_rep(m->get_return_type()));
+    }
+  }
+  for (size_t i = 0; i < order.size(); i++) {
+    Vm_Class *k = order[i].cls;
+    for (std::unordered_map<Symbol, Vm_Method *>::iterator j = k->methods.begin();
+         j != k->methods.end(); j++)
+      if (j->second->owner == k) {
+        const Vm_Compiler::Signature *sig = c.signature(j->first, j->second->args);
+        j->second->arg_reps = sig->args;
+        j->second->ret_rep = sig->ret;
+      }
+  }
+
+  for (size_t i = 0; i < order.size(); i++) {
+    Class_ t = order[i].tree;
+    Vm_Class *k = order[i].cls;
+    Features features = t->get_features();
+    if (k->init && k->init->owner == k)
+      compile_init(c, t, k);
+    for (int j = features->first(); features->more(j); j = features->next(j))
+      if (features->nth(j)->is_method())
+        compile_method(c, k, (method_class *) features->nth(j));
+  }
+
+  // (new Main).main(), with self void.
+  vm.start = new Vm_Method();
+  vm.start->name = idtable.add_string("_start");
+  vm.start->owner = main_class;
+  c.start(main_class, vm.start);
+  int base = c.temp();
+  c.emit(p, OP_NEW, base, main_class->tag);
+  const Vm_Compiler::Signature *sig = c.signature(main, 0);
+  c.emit(p, OP_DISPATCH, base, 0, c.site(main, sig ? sig->ret : REP_BOXED));
+  c.emit(p, OP_RETURN, base);
+  stack_maps(vm.start);
+}
@@ -0,0 +1,417 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//
+// vm-exec.cc
+//
+//  The interpreter of -run.  The code of each method is threaded before
+//  it runs: the operation of each instruction is replaced by the address
+//  of the code that does it, and each operation ends by jumping straight
+//  to the next one's (GCC's computed goto).
+//
+//  Calls do not recurse in C++.  The registers of all calls are windows
+//  on one stack (see vm.h), and what a return needs, the caller's method,
+//  instruction and registers, is kept on a stack of frames of its own,
+//  so a Cool program can recurse as deeply as those stacks allow.
+//
+//  A dispatch looks first in the inline cache of its site (vm.h), which
+//  on a miss is filled from the method table of the receiver's class.
+//  An @Type dispatch was bound to its method by the compiler.
+//
+//  The interpreter is compiled twice, with and without counting the
+//  instructions, calls and cache hits of -P, so that the usual run pays
+//  nothing for them.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
+#include <string>
+#include "cool-io.h"
+#include "stringtab.h"
+#include "parse-stats.h"
+#include "vm.h"
+
+#define VM_STACK_REGS (1 << 24)
+#define VM_STACK_FRAMES (1 << 20)
+
+static void vm_error(Vm_Method *m, Vm_Insn *pc, const std::string &msg)
+{
+  vm_error(m, pc - &m->code[0], msg.c_str());
+}
+
+//
+// The method of site s for a receiver of class k, when k is not that of
+// its monomorphic entry: from a polymorphic entry, or looked up and
+// cached.  NULL if k has no such method.
+//
+template <bool counting>
+static Vm_Method *site_miss(Vm_Site *s, Vm_Class *k)
+{
+  for (int i = 0; i < s->entries; i++)
+    if (s->poly_cls[i] == k) {
+      if (counting)
+        parse_stats.vm_poly_hits++;
+      return s->poly_method[i];
+    }
+  if (counting)
+    parse_stats.vm_cache_misses++;
+
+  std::unordered_map<Symbol, Vm_Method *>::iterator i = k->methods.find(s->name);
+  if (i == k->methods.end())
+    return NULL;
+  if (s->cls == NULL) {
+    s->cls = k;
+    s->method = i->second;
+  }
+  else if (s->entries < VM_POLY) {
+    if (counting && s->entries == 0)
+      parse_stats.vm_poly_sites++;
+    s->poly_cls[s->entries] = k;
+    s->poly_method[s->entries] = i->second;
+    s->entries++;
+  }
+  else if (!s->megamorphic) {
+    if (counting)
+      parse_stats.vm_mega_sites++;
+    s->megamorphic = true;
+  }
+  return i->second;
+}
+
+//
+// Run the program, or, if labels is not NULL, just tell where the code
+// of each operation is.
+//
+template <bool counting>
+static void execute(const void ***labels)
+{
+  static const void *code[VM_OPS] = {
+    &&op_move, &&op_const, &&op_int, &&op_void, &&op_attr, &&op_set_attr,
+    &&op_set_raw, &&op_new, &&op_new_self, &&op_box_int, &&op_box_bool,
+    &&op_unbox_int, &&op_unbox_bool, &&op_add, &&op_sub, &&op_mul, &&op_div,
+    &&op_neg, &&op_lt, &&op_le, &&op_eq, &&op_same, &&op_not, &&op_isvoid,
+    &&op_jump, &&op_jump_false, &&op_dispatch, &&op_static, &&op_case,
+    &&op_return,
+  };
+  if (labels) {
+    *labels = code;
+    return;
+  }
+
+  Vm_Object **stack = (Vm_Object **) calloc(VM_STACK_REGS, sizeof(Vm_Object *));
+  Vm_Frame *frames = (Vm_Frame *) malloc(VM_STACK_FRAMES * sizeof(Vm_Frame));
+  if (stack == NULL || frames == NULL)
+    vm_error("out of memory");
+  Vm_Object **stack_end = stack + VM_STACK_REGS;
+  Vm_Frame *frames_end = frames + VM_STACK_FRAMES;
+  Vm_Object **constants = &vm.constants[0];
+  Vm_Site *sites = &vm.sites[0];
+  Vm_Object *true_obj = vm.true_obj;
+  Vm_Object *false_obj = vm.false_obj;
+
+  Vm_Method *m = vm.start;
+  Vm_Object **regs = stack;
+  Vm_Insn *pc = &m->code[0];
+  Vm_Frame *fp = frames;
+  Vm_Method *callee;
+  Vm_Object **base;
+
+  vm_roots.frames = frames;
+
+#define NEXT do { if (counting) parse_stats.vm_insns++; goto *pc->op; } while (0)
+#define A (pc->a)
+#define B (pc->b)
+#define C (pc->c)
+#define INT(r) vm_unboxed_val(regs[r])
+#define SET_INT(r, v) (regs[r] = vm_unboxed(v))
+
+// Where the collector is to find the roots, before anything allocates.
+#define SAVE do { vm_roots.method = m; vm_roots.pc = pc; vm_roots.regs = regs; \
+                  vm_roots.fp = fp; } while (0)
+
+  NEXT;
+
+op_move:
+  regs[A] = regs[B];
+  pc++;
+  NEXT;
+
+op_const:
+  regs[A] = constants[B];
+  pc++;
+  NEXT;
+
+op_int:
+  SET_INT(A, B);
+  pc++;
+  NEXT;
+
+op_void:
+  regs[A] = NULL;
+  pc++;
+  NEXT;
+
+op_attr:
+  regs[A] = ((Vm_Plain *) regs[0])->attr[B];
+  pc++;
+  NEXT;
+
+op_set_attr:
+  ((Vm_Plain *) regs[0])->attr[A] = regs[B];
+  vm_stored(regs[0], regs[B]);
+  pc++;
+  NEXT;
+
+op_set_raw:
+  ((Vm_Plain *) regs[0])->attr[A] = regs[B];
+  pc++;
+  NEXT;
+
+op_new: {
+  Vm_Class *k = vm.classes[B];
+  base = regs + A;
+  SAVE;
+  base[0] = vm_new(k);
+  callee = k->init;
+  if (callee)
+    goto call;
+  pc++;
+  NEXT;
+}
+
+op_new_self: {
+  Vm_Class *k = regs[0]->cls;
+  base = regs + A;
+  SAVE;
+  base[0] = vm_new(k);
+  callee = k->init;
+  if (callee)
+    goto call;
+  pc++;
+  NEXT;
+}
+
+op_box_int: {
+  int val = INT(B);
+  SAVE;
+  regs[A] = vm_int(val);
+  pc++;
+  NEXT;
+}
+
+op_box_bool:
+  regs[A] = INT(B) ? true_obj : false_obj;
+  pc++;
+  NEXT;
+
+op_unbox_int:
+  if (regs[B] == NULL || regs[B]->cls != vm.Int)
+    vm_error(m, pc, "Int operands expected.");
+  SET_INT(A, ((Vm_Int *) regs[B])->val);
+  pc++;
+  NEXT;
+
+op_unbox_bool:
+  if (regs[B] == NULL || regs[B]->cls != vm.Bool)
+    vm_error(m, pc, "Bool operand expected.");
+  SET_INT(A, ((Vm_Int *) regs[B])->val);
+  pc++;
+  NEXT;
+
+op_add:
+  SET_INT(A, (int) ((unsigned) INT(B) + (unsigned) INT(C)));
+  pc++;
+  NEXT;
+
+op_sub:
+  SET_INT(A, (int) ((unsigned) INT(B) - (unsigned) INT(C)));
+  pc++;
+  NEXT;
+
+op_mul:
+  SET_INT(A, (int) ((unsigned) INT(B) * (unsigned) INT(C)));
+  pc++;
+  NEXT;
+
+op_div: {
+  int x = INT(B), y = INT(C);
+  if (y == 0)
+    vm_error(m, pc, "Division by zero.");
+  SET_INT(A, y == -1 ? (int) (0u - (unsigned) x) : x / y);
+  pc++;
+  NEXT;
+}
+
+op_neg:
+  SET_INT(A, (int) (0u - (unsigned) INT(B)));
+  pc++;
+  NEXT;
+
+op_lt:
+  SET_INT(A, INT(B) < INT(C));
+  pc++;
+  NEXT;
+
+op_le:
+  SET_INT(A, INT(B) <= INT(C));
+  pc++;
+  NEXT;
+
+op_eq:
+  SET_INT(A, vm_equal(regs[B], regs[C]));
+  pc++;
+  NEXT;
+
+op_same:
+  SET_INT(A, INT(B) == INT(C));
+  pc++;
+  NEXT;
+
+op_not:
+  SET_INT(A, !INT(B));
+  pc++;
+  NEXT;
+
+op_isvoid:
+  SET_INT(A, regs[B] == NULL);
+  pc++;
+  NEXT;
+
+op_jump:
+  pc = &m->code[A];
+  NEXT;
+
+op_jump_false:
+  if (INT(A))
+    pc++;
+  else
+    pc = &m->code[B];
+  NEXT;
+
+op_dispatch: {
+  base = regs + A;
+  if (base[0] == NULL)
+    vm_error(m, pc, "Dispatch to void.");
+  Vm_Site *site = sites + C;
+  if (base[0]->cls == site->cls) {
+    if (counting)
+      parse_stats.vm_cache_hits++;
+    callee = site->method;
+    goto call;
+  }
+  callee = site_miss<counting>(site, base[0]->cls);
+  if (callee == NULL)
+    vm_error(m, pc, std::string("Undefined method ") + site->name->get_string() +
+             " in class " + base[0]->cls->name->get_string() + ".");
+  if (callee->args != B)
+    vm_error(m, pc, std::string("Wrong number of arguments to ") +
+             site->name->get_string() + ".");
+  goto call;
+}
+
+op_static:
+  base = regs + A;
+  if (base[0] == NULL)
+    vm_error(m, pc, "Dispatch to void.");
+  callee = vm.methods[C];
+  goto call;
+
+op_case: {
+  Vm_Object *o = regs[A];
+  if (o == NULL)
+    vm_error(m, pc, "Match on void in case statement.");
+  std::vector<std::pair<Vm_Class *, int> > &branches = vm.cases[B].branches;
+  for (Vm_Class *k = o->cls; k; k = k->parent)
+    for (size_t i = 0; i < branches.size(); i++)
+      if (branches[i].first == k) {
+        pc = &m->code[branches[i].second];
+        NEXT;
+      }
+  vm_error(m, pc, std::string("No match in case statement for Class ") +
+           o->cls->name->get_string() + ".");
+}
+
+op_return:
+  regs[0] = regs[A];
+  if (fp == frames) {
+    free(stack);
+    free(frames);
+    return;
+  }
+  fp--;
+  m = fp->method;
+  pc = fp->ret;
+  regs = fp->regs;
+  NEXT;
+
+  // Call callee with its registers at base.
+call:
+  if (counting)
+    parse_stats.vm_calls++;
+  if (callee->builtin) {
+    SAVE;
+    vm_roots.args = base;
+    vm_roots.argc = callee->args;
+    base[0] = callee->builtin(base);
+    vm_roots.args = NULL;
+    pc++;
+    NEXT;
+  }
+  if (base + callee->regs > stack_end || fp == frames_end)
+    vm_error(m, pc, "Stack overflow.");
+  fp->method = m;
+  fp->ret = pc + 1;
+  fp->regs = regs;
+  fp++;
+  m = callee;
+  regs = base;
+  pc = &m->code[0];
+  NEXT;
+
+#undef NEXT
+#undef A
+#undef B
+#undef C
+#undef INT
+#undef SET_INT
+#undef SAVE
+}
+
+static void thread(Vm_Method *m, const void **labels)
+{
+  for (size_t i = 0; i < m->code.size(); i++)
+    m->code[i].op = labels[(intptr_t) m->code[i].op];
+}
+
+int vm_run(Program p)
+{
+  void (*run)(const void ***) = report_stats ? execute<true> : execute<false>;
+  const void **labels;
+
+  STATS_BEGIN(PHASE_COMPILE);
+  vm_compile(p);
+  run(&labels);
+  for (size_t i = 0; i < vm.classes.size(); i++) {
+    Vm_Class *k = vm.classes[i];
+    if (k->init && k->init->owner == k)
+      thread(k->init, labels);
+    for (std::unordered_map<Symbol, Vm_Method *>::iterator j = k->methods.begin();
+         j != k->methods.end(); j++)
+      if (j->second->owner == k && !j->second->builtin)
+        thread(j->second, labels);
+  }
+  thread(vm.start, labels);
+  vm_gc_start();
+  if (vm.constants.empty())
+    vm.constants.push_back(NULL);
+
+  STATS_BEGIN(PHASE_RUN);
+  run(NULL);
+  fflush(stdout);
+  return 0;
+}
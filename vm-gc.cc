@@ -0,0 +1,356 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//
+// vm-gc.cc
+//
+//  The heap of -run: a nursery and an old generation of two semi-spaces,
+//  both collected by copying (Cheney's algorithm); see vm.h.
+//
+//  A minor collection promotes every object in the nursery that is
+//  still reachable, from the roots or from a remembered old object, to
+//  the old generation, and leaves the nursery empty.  Once the old
+//  generation has no room for another nursery's worth, a major
+//  collection copies what is reachable from the roots into a new
+//  semi-space, twice the size of what the heap held, so that the time
+//  spent copying stays in proportion to what is allocated.  Strings too
+//  big for the nursery are made in the old generation directly.
+//
+//  The modes of the SPIM runtime's collector are kept: with -t
+//  (GC_TEST) every allocation collects, and with -T (GC_DEBUG) the heap
+//  is checked after each collection and the space objects were copied
+//  out of is filled with garbage, so that a missing root shows up soon.
+//  Before the program starts, objects are made in chunks that are never
+//  collected.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "cool-io.h"
+#include "handle_flags.h"
+#include "parse-stats.h"
+#include "vm.h"
+
+#define VM_NURSERY (2 << 20)
+#define VM_CHUNK (1 << 20)
+#define VM_MAJOR_EVERY 64       // with -t, each 64th collection is major
+#define VM_GARBAGE 0xdb
+
+Vm_Roots vm_roots;
+char *vm_alloc_next, *vm_alloc_limit;
+char *vm_nursery, *vm_nursery_end;
+
+static bool started;            // by vm_gc_start
+
+struct Space {
+  char *start, *next, *end;
+  size_t used() { return next - start; }
+  size_t room() { return end - next; }
+  bool holds(Vm_Object *o) { return (size_t) ((char *) o - start) < used(); }
+};
+
+static Space old;
+static unsigned char *remembered;       // a bit for each 8 bytes of old
+static std::vector<Vm_Object *> remembered_set;
+static long long collections;
+
+static void *alloc_or_die(size_t size)
+{
+  void *p = malloc(size);
+  if (p == NULL)
+    vm_error("out of memory");
+  return p;
+}
+
+static size_t object_size(Vm_Object *o)
+{
+  switch (o->cls->kind) {
+  case VM_PLAIN:
+    return vm_plain_size(o->cls->attrs);
+  case VM_STRING:
+    return (sizeof(Vm_String) + ((Vm_String *) o)->len + 7) & ~(size_t) 7;
+  default:
+    return sizeof(Vm_Int);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  Copying
+//
+//  A copied object's class is replaced by its new address, with the low
+//  bit set.
+//
+/////////////////////////////////////////////////////////////////////////
+
+static inline bool forwarded(Vm_Object *o)
+{
+  return (uintptr_t) o->cls & 1;
+}
+
+static inline Vm_Object *forwarding(Vm_Object *o)
+{
+  return (Vm_Object *) ((uintptr_t) o->cls & ~(uintptr_t) 1);
+}
+
+// Copy o to the end of space to, once.
+static Vm_Object *evacuate(Vm_Object *o, Space *to)
+{
+  if (forwarded(o))
+    return forwarding(o);
+  size_t size = object_size(o);
+  Vm_Object *copy = (Vm_Object *) to->next;
+  memcpy(copy, o, size);
+  to->next += size;
+  o->cls = (Vm_Class *) ((uintptr_t) copy | 1);
+  return copy;
+}
+
+//
+// A collection: the objects in from (the nursery, and the old
+// generation of a major collection) are copied to the end of to.
+//
+struct Collection {
+  Space *to;
+  Space *from_old;              // or NULL
+
+  bool moves(Vm_Object *o)
+  {
+    return vm_young(o) || (from_old && from_old->holds(o));
+  }
+  void forward(Vm_Object **slot)
+  {
+    if (moves(*slot))
+      *slot = evacuate(*slot, to);
+  }
+  void fields(Vm_Object *o)
+  {
+    if (o->cls->kind != VM_PLAIN)
+      return;
+    Vm_Plain *p = (Vm_Plain *) o;
+    const std::vector<int> &pointers = o->cls->pointers;
+    for (size_t i = 0; i < pointers.size(); i++)
+      forward(&p->attr[pointers[i]]);
+  }
+  void roots();
+  void scan(char *from);
+};
+
+// The live registers of a frame stopped at pc.
+template <class Visit>
+static void frame_roots(Vm_Method *m, Vm_Insn *pc, Vm_Object **regs, Visit &visit)
+{
+  int start = m->map_start[pc - &m->code[0]];
+  for (const int *r = &m->maps[start]; *r >= 0; r += 2)
+    for (int i = 0; i < r[1]; i++)
+      visit(&regs[r[0] + i]);
+}
+
+template <class Visit>
+static void each_root(Visit &visit)
+{
+  for (Vm_Frame *f = vm_roots.frames; f < vm_roots.fp; f++)
+    frame_roots(f->method, f->ret - 1, f->regs, visit);
+  frame_roots(vm_roots.method, vm_roots.pc, vm_roots.regs, visit);
+  if (vm_roots.args)
+    for (int i = 0; i <= vm_roots.argc; i++)
+      visit(&vm_roots.args[i]);
+}
+
+struct Forward_Root {
+  Collection *c;
+  void operator()(Vm_Object **slot) { c->forward(slot); }
+};
+
+void Collection::roots()
+{
+  Forward_Root visit = { this };
+  each_root(visit);
+}
+
+// Copy what the objects copied from from on refer to, and so on.
+void Collection::scan(char *from)
+{
+  while (from < to->next) {
+    Vm_Object *o = (Vm_Object *) from;
+    fields(o);
+    from += object_size(o);
+  }
+}
+
+static void clear_remembered()
+{
+  for (size_t i = 0; i < remembered_set.size(); i++) {
+    size_t bit = ((char *) remembered_set[i] - old.start) >> 3;
+    remembered[bit >> 3] &= ~(1 << (bit & 7));
+  }
+  remembered_set.clear();
+}
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  Checking the heap, for -T
+//
+/////////////////////////////////////////////////////////////////////////
+
+static void check_object(Vm_Object *o, const char *where);
+
+static void check_pointer(Vm_Object *o, const char *where)
+{
+  if (o == NULL)
+    return;
+  if (vm_young(o) || ((uintptr_t) o & 7))
+    vm_error((std::string("GC check: bad pointer in ") + where).c_str());
+  if (forwarded(o))
+    vm_error((std::string("GC check: pointer to a copied object in ") + where).c_str());
+  Vm_Class *k = o->cls;
+  if (k == NULL || k->tag < 0 || k->tag >= (int) vm.classes.size() ||
+      vm.classes[k->tag] != k)
+    vm_error((std::string("GC check: object with no class in ") + where).c_str());
+}
+
+static void check_object(Vm_Object *o, const char *where)
+{
+  check_pointer(o, where);
+  if (o->cls->kind == VM_PLAIN)
+    for (size_t i = 0; i < o->cls->pointers.size(); i++)
+      check_pointer(((Vm_Plain *) o)->attr[o->cls->pointers[i]], "an attribute");
+}
+
+struct Check_Root {
+  void operator()(Vm_Object **slot) { check_pointer(*slot, "a register"); }
+};
+
+static void check_heap()
+{
+  Check_Root visit;
+  each_root(visit);
+  for (char *p = old.start; p < old.next; p += object_size((Vm_Object *) p))
+    check_object((Vm_Object *) p, "the old generation");
+  if (!remembered_set.empty())
+    vm_error("GC check: remembered objects left over");
+}
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  Collections
+//
+/////////////////////////////////////////////////////////////////////////
+
+static void new_old_space(size_t size)
+{
+  old.start = old.next = (char *) alloc_or_die(size);
+  old.end = old.start + size;
+  free(remembered);
+  remembered = (unsigned char *) calloc(size / 64 + 1, 1);
+  if (remembered == NULL)
+    vm_error("out of memory");
+}
+
+static void minor()
+{
+  Collection c = { &old, NULL };
+  char *promoted = old.next;
+
+  parse_stats.vm_minor_gcs++;
+  c.roots();
+  for (size_t i = 0; i < remembered_set.size(); i++)
+    c.fields(remembered_set[i]);
+  clear_remembered();
+  c.scan(promoted);
+  parse_stats.vm_promoted += old.next - promoted;
+}
+
+//
+// Room is made for at least extra bytes more in the old generation.
+//
+static void major(size_t extra)
+{
+  Space from = old;
+  size_t young = vm_alloc_next - vm_nursery;
+
+  parse_stats.vm_major_gcs++;
+  clear_remembered();
+  new_old_space(2 * (from.used() + young) + 2 * VM_NURSERY + extra);
+  Collection c = { &old, &from };
+  c.roots();
+  c.scan(old.start);
+  if (cgen_Memmgr_Debug == GC_DEBUG)
+    memset(from.start, VM_GARBAGE, from.used());
+  free(from.start);
+}
+
+static void collect(size_t extra)
+{
+  STATS_BEGIN(PHASE_GC);
+  collections++;
+  if (old.room() < (size_t) (vm_alloc_next - vm_nursery) + extra ||
+      (cgen_Memmgr_Test == GC_TEST && collections % VM_MAJOR_EVERY == 0))
+    major(extra);
+  else
+    minor();
+  if (cgen_Memmgr_Debug == GC_DEBUG) {
+    memset(vm_nursery, VM_GARBAGE, vm_nursery_end - vm_nursery);
+    check_heap();
+  }
+  vm_alloc_next = vm_nursery;
+  STATS_BEGIN(PHASE_RUN);
+}
+
+void vm_remember(Vm_Object *o)
+{
+  if (!old.holds(o))            // made before the program started
+    return;
+  size_t bit = ((char *) o - old.start) >> 3;
+  if (remembered[bit >> 3] & (1 << (bit & 7)))
+    return;
+  remembered[bit >> 3] |= 1 << (bit & 7);
+  remembered_set.push_back(o);
+}
+
+void *vm_alloc_slow(size_t size)
+{
+  void *p;
+
+  if (!started) {               // a chunk that is never collected
+    if ((size_t) (vm_alloc_limit - vm_alloc_next) < size) {
+      size_t chunk = size > VM_CHUNK ? size : VM_CHUNK;
+      vm_alloc_next = (char *) alloc_or_die(chunk);
+      vm_alloc_limit = vm_alloc_next + chunk;
+    }
+    p = vm_alloc_next;
+    vm_alloc_next += size;
+    return p;
+  }
+
+  if (size > VM_NURSERY / 4) {  // too big for the nursery
+    if (old.room() < size)
+      collect(size);
+    p = old.next;
+    old.next += size;
+    memset(p, 0, size);
+    vm_remember((Vm_Object *) p);
+    return p;
+  }
+
+  collect(0);
+  p = vm_alloc_next;
+  vm_alloc_next += size;
+  vm_alloc_limit = cgen_Memmgr_Test == GC_TEST ? vm_alloc_next : vm_nursery_end;
+  return p;
+}
+
+void vm_gc_start()
+{
+  vm_nursery = (char *) alloc_or_die(VM_NURSERY);
+  vm_nursery_end = vm_nursery + VM_NURSERY;
+  vm_alloc_next = vm_nursery;
+  vm_alloc_limit = cgen_Memmgr_Test == GC_TEST ? vm_nursery : vm_nursery_end;
+  new_old_space(4 * VM_NURSERY);
+  started = true;
+}
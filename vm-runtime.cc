@@ -0,0 +1,325 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//
+// vm-runtime.cc
+//
+//  The runtime of -run: the classes every Cool program has (Object, IO,
+//  Int, Bool and String) and their methods, making objects, and runtime
+//  errors.  The heap they are made in is that of vm-gc.cc.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cool-io.h"
+#include "stringtab.h"
+#include "parse-stats.h"
+#include "vm.h"
+
+Vm_Program vm;
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  Objects
+//
+/////////////////////////////////////////////////////////////////////////
+
+//
+// A new object of class c: a copy of its prototype, whose attributes
+// have their default values.  Ints, Bools and strings cannot change, so
+// a new one is the prototype itself.
+//
+Vm_Object *vm_new(Vm_Class *c)
+{
+  if (c->kind != VM_PLAIN)
+    return c->proto;
+  size_t size = vm_plain_size(c->attrs);
+  Vm_Object *o = (Vm_Object *) vm_alloc(size);
+  memcpy(o, c->proto, size);
+  return o;
+}
+
+Vm_Int *vm_int(int val)
+{
+  Vm_Int *i = (Vm_Int *) vm_alloc(sizeof(Vm_Int));
+  i->cls = vm.Int;
+  i->val = val;
+  return i;
+}
+
+// A new string of len characters, s if it is not NULL.
+Vm_String *vm_string(const char *s, int len)
+{
+  Vm_String *str = (Vm_String *) vm_alloc(sizeof(Vm_String) + len);
+  str->cls = vm.String;
+  str->len = len;
+  if (s)
+    memcpy(str->chars, s, len);
+  str->chars[len] = '\0';
+  return str;
+}
+
+//
+// Cool's =: the same object, or Ints, Bools or strings of equal value.
+//
+bool vm_equal(Vm_Object *x, Vm_Object *y)
+{
+  if (x == y)
+    return true;
+  if (x == NULL || y == NULL || x->cls != y->cls)
+    return false;
+  switch (x->cls->kind) {
+  case VM_INT:
+  case VM_BOOL:
+    return ((Vm_Int *) x)->val == ((Vm_Int *) y)->val;
+  case VM_STRING:
+    return ((Vm_String *) x)->len == ((Vm_String *) y)->len &&
+      memcmp(((Vm_String *) x)->chars, ((Vm_String *) y)->chars,
+             ((Vm_String *) x)->len) == 0;
+  default:
+    return false;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  Errors
+//
+//  The program's output so far is written out first, then the message,
+//  and the run ends with status 1.
+//
+/////////////////////////////////////////////////////////////////////////
+
+void vm_error(const char *msg)
+{
+  fflush(stdout);
+  cerr << msg << endl;
+  exit(1);
+}
+
+// An error in method m at instruction pc, reported at its source line.
+void vm_error(Vm_Method *m, int pc, const char *msg)
+{
+  fflush(stdout);
+  cerr << m->owner->filename << ":" << m->lines[pc] << ": " << msg << endl;
+  exit(1);
+}
+
+static Vm_String *string_arg(Vm_Object *o)
+{
+  if (o == NULL || o->cls->kind != VM_STRING)
+    vm_error("String argument expected");
+  return (Vm_String *) o;
+}
+
+static int int_arg(Vm_Object *o)
+{
+  if (o == NULL || o->cls->kind != VM_INT)
+    vm_error("Int argument expected");
+  return ((Vm_Int *) o)->val;
+}
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  The built-in methods
+//
+/////////////////////////////////////////////////////////////////////////
+
+static Vm_Object *object_abort(Vm_Object **args)
+{
+  fflush(stdout);
+  cerr << "Abort called from class " << args[0]->cls->name << endl;
+  exit(1);
+}
+
+static Vm_Object *object_type_name(Vm_Object **args)
+{
+  return args[0]->cls->type_name;
+}
+
+//
+// The built-in methods that allocate read their arguments again after
+// doing so, since a collection may have moved them; see vm.h.
+//
+static Vm_Object *object_copy(Vm_Object **args)
+{
+  Vm_Object *o = args[0];
+
+  switch (o->cls->kind) {
+  case VM_PLAIN: {
+    size_t size = vm_plain_size(o->cls->attrs);
+    Vm_Object *copy = (Vm_Object *) vm_alloc(size);
+    memcpy(copy, args[0], size);
+    return copy;
+  }
+  case VM_INT:
+    return vm_int(((Vm_Int *) o)->val);
+  case VM_STRING: {
+    Vm_String *copy = vm_string(NULL, ((Vm_String *) o)->len);
+    memcpy(copy->chars, ((Vm_String *) args[0])->chars, copy->len);
+    return copy;
+  }
+  default:
+    return o;                   // one of the two Bools
+  }
+}
+
+static Vm_Object *io_out_string(Vm_Object **args)
+{
+  Vm_String *s = string_arg(args[1]);
+  fwrite(s->chars, 1, s->len, stdout);
+  return args[0];
+}
+
+static Vm_Object *io_out_int(Vm_Object **args)
+{
+  printf("%d", int_arg(args[1]));
+  return args[0];
+}
+
+//
+// A line of input, without its newline.  The program's output is
+// written out first, in case it is a prompt.
+//
+static char *read_line(int *len)
+{
+  static char *line;
+  static size_t cap;
+
+  fflush(stdout);
+  ssize_t n = getline(&line, &cap, stdin);
+  if (n <= 0) {
+    *len = 0;
+    return (char *) "";
+  }
+  if (line[n - 1] == '\n')
+    line[--n] = '\0';
+  *len = n;
+  return line;
+}
+
+static Vm_Object *io_in_string(Vm_Object **args)
+{
+  int len;
+  char *line = read_line(&len);
+
+  if ((int) strlen(line) != len)        // a null in the line
+    return vm.empty_string;
+  return vm_string(line, len);
+}
+
+static Vm_Object *io_in_int(Vm_Object **args)
+{
+  int len;
+  return vm_int((int) strtol(read_line(&len), NULL, 10));
+}
+
+static Vm_Object *string_length(Vm_Object **args)
+{
+  return vm_int(((Vm_String *) args[0])->len);
+}
+
+static Vm_Object *string_concat(Vm_Object **args)
+{
+  int len = ((Vm_String *) args[0])->len;
+  Vm_String *r = vm_string(NULL, len + string_arg(args[1])->len);
+  Vm_String *s = (Vm_String *) args[0];
+  Vm_String *t = (Vm_String *) args[1];
+
+  memcpy(r->chars, s->chars, s->len);
+  memcpy(r->chars + s->len, t->chars, t->len);
+  return r;
+}
+
+static Vm_Object *string_substr(Vm_Object **args)
+{
+  int len = ((Vm_String *) args[0])->len;
+  int i = int_arg(args[1]);
+  int l = int_arg(args[2]);
+
+  if (i < 0 || l < 0 || i > len || l > len - i)
+    vm_error("Index to substr is out of range");
+  Vm_String *r = vm_string(NULL, l);
+  memcpy(r->chars, ((Vm_String *) args[0])->chars + i, l);
+  return r;
+}
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  The basic classes
+//
+/////////////////////////////////////////////////////////////////////////
+
+static Vm_Class *basic_class(const char *name, Vm_Class *parent, Vm_Kind kind)
+{
+  Vm_Class *c = new Vm_Class();
+
+  c->name = idtable.add_string((char *) name);
+  c->tag = vm.classes.size();
+  c->parent = parent;
+  c->kind = kind;
+  c->filename = stringtable.add_string((char *) "<basic class>");
+  if (parent)
+    c->methods = parent->methods;
+  vm.classes.push_back(c);
+  vm.class_named[c->name] = c;
+  return c;
+}
+
+static void builtin(Vm_Class *c, const char *name, int args, Vm_Builtin fn)
+{
+  Vm_Method *m = new Vm_Method();
+
+  m->name = idtable.add_string((char *) name);
+  m->owner = c;
+  m->args = args;
+  m->regs = args + 1;
+  m->builtin = fn;
+  c->methods[m->name] = m;
+}
+
+void vm_basic_classes()
+{
+  vm.Object = basic_class("Object", NULL, VM_PLAIN);
+  builtin(vm.Object, "abort", 0, object_abort);
+  builtin(vm.Object, "type_name", 0, object_type_name);
+  builtin(vm.Object, "copy", 0, object_copy);
+
+  vm.IO = basic_class("IO", vm.Object, VM_PLAIN);
+  builtin(vm.IO, "out_string", 1, io_out_string);
+  builtin(vm.IO, "out_int", 1, io_out_int);
+  builtin(vm.IO, "in_string", 0, io_in_string);
+  builtin(vm.IO, "in_int", 0, io_in_int);
+
+  vm.Int = basic_class("Int", vm.Object, VM_INT);
+  vm.Bool = basic_class("Bool", vm.Object, VM_BOOL);
+
+  vm.String = basic_class("String", vm.Object, VM_STRING);
+  builtin(vm.String, "length", 0, string_length);
+  builtin(vm.String, "concat", 1, string_concat);
+  builtin(vm.String, "substr", 2, string_substr);
+
+  vm.Int->proto = vm_int(0);
+  vm.false_obj = (Vm_Int *) vm_alloc(sizeof(Vm_Int));
+  vm.false_obj->cls = vm.Bool;
+  vm.false_obj->val = 0;
+  vm.true_obj = (Vm_Int *) vm_alloc(sizeof(Vm_Int));
+  vm.true_obj->cls = vm.Bool;
+  vm.true_obj->val = 1;
+  vm.Bool->proto = vm.false_obj;
+  vm.empty_string = vm_string("", 0);
+  vm.String->proto = vm.empty_string;
+
+  vm.Object->proto = (Vm_Object *) vm_alloc(vm_plain_size(0));
+  vm.Object->proto->cls = vm.Object;
+  vm.IO->proto = (Vm_Object *) vm_alloc(vm_plain_size(0));
+  vm.IO->proto->cls = vm.IO;
+  for (size_t i = 0; i < vm.classes.size(); i++) {
+    Symbol name = vm.classes[i]->name;
+    vm.classes[i]->type_name = vm_string(name->get_string(), name->get_len());
+  }
+}
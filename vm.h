@@ -0,0 +1,307 @@
+#ifndef VM_H
+#define VM_H
+
+//
+// vm.h
+//
+//  Running a Cool program in the parser's own process (-run), with no
+//  simulator.  The classes of the program are laid out as runtime
+//  classes, their methods are compiled into a register bytecode
+//  (vm-compile.cc), and main() of a new Main is run by a direct-threaded
+//  interpreter (vm-exec.cc) over the objects and built-in methods of
+//  vm-runtime.cc.
+//
+//  No semantic analysis comes first, so what a type checker would have
+//  caught is caught here: a program that names classes, methods or
+//  variables that do not exist is refused before it starts, and each
+//  operation checks the classes of its operands as it runs.
+//
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include <unordered_map>
+#include "cool-tree.h"
+#include "parse-stats.h"
+#include "rep.h"
+
+struct Vm_Class;
+struct Vm_Method;
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  Objects
+//
+//  Every object starts with its class; what follows depends on the
+//  kind of the class.  Int and Bool values and strings are objects like
+//  any other, as in the SPIM runtime; there are only two Bools.
+//
+//  But an Int or a Bool is only made into an object, boxed, where it
+//  has to be one: where it is used as an Object or as the receiver of a
+//  call.  Elsewhere it is kept unboxed, as an int in the register or the
+//  attribute that holds it: an attribute declared Int or Bool, a
+//  variable so declared, or the value of an expression such as 1 + 2 or
+//  a < b (see rep.h).  A Bool is 0 or 1.
+//
+//  An argument or a result is passed unboxed if every method of that
+//  name and number of arguments declares it Int, or every one Bool, as
+//  a call may reach any of them.  The built-in methods take and return
+//  objects.
+//
+/////////////////////////////////////////////////////////////////////////
+
+enum Vm_Kind { VM_PLAIN, VM_INT, VM_BOOL, VM_STRING };
+
+struct Vm_Object {
+  Vm_Class *cls;
+};
+
+struct Vm_Plain : Vm_Object {
+  Vm_Object *attr[1];           // cls->attrs of them; unboxed ones are ints
+};
+
+// An unboxed Int or Bool, as it is held in a register or an attribute.
+inline Vm_Object *vm_unboxed(int val)
+{
+  return (Vm_Object *) (intptr_t) val;
+}
+
+inline int vm_unboxed_val(Vm_Object *o)
+{
+  return (int) (intptr_t) o;
+}
+
+// The size of a plain object with the given number of attributes.
+inline size_t vm_plain_size(int attrs)
+{
+  return sizeof(Vm_Plain) + (attrs > 1 ? attrs - 1 : 0) * sizeof(Vm_Object *);
+}
+
+struct Vm_Int : Vm_Object {     // an Int or a Bool
+  int val;
+};
+
+struct Vm_String : Vm_Object {
+  int len;
+  char chars[1];                // len of them, then '\0'
+};
+
+// A method written in C: args[0] is self, then the arguments.
+typedef Vm_Object *(*Vm_Builtin)(Vm_Object **args);
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  Bytecode
+//
+//  An instruction names up to three registers or other operands.  The
+//  registers of a call are a window on a single stack: self in 0, the
+//  arguments in 1 to args, then the locals and temporaries.  A call
+//  puts the receiver and arguments in consecutive registers at the top
+//  of the caller's frame, which become registers 0 to args of the
+//  callee's, and the result comes back in the first of them.  These are
+//  all objects; the Int and Bool operands and results of the operations
+//  are unboxed, but where an operation says otherwise.
+//
+/////////////////////////////////////////////////////////////////////////
+
+enum Vm_Op {
+  OP_MOVE,              // a = b
+  OP_CONST,             // a = vm.constants[b]
+  OP_INT,               // a = b, an Int or Bool
+  OP_VOID,              // a = void
+  OP_ATTR,              // a = attribute b of self
+  OP_SET_ATTR,          // attribute a of self = b, an object
+  OP_SET_RAW,           // attribute a of self = b, an unboxed one
+  OP_NEW,               // a = new vm.classes[b]
+  OP_NEW_SELF,          // a = new SELF_TYPE
+  OP_BOX_INT,           // a = b as an object
+  OP_BOX_BOOL,          // a = b as an object
+  OP_UNBOX_INT,         // a = b, which must be an Int object
+  OP_UNBOX_BOOL,        // a = b, which must be a Bool object
+  OP_ADD,               // a = b + c
+  OP_SUB,               // a = b - c
+  OP_MUL,               // a = b * c
+  OP_DIV,               // a = b / c
+  OP_NEG,               // a = ~b
+  OP_LT,                // a = b < c
+  OP_LE,                // a = b <= c
+  OP_EQ,                // a = b = c, of objects
+  OP_SAME,              // a = b = c, of two Ints or two Bools
+  OP_NOT,               // a = not b
+  OP_ISVOID,            // a = isvoid b, an object
+  OP_JUMP,              // to instruction a
+  OP_JUMP_FALSE,        // to instruction b if a is false
+  OP_DISPATCH,          // a = a.f(a+1 ... a+b), f that of vm.sites[c]
+  OP_STATIC,            // the same, calling vm.methods[c]
+  OP_CASE,              // to the branch of vm.cases[b] for the class of a
+  OP_RETURN,            // return a, an object
+  VM_OPS
+};
+
+struct Vm_Insn {
+  const void *op;       // the Vm_Op, and once threaded its code in vm-exec.cc
+  int a, b, c;
+};
+
+struct Vm_Method {
+  Symbol name;
+  Vm_Class *owner;              // where it is defined
+  int args;                     // not counting self
+  int regs;                     // size of its frame
+  std::vector<Vm_Insn> code;
+  std::vector<int> lines;       // the source line of each instruction
+  Vm_Builtin builtin;           // if not NULL, the method, and no code
+  std::vector<Vm_Rep> arg_reps; // how each argument is passed, if not boxed
+  Vm_Rep ret_rep;               // and the result
+
+  // The stack map of each instruction that can allocate or call: where
+  // in maps its list of the registers holding live objects starts, or
+  // -1.  Each list is of runs of registers, the first and how many, and
+  // ends with -1.
+  std::vector<int> map_start;
+  std::vector<int> maps;
+};
+
+//
+// A dispatch by name, from one place in the program, and its inline
+// cache: the method last found for the class of the receiver, then up
+// to VM_POLY more for other classes.  A site that sees more classes than
+// that is megamorphic, and looks each one up.
+//
+#define VM_POLY 4
+
+struct Vm_Site {
+  Symbol name;
+  Vm_Rep ret;                   // how its methods return
+  Vm_Class *cls;                // the monomorphic entry, or NULL
+  Vm_Method *method;
+  int entries;                  // polymorphic ones in use
+  Vm_Class *poly_cls[VM_POLY];
+  Vm_Method *poly_method[VM_POLY];
+  bool megamorphic;             // they have run out
+};
+
+// The branches of a case: the class each is for, and where it starts.
+struct Vm_Case {
+  std::vector<std::pair<Vm_Class *, int> > branches;
+};
+
+struct Vm_Class {
+  Symbol name;
+  int tag;                      // its index in vm.classes
+  Vm_Class *parent;
+  Vm_Kind kind;
+  Symbol filename;
+  int attrs;                    // of a plain object, inherited ones first
+  std::vector<Symbol> attr_types;   // the declared type of each
+  std::vector<int> pointers;        // those that are not unboxed
+  Vm_Object *proto;             // what new copies: the default values
+  Vm_Method *init;              // runs the attribute initializers, or NULL
+  Vm_String *type_name;
+  std::unordered_map<Symbol, int> attr_index;       // own and inherited
+  std::unordered_map<Symbol, Vm_Method *> methods;  // own and inherited
+};
+
+//
+// The program being run.
+//
+struct Vm_Program {
+  std::vector<Vm_Class *> classes;
+  std::unordered_map<Symbol, Vm_Class *> class_named;
+  std::vector<Vm_Method *> methods;  // the operands of OP_STATIC
+  std::vector<Vm_Object *> constants;
+  std::vector<Vm_Site> sites;
+  std::vector<Vm_Case> cases;
+  Vm_Class *Object, *IO, *Int, *Bool, *String;
+  Vm_Int *true_obj, *false_obj;
+  Vm_String *empty_string;
+  Vm_Method *start;             // (new Main).main()
+};
+
+extern Vm_Program vm;
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  The heap (vm-gc.cc)
+//
+//  Objects are bump-allocated in a nursery.  When it is full, a minor
+//  collection copies the objects in it that are still reachable into
+//  the old generation, one of two semi-spaces; when that fills up, a
+//  major collection copies everything reachable into the other.  What
+//  is made before the program starts (prototypes, constants, the names
+//  of classes) is never collected, and never points into the heap.
+//
+//  The roots are the registers that the stack maps of the compiler say
+//  hold live objects, in each frame on the stack, and the arguments of
+//  a built-in method being called.  A built-in method that allocates
+//  must read its arguments again afterwards, as they may have moved.
+//
+//  An old object that is made to point to a young one is remembered by
+//  the write barrier of OP_SET_ATTR, so that a minor collection can find
+//  the young one without looking at all of the old generation.
+//
+/////////////////////////////////////////////////////////////////////////
+
+struct Vm_Frame {
+  Vm_Method *method;            // the caller's
+  Vm_Insn *ret;                 //   instruction to go on with
+  Vm_Object **regs;             //   and registers
+};
+
+// Where the interpreter is, kept up to date wherever it can allocate.
+struct Vm_Roots {
+  Vm_Frame *frames, *fp;        // the callers, frames up to fp
+  Vm_Method *method;            // and the method running
+  Vm_Insn *pc;
+  Vm_Object **regs;
+  Vm_Object **args;             // of a built-in method, or NULL
+  int argc;
+};
+
+extern Vm_Roots vm_roots;
+extern char *vm_alloc_next, *vm_alloc_limit;
+extern char *vm_nursery, *vm_nursery_end;
+
+void *vm_alloc_slow(size_t size);
+void vm_gc_start();
+void vm_remember(Vm_Object *o);
+
+inline void *vm_alloc(size_t size)
+{
+  size = (size + 7) & ~(size_t) 7;
+  parse_stats.vm_objects++;
+  if ((size_t) (vm_alloc_limit - vm_alloc_next) < size)
+    return vm_alloc_slow(size);
+  void *p = vm_alloc_next;
+  vm_alloc_next += size;
+  return p;
+}
+
+inline bool vm_young(Vm_Object *o)
+{
+  return (size_t) ((char *) o - vm_nursery) < (size_t) (vm_nursery_end - vm_nursery);
+}
+
+// The write barrier: o has been made to point to v.
+inline void vm_stored(Vm_Object *o, Vm_Object *v)
+{
+  if (vm_young(v) && !vm_young(o))
+    vm_remember(o);
+}
+
+// vm-runtime.cc: the basic classes, objects and errors.
+void vm_basic_classes();
+Vm_Object *vm_new(Vm_Class *c);
+Vm_Int *vm_int(int val);
+Vm_String *vm_string(const char *s, int len);
+bool vm_equal(Vm_Object *x, Vm_Object *y);
+void vm_error(const char *msg);
+void vm_error(Vm_Method *m, int pc, const char *msg);
+
+// vm-compile.cc: lay out the classes of p and compile their methods.
+void vm_compile(Program p);
+
+// vm-exec.cc: run the program; returns the exit status.
+int vm_run(Program p);
+
+#endif
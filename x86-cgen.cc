@@ -0,0 +1,1268 @@
+//
+// See copyright.h for copyright notice and limitation of liability
+// and disclaimer of warranty provisions.
+//
+#include "copyright.h"
+
+//
+// x86-cgen.cc
+//
+//  Compiles a Cool program to x86-64 assembly; see x86-cgen.h.
+//
+//  The classes are laid out as for -run (vm-compile.cc): parents first,
+//  inherited attributes first, and a new object is a copy of its class's
+//  prototype on which its init method is run.
+//
+//  With no type checker, the class of a receiver is not known where a
+//  method is called, so a dispatch table cannot be laid out by class.
+//  Instead every method name and number of arguments that occurs in the
+//  program is given a slot, its selector, which is the same in the
+//  dispatch table of every class; a class without such a method has a
+//  stub there that reports it.  A dispatch loads the receiver's table
+//  and calls through the selector's slot.
+//
+//  A case walks up from the class of its value through the parent tags
+//  of class_parentTab, trying the tag of each branch at each step, so
+//  that the closest ancestor wins.
+//
+//  Each expression is compiled by its code(g), which leaves its value in
+//  %rax.  It is held as its rep says (rep.h): an object, or an Int or a
+//  Bool in %eax, a Bool being 0 or 1; value(e, want) boxes or unboxes it
+//  if it is wanted held otherwise.  A variable or an attribute declared
+//  Int or Bool holds the int itself, in a quad, and so do the arguments
+//  and the result of a call whose signature passes them unboxed.  A
+//  formal declared Int or Bool that is passed boxed anyway is unboxed
+//  into a slot of its own when its method starts.
+//
+//  self is kept in %rbx.  Temporaries are pushed on the stack; let and
+//  case variables have slots of their own in the frame below the saved
+//  %rbx, and the arguments are above the return address, pushed in order
+//  by the caller, who is popped of them by the callee's ret.
+//  Nothing but %rbx and %rbp lives across a call, so the C functions of
+//  the runtime can be called wherever the stack is, through the CCALL
+//  macro, which aligns it as the C ABI requires.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <unordered_map>
+#include <map>
+#include "cool-io.h"
+#include "cool-tree.h"
+#include "stringtab.h"
+#include "x86-cgen.h"
+#include "rep.h"
+
+// How deeply expressions may nest; code recurses on the tree.
+#define X86_MAX_NESTING 10000
+
+struct X86_Class {
+  Symbol name;
+  int tag;
+  X86_Class *parent;
+  Class_ tree;                  // NULL for a basic class
+  Symbol filename;
+  std::vector<Symbol> attr_types;       // of all, inherited ones first
+  std::unordered_map<Symbol, int> attr_index;
+  std::vector<std::string> methods;     // the label of each selector's, or ""
+  std::vector<int> method_args;         // and its number of formals
+  std::unordered_map<Symbol, int> method_names; // a selector of each name
+};
+
+class X86_Cgen : public Rep_Analysis {
+  struct Variable {
+    Symbol name;
+    std::string loc;
+    Vm_Rep rep;
+  };
+  std::vector<Variable> scope;  // innermost last
+  std::map<int, std::string> int_consts;
+  std::map<std::string, std::string> string_consts;
+  std::map<Symbol, std::string> file_names;
+  int labels;
+  int depth;
+  int locals, max_locals;       // let and case slots in use, and needed
+
+public:
+  std::vector<X86_Class *> classes;     // by tag
+  std::unordered_map<Symbol, X86_Class *> class_named;
+  std::map<std::pair<Symbol, int>, int> selector_index;
+  std::vector<std::pair<Symbol, int> > selectors;
+  X86_Class *cls;               // being compiled
+  Expression unused;            // being compiled by effect()
+  std::ostringstream s;         // the code of the method being compiled
+  Symbol self, SELF_TYPE;
+
+  X86_Cgen();
+  void error(tree_node *t, const char *msg, Symbol name = NULL);
+
+  void ins(const char *op, const std::string &args = "")
+  {
+    s << "\t" << op;
+    if (!args.empty())
+      s << "\t" << args;
+    s << "\n";
+  }
+  void place(const std::string &label) { s << label << ":\n"; }
+  std::string label();
+  void value(Expression e, Vm_Rep want);
+  void value(Expression e) { value(e, rep(e)); }
+  void effect(Expression e);
+  void where(tree_node *t);
+
+  std::string int_const(int val);
+  std::string string_const(const std::string &str);
+  std::string file_name(Symbol filename);
+  int selector(Symbol name, int args);
+
+  int local();
+  void free_local() { locals--; }
+  std::string slot(int k);
+  void bind(Symbol name, const std::string &loc, Vm_Rep rep = REP_BOXED)
+  {
+    Variable v = { name, loc, rep };
+    scope.push_back(v);
+  }
+  void bind_rep(Symbol name, Vm_Rep rep) { bind(name, "", rep); }
+  void unbind() { scope.pop_back(); }
+  std::string variable(tree_node *t, Symbol name);
+  Vm_Rep local_rep(Symbol name);
+
+  void enter(Expression e)
+  {
+    if (++depth > X86_MAX_NESTING)
+      error(e, "Expression nested too deeply to compile");
+  }
+  void leave() { depth--; }
+
+  void start();
+  void finish(ostream &out, const std::string &name, int args);
+  void emit_data(ostream &out);
+};
+
+X86_Cgen::X86_Cgen() : labels(0), depth(0), locals(0), max_locals(0), cls(NULL),
+                       unused(NULL)
+{
+  self = idtable.add_string("self");
+  SELF_TYPE = idtable.add_string("SELF_TYPE");
+}
+
+void X86_Cgen::error(tree_node *t, const char *msg, Symbol name)
+{
+  cerr << cls->filename << ":" << t->get_line_number() << ": " << msg;
+  if (name)
+    cerr << " " << name;
+  cerr << "." << endl;
+  exit(1);
+}
+
+std::string X86_Cgen::label()
+{
+  std::ostringstream l;
+  l << ".L" << labels++;
+  return l.str();
+}
+
+// The value of an Int constant.
+static int int_value(Symbol token)
+{
+  return (int) strtoll(token->get_string(), NULL, 10);
+}
+
+//
+// Code e, with its value held as want.  A constant is boxed by taking
+// its object constant; an Int for a Bool, or a Bool for an Int, is the
+// same int either way, as it would be read out of the object.
+//
+void X86_Cgen::value(Expression e, Vm_Rep want)
+{
+  enter(e);
+  Vm_Rep have = rep(e);
+
+  if (have == want || (have != REP_BOXED && want != REP_BOXED))
+    e->code(*this);
+  else if (dynamic_cast<int_const_class *>(e))
+    ins("leaq", int_const(int_value(((int_const_class *) e)->get_token())) +
+        "(%rip), %rax");
+  else if (dynamic_cast<bool_const_class *>(e))
+    ins("leaq", std::string(((bool_const_class *) e)->get_val() ?
+                            "bool_const1" : "bool_const0") + "(%rip), %rax");
+  else {
+    e->code(*this);
+    if (have == REP_BOXED)
+      ins("movl", "24(%rax), %eax");
+    else if (have == REP_INT) {
+      ins("movl", "%eax, %edi");
+      ins("call", "_int_new");
+    }
+    else {
+      ins("leaq", "bool_const0(%rip), %rcx");
+      ins("leaq", "bool_const1(%rip), %rdx");
+      ins("testl", "%eax, %eax");
+      ins("movq", "%rcx, %rax");
+      ins("cmovnzq", "%rdx, %rax");
+    }
+  }
+  leave();
+}
+
+//
+// Code e for its effect alone.  As its value is not used, it need not be
+// held one way: an if, a block or a let that ends in one leaves each
+// branch's value as it is, rather than boxing them all.
+//
+void X86_Cgen::effect(Expression e)
+{
+  Expression outer = unused;
+  unused = e;
+  value(e);
+  unused = outer;
+}
+
+// Where t is, in the arguments of a runtime error: %rdi and %esi.
+void X86_Cgen::where(tree_node *t)
+{
+  std::ostringstream line;
+  line << "$" << t->get_line_number() << ", %esi";
+  ins("leaq", file_name(cls->filename) + "(%rip), %rdi");
+  ins("movl", line.str());
+}
+
+std::string X86_Cgen::int_const(int val)
+{
+  std::map<int, std::string>::iterator i = int_consts.find(val);
+  if (i != int_consts.end())
+    return i->second;
+  std::ostringstream l;
+  l << "int_const" << int_consts.size();
+  return int_consts[val] = l.str();
+}
+
+std::string X86_Cgen::string_const(const std::string &str)
+{
+  std::map<std::string, std::string>::iterator i = string_consts.find(str);
+  if (i != string_consts.end())
+    return i->second;
+  std::ostringstream l;
+  l << "str_const" << string_consts.size();
+  return string_consts[str] = l.str();
+}
+
+std::string X86_Cgen::file_name(Symbol filename)
+{
+  std::map<Symbol, std::string>::iterator i = file_names.find(filename);
+  if (i != file_names.end())
+    return i->second;
+  std::ostringstream l;
+  l << "file_name" << file_names.size();
+  return file_names[filename] = l.str();
+}
+
+// The selector of a method name called with args arguments.
+int X86_Cgen::selector(Symbol name, int args)
+{
+  std::pair<Symbol, int> key(name, args);
+  std::map<std::pair<Symbol, int>, int>::iterator i = selector_index.find(key);
+  if (i != selector_index.end())
+    return i->second;
+  selectors.push_back(key);
+  return selector_index[key] = selectors.size() - 1;
+}
+
+int X86_Cgen::local()
+{
+  if (++locals > max_locals)
+    max_locals = locals;
+  return locals - 1;
+}
+
+std::string X86_Cgen::slot(int k)
+{
+  std::ostringstream loc;
+  loc << -16 - 8 * k << "(%rbp)";
+  return loc.str();
+}
+
+// Where a variable is, as an operand.
+std::string X86_Cgen::variable(tree_node *t, Symbol name)
+{
+  for (int i = scope.size() - 1; i >= 0; i--)
+    if (scope[i].name == name)
+      return scope[i].loc;
+  if (name == self)
+    return "%rbx";
+  std::unordered_map<Symbol, int>::iterator i = cls->attr_index.find(name);
+  if (i == cls->attr_index.end())
+    error(t, "Undefined identifier", name);
+  std::ostringstream loc;
+  loc << 24 + 8 * i->second << "(%rbx)";
+  return loc.str();
+}
+
+// How a variable in scope, or else an attribute, is held.
+Vm_Rep X86_Cgen::local_rep(Symbol name)
+{
+  for (int i = scope.size() - 1; i >= 0; i--)
+    if (scope[i].name == name)
+      return scope[i].rep;
+  std::unordered_map<Symbol, int>::iterator i = cls->attr_index.find(name);
+  return i == cls->attr_index.end() ? REP_BOXED : type_rep(cls->attr_types[i->second]);
+}
+
+// Start the code of a method; its formals have to be bound by the caller.
+void X86_Cgen::start()
+{
+  s.str("");
+  scope.clear();
+  locals = max_locals = 0;
+}
+
+//
+// Write out the method compiled, with the frame it needs, self in %rax
+// on the way in and its value on the way out.
+//
+void X86_Cgen::finish(ostream &out, const std::string &name, int args)
+{
+  out << name << ":\n"
+      << "\tpushq\t%rbp\n"
+      << "\tmovq\t%rsp, %rbp\n"
+      << "\tpushq\t%rbx\n"
+      << "\tmovq\t%rax, %rbx\n";
+  if (max_locals)
+    out << "\tsubq\t$" << 8 * max_locals << ", %rsp\n";
+  out << s.str()
+      << "\tmovq\t-8(%rbp), %rbx\n"
+      << "\tleave\n";
+  if (args)
+    out << "\tret\t$" << 8 * args << "\n\n";
+  else
+    out << "\tret\n\n";
+}
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  Expressions
+//
+/////////////////////////////////////////////////////////////////////////
+
+static std::string operand(int n)
+{
+  std::ostringstream o;
+  o << "$" << n;
+  return o.str();
+}
+
+// %eax = 1 if the condition cc of the last comparison holds, else 0
+static void bool_of(X86_Cgen &g, const char *set)
+{
+  g.ins(set, "%al");
+  g.ins("movzbl", "%al, %eax");
+}
+
+void assign_class::code(X86_Cgen &g)
+{
+  if (name == g.self)
+    g.error(this, "Cannot assign to 'self'");
+  std::string loc = g.variable(this, name);
+  g.value(expr, g.local_rep(name));
+  g.ins("movq", "%rax, " + loc);
+}
+
+//
+// Before each call the stack is checked against the limit the runtime
+// sets, so that a recursion too deep is reported where it is made.
+//
+static void check_stack(X86_Cgen &g, tree_node *t)
+{
+  std::string ok = g.label();
+  g.ins("cmpq", "cool_stack_limit(%rip), %rsp");
+  g.ins("jae", ok);
+  g.where(t);
+  g.ins("call", "_stack_overflow");
+  g.place(ok);
+}
+
+//
+// The arguments are pushed in order, passed as sig says or boxed if no
+// method could take them, then the receiver is left in %rax and
+// checked.  The result is as sig says.
+//
+static void call_args(X86_Cgen &g, tree_node *t, Expression receiver,
+                      Expressions actual, const Rep_Analysis::Signature *sig)
+{
+  int j = 0;
+  for (int i = actual->first(); actual->more(i); i = actual->next(i), j++) {
+    g.value(actual->nth(i), sig ? sig->args[j] : REP_BOXED);
+    g.ins("pushq", "%rax");
+  }
+  g.value(receiver, REP_BOXED);
+  std::string ok = g.label();
+  g.ins("testq", "%rax, %rax");
+  g.ins("jnz", ok);
+  g.where(t);
+  g.ins("call", "_dispatch_void");
+  g.place(ok);
+  check_stack(g, t);
+}
+
+void static_dispatch_class::code(X86_Cgen &g)
+{
+  if (type_name == g.SELF_TYPE)
+    g.error(this, "Static dispatch to SELF_TYPE");
+  std::unordered_map<Symbol, X86_Class *>::iterator k = g.class_named.find(type_name);
+  if (k == g.class_named.end())
+    g.error(this, "Undefined class", type_name);
+  std::unordered_map<Symbol, int>::iterator m = k->second->method_names.find(name);
+  if (m == k->second->method_names.end())
+    g.error(this, "Undefined method", name);
+  if (k->second->method_args[m->second] != actual->len())
+    g.error(this, "Wrong number of arguments to", name);
+  call_args(g, this, expr, actual, g.signature(name, actual->len()));
+  g.ins("call", k->second->methods[m->second]);
+}
+
+void dispatch_class::code(X86_Cgen &g)
+{
+  std::ostringstream slot;
+  slot << "*" << 8 * g.selector(name, actual->len()) << "(%rcx)";
+  call_args(g, this, expr, actual, g.signature(name, actual->len()));
+  g.ins("movq", "16(%rax), %rcx");
+  g.ins("call", slot.str());
+}
+
+void cond_class::code(X86_Cgen &g)
+{
+  std::string to_else = g.label(), to_end = g.label();
+  bool discarded = g.unused == this;
+  Vm_Rep r = g.rep(this);
+  g.value(pred, REP_BOOL);
+  g.ins("testl", "%eax, %eax");
+  g.ins("je", to_else);
+  if (discarded)
+    g.effect(then_exp);
+  else
+    g.value(then_exp, r);
+  g.ins("jmp", to_end);
+  g.place(to_else);
+  if (discarded)
+    g.effect(else_exp);
+  else
+    g.value(else_exp, r);
+  g.place(to_end);
+}
+
+void loop_class::code(X86_Cgen &g)
+{
+  std::string start = g.label(), to_end = g.label();
+  g.place(start);
+  g.value(pred, REP_BOOL);
+  g.ins("testl", "%eax, %eax");
+  g.ins("je", to_end);
+  g.effect(body);
+  g.ins("jmp", start);
+  g.place(to_end);
+  g.ins("xorl", "%eax, %eax");
+}
+
+//
+// The value being matched goes in a slot of its own, which becomes the
+// variable of the branch taken.
+//
+void typcase_class::code(X86_Cgen &g)
+{
+  std::vector<X86_Class *> tags;
+  std::vector<std::string> starts;
+  std::string loop = g.label(), to_end = g.label(), ok = g.label();
+  int var = g.local();
+
+  for (int i = cases->first(); cases->more(i); i = cases->next(i)) {
+    branch_class *b = (branch_class *) cases->nth(i);
+    if (b->get_type_decl() == g.SELF_TYPE)
+      g.error(b, "Case branch of type SELF_TYPE");
+    std::unordered_map<Symbol, X86_Class *>::iterator k =
+      g.class_named.find(b->get_type_decl());
+    if (k == g.class_named.end())
+      g.error(b, "Undefined class", b->get_type_decl());
+    for (size_t j = 0; j < tags.size(); j++)
+      if (tags[j] == k->second)
+        g.error(b, "Duplicate branch in case statement for class", k->second->name);
+    tags.push_back(k->second);
+    starts.push_back(g.label());
+  }
+
+  g.value(expr, REP_BOXED);
+  g.ins("testq", "%rax, %rax");
+  g.ins("jnz", ok);
+  g.where(this);
+  g.ins("call", "_case_void");
+  g.place(ok);
+  g.ins("movq", "%rax, " + g.slot(var));
+  g.ins("movq", "(%rax), %rcx");
+  g.ins("leaq", "class_parentTab(%rip), %rdx");
+  g.place(loop);
+  for (size_t i = 0; i < tags.size(); i++) {
+    g.ins("cmpq", operand(tags[i]->tag) + ", %rcx");
+    g.ins("je", starts[i]);
+  }
+  g.ins("movq", "(%rdx,%rcx,8), %rcx");
+  g.ins("testq", "%rcx, %rcx");
+  g.ins("jns", loop);
+  g.where(this);
+  g.ins("movq", "%rax, %rdx");
+  g.ins("call", "_case_abort");
+
+  int i = 0;
+  for (int j = cases->first(); cases->more(j); j = cases->next(j), i++) {
+    branch_class *b = (branch_class *) cases->nth(j);
+    g.place(starts[i]);
+    g.bind(b->get_name(), g.slot(var));
+    g.value(b->get_expr(), REP_BOXED);
+    g.unbind();
+    g.ins("jmp", to_end);
+  }
+  g.place(to_end);
+  g.free_local();
+}
+
+void block_class::code(X86_Cgen &g)
+{
+  int n = body->len();
+
+  for (int i = 0; i < n - 1; i++)
+    g.effect(body->nth(i));
+  if (g.unused == this)
+    g.effect(body->nth(n - 1));
+  else
+    g.value(body->nth(n - 1));
+}
+
+//
+// The value a variable of the given type starts with: "" for a String,
+// 0 or false for an Int or a Bool, held unboxed, and void for others.
+//
+static void default_value(X86_Cgen &g, Symbol type)
+{
+  if (type == g.classes[X86_STRING_TAG]->name)
+    g.ins("leaq", g.string_const("") + "(%rip), %rax");
+  else
+    g.ins("xorl", "%eax, %eax");
+}
+
+void let_class::code(X86_Cgen &g)
+{
+  if (identifier == g.self)
+    g.error(this, "'self' cannot be bound in a 'let' expression");
+  Vm_Rep var_rep = type_rep(type_decl);
+  if (dynamic_cast<no_expr_class *>(init))
+    default_value(g, type_decl);
+  else
+    g.value(init, var_rep);
+  int var = g.local();
+  g.ins("movq", "%rax, " + g.slot(var));
+  g.bind(identifier, g.slot(var), var_rep);
+  if (g.unused == this)
+    g.effect(body);
+  else
+    g.value(body);
+  g.unbind();
+  g.free_local();
+}
+
+//
+// Evaluate e1 onto the stack and e2 into %rax, held as want, then take
+// e1 into %rcx.
+//
+static void operands(X86_Cgen &g, Expression e1, Expression e2, Vm_Rep want)
+{
+  g.value(e1, want);
+  g.ins("pushq", "%rax");
+  g.value(e2, want);
+  g.ins("popq", "%rcx");
+}
+
+// %eax = e1 op e2
+static void arith(X86_Cgen &g, const char *op, Expression e1, Expression e2)
+{
+  operands(g, e1, e2, REP_INT);
+  g.ins(op, "%eax, %ecx");
+  g.ins("movl", "%ecx, %eax");
+}
+
+void plus_class::code(X86_Cgen &g)
+{
+  arith(g, "addl", e1, e2);
+}
+
+void sub_class::code(X86_Cgen &g)
+{
+  arith(g, "subl", e1, e2);
+}
+
+void mul_class::code(X86_Cgen &g)
+{
+  arith(g, "imull", e1, e2);
+}
+
+//
+// x86 traps on a division by zero and on the most negative Int divided
+// by -1, which in Cool is itself.
+//
+void divide_class::code(X86_Cgen &g)
+{
+  std::string ok = g.label(), negate = g.label(), done = g.label();
+  operands(g, e1, e2, REP_INT);
+  g.ins("movl", "%eax, %esi");
+  g.ins("testl", "%esi, %esi");
+  g.ins("jnz", ok);
+  g.where(this);
+  g.ins("call", "_divide_by_zero");
+  g.place(ok);
+  g.ins("movl", "%ecx, %eax");
+  g.ins("cmpl", "$-1, %esi");
+  g.ins("je", negate);
+  g.ins("cltd");
+  g.ins("idivl", "%esi");
+  g.ins("jmp", done);
+  g.place(negate);
+  g.ins("negl", "%eax");
+  g.place(done);
+}
+
+void neg_class::code(X86_Cgen &g)
+{
+  g.value(e1, REP_INT);
+  g.ins("negl", "%eax");
+}
+
+void lt_class::code(X86_Cgen &g)
+{
+  operands(g, e1, e2, REP_INT);
+  g.ins("cmpl", "%eax, %ecx");
+  bool_of(g, "setl");
+}
+
+void leq_class::code(X86_Cgen &g)
+{
+  operands(g, e1, e2, REP_INT);
+  g.ins("cmpl", "%eax, %ecx");
+  bool_of(g, "setle");
+}
+
+//
+// Two Ints or two Bools are compared unboxed; anything else as objects.
+//
+void eq_class::code(X86_Cgen &g)
+{
+  Vm_Rep r1 = g.rep(e1);
+  if (r1 != REP_BOXED && g.rep(e2) == r1) {
+    operands(g, e1, e2, r1);
+    g.ins("cmpl", "%eax, %ecx");
+    bool_of(g, "sete");
+    return;
+  }
+  operands(g, e1, e2, REP_BOXED);
+  g.ins("movq", "%rcx, %rdi");
+  g.ins("movq", "%rax, %rsi");
+  g.ins("call", "_equal");
+}
+
+void comp_class::code(X86_Cgen &g)
+{
+  g.value(e1, REP_BOOL);
+  g.ins("testl", "%eax, %eax");
+  bool_of(g, "sete");
+}
+
+void isvoid_class::code(X86_Cgen &g)
+{
+  g.value(e1, REP_BOXED);
+  g.ins("testq", "%rax, %rax");
+  bool_of(g, "setz");
+}
+
+void int_const_class::code(X86_Cgen &g)
+{
+  g.ins("movl", operand(int_value(token)) + ", %eax");
+}
+
+void bool_const_class::code(X86_Cgen &g)
+{
+  g.ins("movl", operand(val ? 1 : 0) + ", %eax");
+}
+
+void string_const_class::code(X86_Cgen &g)
+{
+  std::string str(token->get_string(), token->get_len());
+  g.ins("leaq", g.string_const(str) + "(%rip), %rax");
+}
+
+//
+// A copy of the prototype, on which init is run.  For SELF_TYPE both
+// come from class_objTab, by the tag of self.
+//
+void new__class::code(X86_Cgen &g)
+{
+  check_stack(g, this);
+  if (type_name == g.SELF_TYPE) {
+    g.ins("movq", "(%rbx), %rax");
+    g.ins("shlq", "$4, %rax");
+    g.ins("leaq", "class_objTab(%rip), %rcx");
+    g.ins("addq", "%rcx, %rax");
+    g.ins("pushq", "%rax");
+    g.ins("movq", "(%rax), %rax");
+    g.ins("call", "Object.copy");
+    g.ins("popq", "%rcx");
+    g.ins("call", "*8(%rcx)");
+    return;
+  }
+  std::unordered_map<Symbol, X86_Class *>::iterator k = g.class_named.find(type_name);
+  if (k == g.class_named.end())
+    g.error(this, "Undefined class", type_name);
+  g.ins("leaq", std::string(type_name->get_string()) + "_protObj(%rip), %rax");
+  g.ins("call", "Object.copy");
+  g.ins("call", std::string(type_name->get_string()) + "_init");
+}
+
+void no_expr_class::code(X86_Cgen &g)
+{
+  g.ins("xorl", "%eax, %eax");
+}
+
+void object_class::code(X86_Cgen &g)
+{
+  g.ins("movq", g.variable(this, name) + ", %rax");
+}
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  Classes
+//
+/////////////////////////////////////////////////////////////////////////
+
+struct Class_Source {
+  Class_ tree;
+  X86_Class *cls;
+  int state;                    // 0 not laid out, 1 under way, 2 done
+};
+
+static X86_Class *new_class(X86_Cgen &g, Symbol name, X86_Class *parent, Class_ t)
+{
+  X86_Class *k = new X86_Class();
+  k->name = name;
+  k->parent = parent;
+  k->tree = t;
+  k->filename = t ? t->get_filename() : stringtable.add_string("<basic class>");
+  if (parent) {
+    k->attr_types = parent->attr_types;
+    k->attr_index = parent->attr_index;
+    k->methods = parent->methods;
+    k->method_args = parent->method_args;
+    k->method_names = parent->method_names;
+  }
+  return k;
+}
+
+static void add_method(X86_Cgen &g, X86_Class *k, Symbol name, int args)
+{
+  int sel = g.selector(name, args);
+  if ((int) k->methods.size() <= sel) {
+    k->methods.resize(sel + 1);
+    k->method_args.resize(sel + 1, -1);
+  }
+  k->methods[sel] = std::string(k->name->get_string()) + "." + name->get_string();
+  k->method_args[sel] = args;
+  k->method_names[name] = sel;
+}
+
+static X86_Class *basic_class(X86_Cgen &g, const char *name, X86_Class *parent)
+{
+  X86_Class *k = new_class(g, idtable.add_string((char *) name), parent, NULL);
+  k->tag = g.classes.size();
+  g.classes.push_back(k);
+  g.class_named[k->name] = k;
+  return k;
+}
+
+static void basic_classes(X86_Cgen &g)
+{
+  X86_Class *object = basic_class(g, "Object", NULL);
+  add_method(g, object, idtable.add_string("abort"), 0);
+  add_method(g, object, idtable.add_string("type_name"), 0);
+  add_method(g, object, idtable.add_string("copy"), 0);
+
+  X86_Class *io = basic_class(g, "IO", object);
+  add_method(g, io, idtable.add_string("out_string"), 1);
+  add_method(g, io, idtable.add_string("out_int"), 1);
+  add_method(g, io, idtable.add_string("in_string"), 0);
+  add_method(g, io, idtable.add_string("in_int"), 0);
+
+  basic_class(g, "Int", object);
+  basic_class(g, "Bool", object);
+
+  X86_Class *string = basic_class(g, "String", object);
+  add_method(g, string, idtable.add_string("length"), 0);
+  add_method(g, string, idtable.add_string("concat"), 1);
+  add_method(g, string, idtable.add_string("substr"), 2);
+}
+
+static X86_Class *lay_out(X86_Cgen &g, Class_Source *src,
+                          std::unordered_map<Symbol, Class_Source *> &sources)
+{
+  if (src->state == 2)
+    return src->cls;
+  g.cls = src->cls;
+  if (src->state == 1)
+    g.error(src->tree, "Inheritance cycle through class", src->cls->name);
+  src->state = 1;
+
+  Symbol parent = src->tree->get_parent();
+  X86_Class *p = NULL;
+  if (sources.count(parent))
+    p = lay_out(g, sources[parent], sources);
+  else if (g.class_named.count(parent))
+    p = g.class_named[parent];
+  else
+    g.error(src->tree, "Class inherits from an undefined class", parent);
+  if (p->tag >= X86_INT_TAG && p->tag <= X86_STRING_TAG)
+    g.error(src->tree, "Class cannot inherit from", parent);
+
+  X86_Class *k = new_class(g, src->cls->name, p, src->tree);
+  *src->cls = *k;
+  delete k;
+  k = src->cls;
+  g.cls = k;
+
+  Features features = src->tree->get_features();
+  for (int i = features->first(); features->more(i); i = features->next(i)) {
+    Feature f = features->nth(i);
+    Symbol name = f->get_name();
+    if (!f->is_method()) {
+      if (name == g.self)
+        g.error(f, "'self' cannot be the name of an attribute");
+      if (k->attr_index.count(name))
+        g.error(f, "Attribute redefined:", name);
+      k->attr_index[name] = k->attr_types.size();
+      k->attr_types.push_back(((attr_class *) f)->get_type_decl());
+      continue;
+    }
+    int args = ((method_class *) f)->get_formals()->len();
+    std::unordered_map<Symbol, int>::iterator old = k->method_names.find(name);
+    if (old != k->method_names.end()) {
+      if (k->methods[old->second] ==
+          std::string(k->name->get_string()) + "." + name->get_string())
+        g.error(f, "Method redefined:", name);
+      if (k->method_args[old->second] != args)
+        g.error(f, "Wrong number of formals in redefined method", name);
+    }
+    add_method(g, k, name, args);
+  }
+
+  k->tag = g.classes.size();
+  g.classes.push_back(k);
+  src->state = 2;
+  return k;
+}
+
+static void code_init(X86_Cgen &g, ostream &out, X86_Class *k)
+{
+  g.cls = k;
+  g.start();
+  if (k->parent)
+    g.ins("call", std::string(k->parent->name->get_string()) + "_init");
+  if (k->tree) {
+    Features features = k->tree->get_features();
+    for (int i = features->first(); features->more(i); i = features->next(i)) {
+      Feature f = features->nth(i);
+      if (f->is_method())
+        continue;
+      attr_class *a = (attr_class *) f;
+      if (dynamic_cast<no_expr_class *>(a->get_init()))
+        continue;
+      g.value(a->get_init(), type_rep(a->get_type_decl()));
+      g.ins("movq", "%rax, " + g.variable(a, a->get_name()));
+    }
+  }
+  g.ins("movq", "%rbx, %rax");
+  g.finish(out, std::string(k->name->get_string()) + "_init", 0);
+}
+
+static void code_method(X86_Cgen &g, ostream &out, X86_Class *k, method_class *m)
+{
+  Formals formals = m->get_formals();
+  int args = formals->len();
+  const Rep_Analysis::Signature *sig = g.signature(m->get_name(), args);
+
+  g.cls = k;
+  g.start();
+  for (int i = formals->first(); formals->more(i); i = formals->next(i)) {
+    formal_class *f = (formal_class *) formals->nth(i);
+    Vm_Rep f_rep = type_rep(f->get_type_decl());
+    std::ostringstream loc;
+    if (f->get_name() == g.self)
+      g.error(m, "'self' cannot be the name of a formal parameter");
+    loc << 16 + 8 * (args - 1 - i) << "(%rbp)";
+    if (f_rep == sig->args[i])
+      g.bind(f->get_name(), loc.str(), f_rep);
+    else {
+      std::string var = g.slot(g.local());
+      g.ins("movq", loc.str() + ", %rax");
+      g.ins("movl", "24(%rax), %eax");
+      g.ins("movq", "%rax, " + var);
+      g.bind(f->get_name(), var, f_rep);
+    }
+  }
+  g.value(m->get_expr(), sig->ret);
+  g.finish(out, std::string(k->name->get_string()) + "." + m->get_name()->get_string(),
+           args);
+}
+
+/////////////////////////////////////////////////////////////////////////
+//
+//  The runtime's side
+//
+//  The built-in methods are stubs that pass self and their arguments on
+//  to the C functions of x86-runtime.c; _int_new, the most common
+//  allocation, bumps the runtime's heap pointer itself.
+//
+/////////////////////////////////////////////////////////////////////////
+
+static const char *prelude =
+  "\t.macro\tCCALL f\n"
+  "\tpushq\t%rbp\n"
+  "\tmovq\t%rsp, %rbp\n"
+  "\tandq\t$-16, %rsp\n"
+  "\tcall\t\\f\n"
+  "\tmovq\t%rbp, %rsp\n"
+  "\tpopq\t%rbp\n"
+  "\t.endm\n"
+  "\n"
+  "\t.text\n"
+  "\t.globl\tcool_start\n"
+  "cool_start:\n"
+  "\tpushq\t%rbx\n"
+  "\tpushq\t%rbp\n"
+  "\tsubq\t$8, %rsp\n"
+  "\txorl\t%ebx, %ebx\n"
+  "\tleaq\tMain_protObj(%rip), %rax\n"
+  "\tcall\tObject.copy\n"
+  "\tcall\tMain_init\n"
+  "\tmovq\t16(%rax), %rcx\n"
+  "\tcall\t*MAIN_SLOT(%rcx)\n"
+  "\taddq\t$8, %rsp\n"
+  "\tpopq\t%rbp\n"
+  "\tpopq\t%rbx\n"
+  "\tret\n"
+  "\n"
+  "# %rax = a new Int of %edi\n"
+  "_int_new:\n"
+  "\tmovq\tcool_heap_next(%rip), %rax\n"
+  "\tleaq\t32(%rax), %rdx\n"
+  "\tcmpq\tcool_heap_limit(%rip), %rdx\n"
+  "\tja\t2f\n"
+  "\tmovq\t%rdx, cool_heap_next(%rip)\n"
+  "1:\tmovq\t$2, (%rax)\n"
+  "\tmovq\t$32, 8(%rax)\n"
+  "\tleaq\tInt_dispTab(%rip), %rdx\n"
+  "\tmovq\t%rdx, 16(%rax)\n"
+  "\tmovslq\t%edi, %rdi\n"
+  "\tmovq\t%rdi, 24(%rax)\n"
+  "\tret\n"
+  "2:\tpushq\t%rdi\n"
+  "\tmovl\t$32, %edi\n"
+  "\tCCALL\tcool_alloc\n"
+  "\tpopq\t%rdi\n"
+  "\tjmp\t1b\n"
+  "\n"
+  "# %eax = 1 if %rdi = %rsi, else 0\n"
+  "_equal:\n"
+  "\tCCALL\tcool_equal\n"
+  "\tret\n"
+  "\n"
+  "# Runtime errors at file %rdi, line %esi\n"
+  "_dispatch_void:\n"
+  "\tCCALL\tcool_dispatch_void\n"
+  "_case_void:\n"
+  "\tCCALL\tcool_case_void\n"
+  "_case_abort:\n"
+  "\tCCALL\tcool_case_abort\n"
+  "_divide_by_zero:\n"
+  "\tCCALL\tcool_divide_by_zero\n"
+  "_stack_overflow:\n"
+  "\tCCALL\tcool_stack_overflow\n"
+  "\n"
+  "Object_init:\n"
+  "IO_init:\n"
+  "Int_init:\n"
+  "Bool_init:\n"
+  "String_init:\n"
+  "\tret\n"
+  "\n"
+  "Object.abort:\n"
+  "\tmovq\t%rax, %rdi\n"
+  "\tCCALL\tcool_abort\n"
+  "\n"
+  "Object.type_name:\n"
+  "\tmovq\t(%rax), %rcx\n"
+  "\tleaq\tclass_nameTab(%rip), %rdx\n"
+  "\tmovq\t(%rdx,%rcx,8), %rax\n"
+  "\tret\n"
+  "\n"
+  "Object.copy:\n"
+  "\tmovq\t%rax, %rdi\n"
+  "\tCCALL\tcool_copy\n"
+  "\tret\n"
+  "\n"
+  "IO.out_string:\n"
+  "\tmovq\t%rax, %rdi\n"
+  "\tmovq\t8(%rsp), %rsi\n"
+  "\tCCALL\tcool_out_string\n"
+  "\tret\t$8\n"
+  "\n"
+  "IO.out_int:\n"
+  "\tmovq\t%rax, %rdi\n"
+  "\tmovq\t8(%rsp), %rsi\n"
+  "\tCCALL\tcool_out_int\n"
+  "\tret\t$8\n"
+  "\n"
+  "IO.in_string:\n"
+  "\tCCALL\tcool_in_string\n"
+  "\tret\n"
+  "\n"
+  "IO.in_int:\n"
+  "\tCCALL\tcool_in_int\n"
+  "\tmovl\t%eax, %edi\n"
+  "\tjmp\t_int_new\n"
+  "\n"
+  "String.length:\n"
+  "\tmovl\t24(%rax), %edi\n"
+  "\tjmp\t_int_new\n"
+  "\n"
+  "String.concat:\n"
+  "\tmovq\t%rax, %rdi\n"
+  "\tmovq\t8(%rsp), %rsi\n"
+  "\tCCALL\tcool_concat\n"
+  "\tret\t$8\n"
+  "\n"
+  "String.substr:\n"
+  "\tmovq\t%rax, %rdi\n"
+  "\tmovq\t16(%rsp), %rsi\n"
+  "\tmovq\t8(%rsp), %rdx\n"
+  "\tCCALL\tcool_substr\n"
+  "\tret\t$16\n"
+  "\n";
+
+// A string as the operand of .ascii.
+static std::string quoted(const std::string &str)
+{
+  std::string q = "\"";
+  for (size_t i = 0; i < str.size(); i++) {
+    unsigned char c = str[i];
+    if (c == '"' || c == '\\') {
+      q += '\\';
+      q += c;
+    }
+    else if (c >= ' ' && c < 127)
+      q += c;
+    else {
+      char octal[8];
+      snprintf(octal, sizeof(octal), "\\%03o", c);
+      q += octal;
+    }
+  }
+  return q + "\"";
+}
+
+static void string_object(ostream &out, const std::string &label, const std::string &str)
+{
+  out << "\t.align\t8\n"
+      << label << ":\n"
+      << "\t.quad\t" << X86_STRING_TAG << ", " << 32 + (str.size() + 8) / 8 * 8
+      << ", String_dispTab, " << str.size() << "\n"
+      << "\t.ascii\t" << quoted(str) << "\n"
+      << "\t.byte\t0\n";
+}
+
+void X86_Cgen::emit_data(ostream &out)
+{
+  out << "\t.data\n";
+  for (size_t i = 0; i < classes.size(); i++)
+    string_const(classes[i]->name->get_string());
+  string_const("");
+  int_const(0);
+
+  // The prototypes, and the tables by tag.
+  for (size_t i = 0; i < classes.size(); i++) {
+    X86_Class *k = classes[i];
+    std::string name = k->name->get_string();
+    out << "\t.align\t8\n" << name << "_protObj:\n"
+        << "\t.quad\t" << k->tag << ", ";
+    switch (k->tag) {
+    case X86_INT_TAG: case X86_BOOL_TAG:
+      out << "32, " << name << "_dispTab, 0\n";
+      break;
+    case X86_STRING_TAG:
+      out << "40, String_dispTab, 0, 0\n";
+      break;
+    default:
+      out << 24 + 8 * k->attr_types.size() << ", " << name << "_dispTab\n";
+      for (size_t j = 0; j < k->attr_types.size(); j++) {
+        Symbol type = k->attr_types[j];
+        out << "\t.quad\t";
+        if (type == classes[X86_STRING_TAG]->name)
+          out << string_const("");
+        else
+          out << 0;
+        out << "\n";
+      }
+    }
+  }
+  out << "\t.align\t8\n\t.globl\tclass_nameTab\nclass_nameTab:\n";
+  for (size_t i = 0; i < classes.size(); i++)
+    out << "\t.quad\t" << string_const(classes[i]->name->get_string()) << "\n";
+  out << "class_objTab:\n";
+  for (size_t i = 0; i < classes.size(); i++)
+    out << "\t.quad\t" << classes[i]->name << "_protObj, "
+        << classes[i]->name << "_init\n";
+  out << "class_parentTab:\n";
+  for (size_t i = 0; i < classes.size(); i++)
+    out << "\t.quad\t" << (classes[i]->parent ? classes[i]->parent->tag : -1) << "\n";
+
+  // For the collector, which attributes of each class hold objects.
+  out << "\t.globl\tclass_attrTab\nclass_attrTab:\n";
+  for (size_t i = 0; i < classes.size(); i++)
+    out << "\t.quad\t" << classes[i]->name << "_attrMap\n";
+  for (size_t i = 0; i < classes.size(); i++) {
+    X86_Class *k = classes[i];
+    out << k->name << "_attrMap:\n";
+    if (!k->attr_types.empty()) {
+      out << "\t.byte\t";
+      for (size_t j = 0; j < k->attr_types.size(); j++)
+        out << (j ? ", " : "") << (type_rep(k->attr_types[j]) == REP_BOXED);
+      out << "\n";
+    }
+  }
+  out << "\t.align\t8\n";
+
+  // The dispatch tables, by selector.
+  for (size_t i = 0; i < classes.size(); i++) {
+    X86_Class *k = classes[i];
+    if (k->tag == X86_INT_TAG || k->tag == X86_STRING_TAG)
+      out << "\t.globl\t" << k->name << "_dispTab\n";
+    out << k->name << "_dispTab:\n";
+    for (size_t j = 0; j < selectors.size(); j++) {
+      if (j < k->methods.size() && !k->methods[j].empty())
+        out << "\t.quad\t" << k->methods[j] << "\n";
+      else
+        out << "\t.quad\t_no_method" << j << "\n";
+    }
+  }
+
+  out << "\t.align\t8\n"
+      << "bool_const0:\n"
+      << "\t.quad\t" << X86_BOOL_TAG << ", 32, Bool_dispTab, 0\n"
+      << "bool_const1:\n"
+      << "\t.quad\t" << X86_BOOL_TAG << ", 32, Bool_dispTab, 1\n";
+  for (std::map<int, std::string>::iterator i = int_consts.begin();
+       i != int_consts.end(); i++)
+    out << i->second << ":\n"
+        << "\t.quad\t" << X86_INT_TAG << ", 32, Int_dispTab, " << i->first << "\n";
+  for (std::map<std::string, std::string>::iterator i = string_consts.begin();
+       i != string_consts.end(); i++)
+    string_object(out, i->second, i->first);
+
+  out << "\t.section\t.rodata\n";
+  for (size_t i = 0; i < selectors.size(); i++)
+    out << "selector_name" << i << ":\n"
+        << "\t.asciz\t" << quoted(selectors[i].first->get_string()) << "\n";
+  for (std::map<Symbol, std::string>::iterator i = file_names.begin();
+       i != file_names.end(); i++)
+    out << i->second << ":\n"
+        << "\t.asciz\t" << quoted(i->first->get_string()) << "\n";
+  out << "\t.section\t.note.GNU-stack,\"\",@progbits\n";
+}
+
+void x86_cgen(Program p, ostream &out)
+{
+  Classes program_classes = p->get_classes();
+  std::unordered_map<Symbol, Class_Source *> sources;
+  std::vector<Class_Source> order(program_classes->len());
+  X86_Cgen g;
+
+  basic_classes(g);
+  g.cls = g.classes[X86_OBJECT_TAG];
+
+  for (int i = program_classes->first(); program_classes->more(i);
+       i = program_classes->next(i)) {
+    Class_ t = program_classes->nth(i);
+    X86_Class *k = new X86_Class();
+    k->name = t->get_name();
+    k->filename = t->get_filename();
+    g.cls = k;
+    if (k->name == g.SELF_TYPE || g.class_named.count(k->name))
+      g.error(t, "Redefinition of basic class", k->name);
+    if (sources.count(k->name))
+      g.error(t, "Class was previously defined:", k->name);
+    order[i].tree = t;
+    order[i].cls = k;
+    order[i].state = 0;
+    sources[k->name] = &order[i];
+  }
+  for (size_t i = 0; i < order.size(); i++)
+    lay_out(g, &order[i], sources);
+  for (size_t i = 0; i < order.size(); i++)
+    g.class_named[order[i].cls->name] = order[i].cls;
+
+  // The signatures, from the built-in methods and the program's.
+  for (int i = X86_OBJECT_TAG; i <= X86_STRING_TAG; i++) {
+    X86_Class *k = g.classes[i];
+    for (std::unordered_map<Symbol, int>::iterator j = k->method_names.begin();
+         j != k->method_names.end(); j++)
+      g.declare(j->first, std::vector<Vm_Rep>(k->method_args[j->second], REP_BOXED),
+                REP_BOXED);
+  }
+  for (size_t i = 0; i < order.size(); i++) {
+    Features features = order[i].tree->get_features();
+    for (int j = features->first(); features->more(j); j = features->next(j)) {
+      if (!features->nth(j)->is_method())
+        continue;
+      method_class *m = (method_class *) features->nth(j);
+      Formals formals = m->get_formals();
+      std::vector<Vm_Rep> args;
+      for (int f = formals->first(); formals->more(f); f = formals->next(f))
+        args.push_back(type_rep(((formal_class *) formals->nth(f))->get_type_decl()));
+      g.declare(m->get_name(), args, type_rep(m->get_return_type()));
+    }
+  }
+
+  Symbol Main = idtable.add_string("Main");
+  Symbol main = idtable.add_string("main");
+  if (!sources.count(Main)) {
+    cerr << "Class Main is not defined." << endl;
+    exit(1);
+  }
+  if (!sources[Main]->cls->method_names.count(main)) {
+    cerr << "No 'main' method in class Main." << endl;
+    exit(1);
+  }
+
+  out << "# Compiled from Cool by parser -native; link with x86-runtime.c.\n"
+      << "\t.set\tMAIN_SLOT, " << 8 * g.selector(main, 0) << "\n"
+      << prelude;
+  for (size_t i = 0; i < order.size(); i++) {
+    X86_Class *k = order[i].cls;
+    Features features = order[i].tree->get_features();
+    code_init(g, out, k);
+    for (int j = features->first(); features->more(j); j = features->next(j))
+      if (features->nth(j)->is_method())
+        code_method(g, out, k, (method_class *) features->nth(j));
+  }
+  for (size_t i = 0; i < g.selectors.size(); i++)
+    out << "_no_method" << i << ":\n"
+        << "\tmovq\t%rax, %rdi\n"
+        << "\tleaq\tselector_name" << i << "(%rip), %rsi\n"
+        << "\tCCALL\tcool_no_method\n";
+  g.emit_data(out);
+}
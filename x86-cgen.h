@@ -0,0 +1,41 @@
+#ifndef X86_CGEN_H
+#define X86_CGEN_H
+
+//
+// x86-cgen.h
+//
+//  Compiling a Cool program to x86-64 assembly (-native), for the GNU
+//  assembler, to be linked with the C runtime of x86-runtime.c:
+//
+//      parser -native -o foo.s foo.cl && gcc foo.s x86-runtime.c -o foo
+//
+//  Objects are laid out as in the Cool runtime system, in quads: the
+//  class tag, the size in bytes, the dispatch table, then the attributes
+//  (the value of an Int or Bool; the length and then the characters of
+//  a String).  An attribute declared Int or Bool holds the int itself,
+//  as Ints and Bools are kept unboxed where they need not be objects
+//  (rep.h).  The tags of the basic classes are fixed, as the runtime
+//  knows them; those of the program's classes follow.
+//
+//  The heap is collected by marking and sweeping (x86-runtime.c); as
+//  the stack holds unboxed Ints with nothing to tell them from objects,
+//  it is scanned conservatively and objects are never moved.
+//
+//  Unlike with -run the operands of arithmetic are not checked: the
+//  program is taken to be well typed.  What can only be found out at
+//  run time, a dispatch to void, a case with no branch for the class of
+//  its value or a recursion too deep for the stack, is reported at the
+//  line of the expression.
+//
+
+#include "cool-tree.h"
+
+#define X86_OBJECT_TAG 0
+#define X86_IO_TAG 1
+#define X86_INT_TAG 2
+#define X86_BOOL_TAG 3
+#define X86_STRING_TAG 4
+
+void x86_cgen(Program p, ostream &out);
+
+#endif
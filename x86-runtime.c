@@ -0,0 +1,583 @@
+/*
+ * See copyright.h for copyright notice and limitation of liability
+ * and disclaimer of warranty provisions.
+ */
+
+/*
+ * x86-runtime.c
+ *
+ *  The runtime of the code of parser -native (x86-cgen.h): the heap,
+ *  the built-in methods that need the C library, and the errors only
+ *  found at run time, with the messages of -run.
+ *
+ *  The heap is a list of chunks, collected by marking and sweeping.
+ *  Objects are bumped out of a hole, a free run of a chunk, from
+ *  cool_heap_next up to cool_heap_limit; the generated code bumps
+ *  cool_heap_next itself for an Int, and calls cool_alloc when the hole
+ *  is full.  cool_alloc goes on to the next hole, and when there are
+ *  none left either collects or adds a chunk: it collects once the heap
+ *  is twice the size of what the last collection left, so that the time
+ *  spent collecting stays in proportion to what is allocated.
+ *
+ *  The generated code keeps Ints and Bools unboxed on the stack with
+ *  nothing to say which words they are, so the stack, and the registers
+ *  of the C code under cool_alloc, are scanned conservatively: any word
+ *  that points into an object keeps it.  Objects are therefore never
+ *  moved.  Their attributes are scanned precisely, by the table of
+ *  which attributes of each class hold objects (class_attrTab).  The
+ *  sweep makes each run of dead objects a hole, headed by a filler so
+ *  that a chunk can still be walked object by object.
+ *
+ *  With COOL_GC_TEST set in the environment, as with parser -run -t -T,
+ *  every allocation collects, the heap is checked after each collection
+ *  and the holes are filled with garbage, so that a missing root shows
+ *  up soon.
+ *
+ *  Each call checks the stack against cool_stack_limit first, so that a
+ *  recursion too deep is reported as it is by -run.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/resource.h>
+
+/* The tags of the basic classes, as in x86-cgen.h */
+#define X86_INT_TAG 2
+#define X86_BOOL_TAG 3
+#define X86_STRING_TAG 4
+
+#define HEAP_CHUNK (1 << 20)
+#define HEAP_MIN (4 << 20)      /* collect no smaller a heap than this */
+#define STACK_MAX (256 << 20)   /* if the stack is unlimited */
+#define STACK_MARGIN (256 << 10) /* left for the C code */
+#define GC_GARBAGE 0xdb
+
+/* The tags of the fillers of free space: one of 8 bytes, or a longer
+   one with its size where an object has it. */
+#define FILLER8_TAG (-2)
+#define FILLER_TAG (-1)
+
+typedef struct Object {
+  int64_t tag;
+  int64_t size;                 /* in bytes */
+  void *disp;
+  int64_t attr[];
+} Object;
+
+typedef struct String {
+  int64_t tag;
+  int64_t size;
+  void *disp;
+  int64_t len;
+  char chars[];                 /* and a null */
+} String;
+
+/* What the generated code provides */
+extern void cool_start(void);
+extern String *class_nameTab[];
+extern unsigned char *class_attrTab[];  /* 1 for each attribute that
+                                           holds an object */
+extern char String_dispTab[];
+
+char *cool_heap_next, *cool_heap_limit;
+char *cool_stack_limit;
+
+/* Errors: the program's output so far is written out first. */
+static void error(const char *filename, int line, const char *msg)
+{
+  fflush(stdout);
+  if (filename)
+    fprintf(stderr, "%s:%d: ", filename, line);
+  fprintf(stderr, "%s\n", msg);
+  exit(1);
+}
+
+static const char *class_name(Object *o)
+{
+  return class_nameTab[o->tag]->chars;
+}
+
+/*
+ * The heap
+ */
+
+typedef struct Chunk {
+  char *start, *end;
+  unsigned char *starts;        /* a bit for each 8 bytes: an object starts */
+  unsigned char *marks;         /*   there, and it has been marked */
+} Chunk;
+
+typedef struct Hole {
+  char *start, *end;
+} Hole;
+
+static Chunk *chunks;           /* by address */
+static size_t nchunks, chunks_cap;
+static Hole *holes;             /* left by the last sweep, in order */
+static size_t nholes, holes_cap, next_hole;
+static char *hole_limit;        /* the end of the hole cool_heap_next is in */
+static size_t heap_size, gc_threshold = HEAP_MIN;
+static Object **mark_stack;
+static size_t mark_top, mark_cap;
+static char *stack_base;        /* main's frame */
+static int gc_test;             /* COOL_GC_TEST */
+
+#define BIT(map, i) ((map)[(i) >> 3] >> ((i) & 7) & 1)
+#define SET_BIT(map, i) ((map)[(i) >> 3] |= 1 << ((i) & 7))
+#define CLEAR_BIT(map, i) ((map)[(i) >> 3] &= ~(1 << ((i) & 7)))
+
+static void *alloc_or_die(void *p, size_t size)
+{
+  p = realloc(p, size);
+  if (p == NULL)
+    error(NULL, 0, "out of memory");
+  return p;
+}
+
+/* Make room in an array for one more of its n elements. */
+static void *grow(void *array, size_t n, size_t *cap, size_t elem)
+{
+  if (n < *cap)
+    return array;
+  *cap = *cap ? 2 * *cap : 64;
+  return alloc_or_die(array, *cap * elem);
+}
+
+/* Make [p, end) free space, that a walk of its chunk steps over. */
+static void fill(char *p, char *end)
+{
+  if (end - p == 8)
+    *(int64_t *) p = FILLER8_TAG;
+  else if (end > p) {
+    ((int64_t *) p)[0] = FILLER_TAG;
+    ((int64_t *) p)[1] = end - p;
+  }
+}
+
+/* The size of the object or filler at p */
+static size_t size_at(char *p)
+{
+  return *(int64_t *) p == FILLER8_TAG ? 8 : (size_t) ((int64_t *) p)[1];
+}
+
+static Chunk *chunk_of(char *p)
+{
+  size_t lo = 0, hi = nchunks;
+
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (p < chunks[mid].start)
+      hi = mid;
+    else if (p >= chunks[mid].end)
+      lo = mid + 1;
+    else
+      return &chunks[mid];
+  }
+  return NULL;
+}
+
+/*
+ * Mark the object p points to, if it is in the heap.  A root may point
+ * anywhere into an object, as the C code may keep only a pointer to
+ * its characters; an attribute points to its start.
+ */
+static void mark(char *p, int interior)
+{
+  Chunk *c = chunk_of(p);
+  size_t i;
+  Object *o;
+
+  if (c == NULL)
+    return;
+  i = (p - c->start) / 8;
+  if (!interior) {
+    if ((p - c->start) % 8 != 0 || !BIT(c->starts, i))
+      error(NULL, 0, "GC check: bad pointer in an object");
+  }
+  else
+    for (;;) {
+      unsigned bits = c->starts[i >> 3] & ((2u << (i & 7)) - 1);
+      if (bits) {
+        i = (i & ~(size_t) 7) + 31 - __builtin_clz(bits);
+        break;
+      }
+      if (i < 8)
+        return;
+      i = (i & ~(size_t) 7) - 1;
+    }
+  o = (Object *) (c->start + 8 * i);
+  if (p >= (char *) o + o->size || BIT(c->marks, i))
+    return;
+  SET_BIT(c->marks, i);
+  mark_stack = grow(mark_stack, mark_top, &mark_cap, sizeof(Object *));
+  mark_stack[mark_top++] = o;
+}
+
+/* Mark what the attributes of o hold. */
+static void scan(Object *o)
+{
+  unsigned char *boxed;
+  int64_t i, n;
+
+  if (o->tag == X86_INT_TAG || o->tag == X86_BOOL_TAG || o->tag == X86_STRING_TAG)
+    return;
+  boxed = class_attrTab[o->tag];
+  n = (o->size - sizeof(Object)) / 8;
+  for (i = 0; i < n; i++)
+    if (boxed[i])
+      mark((char *) o->attr[i], 0);
+}
+
+/*
+ * The roots: the callee-saved registers, and the stack from here up to
+ * main's frame, which holds the generated code's frames and anything
+ * else the C code under cool_alloc has saved.
+ */
+static void __attribute__((noinline)) mark_roots(void)
+{
+  char *regs[6];
+  char **p;
+
+  __asm__ volatile("movq\t%%rbx, 0(%0)\n\t"
+                   "movq\t%%rbp, 8(%0)\n\t"
+                   "movq\t%%r12, 16(%0)\n\t"
+                   "movq\t%%r13, 24(%0)\n\t"
+                   "movq\t%%r14, 32(%0)\n\t"
+                   "movq\t%%r15, 40(%0)"
+                   : : "r" (regs) : "memory");
+  for (p = regs; p < regs + 6; p++)
+    mark(*p, 1);
+  for (p = __builtin_frame_address(0); p < (char **) stack_base; p++)
+    mark(*p, 1);
+}
+
+static void add_hole(char *start, char *end)
+{
+  fill(start, end);
+  if (gc_test && end - start > 16)
+    memset(start + 16, GC_GARBAGE, end - start - 16);
+  if (end - start < (int64_t) sizeof(Object))
+    return;
+  holes = grow(holes, nholes, &holes_cap, sizeof(Hole));
+  holes[nholes].start = start;
+  holes[nholes].end = end;
+  nholes++;
+}
+
+/*
+ * Make each run of unmarked objects a hole, and give back the chunks
+ * of big strings that are no longer used.  Returns the bytes left.
+ */
+static size_t sweep(void)
+{
+  size_t live = 0, k, kept = 0;
+
+  nholes = next_hole = 0;
+  for (k = 0; k < nchunks; k++) {
+    Chunk *c = &chunks[k];
+    char *p = c->start, *free_from = NULL;
+
+    while (p < c->end) {
+      size_t size = size_at(p), i = (p - c->start) / 8;
+      if (BIT(c->marks, i)) {
+        if (free_from)
+          add_hole(free_from, p);
+        free_from = NULL;
+        live += size;
+      }
+      else {
+        CLEAR_BIT(c->starts, i);
+        if (!free_from)
+          free_from = p;
+      }
+      p += size;
+    }
+    if (free_from == c->start && c->end - c->start > HEAP_CHUNK) {
+      heap_size -= c->end - c->start;
+      free(c->start);
+      free(c->starts);
+      free(c->marks);
+      continue;
+    }
+    if (free_from)
+      add_hole(free_from, c->end);
+    chunks[kept++] = *c;
+  }
+  nchunks = kept;
+  return live;
+}
+
+/* With COOL_GC_TEST: every attribute points to a live object, or out of the heap. */
+static void check_heap(void)
+{
+  size_t k;
+
+  for (k = 0; k < nchunks; k++) {
+    char *p;
+    for (p = chunks[k].start; p < chunks[k].end; p += size_at(p))
+      if (*(int64_t *) p >= 0)
+        scan((Object *) p);
+  }
+  mark_top = 0;
+}
+
+static void collect(void)
+{
+  size_t k;
+
+  fill(cool_heap_next, hole_limit);
+  cool_heap_next = cool_heap_limit = hole_limit = NULL;
+  for (k = 0; k < nchunks; k++) {
+    Chunk *c = &chunks[k];
+    size_t bytes = (c->end - c->start) / 64 + 1;
+    char *p;
+    memset(c->starts, 0, bytes);
+    memset(c->marks, 0, bytes);
+    for (p = c->start; p < c->end; p += size_at(p))
+      if (*(int64_t *) p >= 0)
+        SET_BIT(c->starts, (p - c->start) / 8);
+  }
+  mark_roots();
+  while (mark_top > 0)
+    scan(mark_stack[--mark_top]);
+  size_t live = sweep();
+  if (gc_test)
+    check_heap();
+  gc_threshold = 2 * live > HEAP_MIN ? 2 * live : HEAP_MIN;
+}
+
+/* Bump out of the next hole that has room for size bytes. */
+static int take_hole(size_t size)
+{
+  fill(cool_heap_next, hole_limit);
+  cool_heap_next = hole_limit = NULL;
+  while (next_hole < nholes) {
+    Hole *h = &holes[next_hole++];
+    if ((size_t) (h->end - h->start) >= size) {
+      cool_heap_next = h->start;
+      hole_limit = h->end;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static void new_chunk(size_t size)
+{
+  size_t bytes = size > HEAP_CHUNK ? size : HEAP_CHUNK, k;
+  Chunk c;
+
+  c.start = alloc_or_die(NULL, bytes);
+  c.end = c.start + bytes;
+  c.starts = alloc_or_die(NULL, bytes / 64 + 1);
+  c.marks = alloc_or_die(NULL, bytes / 64 + 1);
+  chunks = grow(chunks, nchunks, &chunks_cap, sizeof(Chunk));
+  for (k = nchunks; k > 0 && chunks[k - 1].start > c.start; k--)
+    chunks[k] = chunks[k - 1];
+  chunks[k] = c;
+  nchunks++;
+  heap_size += bytes;
+
+  fill(cool_heap_next, hole_limit);
+  cool_heap_next = c.start;
+  hole_limit = c.end;
+}
+
+void *cool_alloc(size_t size)
+{
+  char *p;
+
+  size = (size + 7) & ~(size_t) 7;
+  if (gc_test)
+    collect();
+  if ((size_t) (hole_limit - cool_heap_next) < size && !take_hole(size)) {
+    if (heap_size >= gc_threshold)
+      collect();
+    if (!take_hole(size))
+      new_chunk(size);
+  }
+  p = cool_heap_next;
+  cool_heap_next += size;
+  cool_heap_limit = gc_test ? cool_heap_next : hole_limit;
+  return p;
+}
+
+static String *new_string(const char *chars, int64_t len)
+{
+  int64_t size = sizeof(String) + (len + 8) / 8 * 8;
+  String *s = cool_alloc(size);
+
+  s->tag = X86_STRING_TAG;
+  s->size = size;
+  s->disp = String_dispTab;
+  s->len = len;
+  if (chars)
+    memcpy(s->chars, chars, len);
+  memset(s->chars + len, 0, size - sizeof(String) - len);
+  return s;
+}
+
+/* Cool's =: the same object, or Ints, Bools or strings of equal value. */
+int cool_equal(Object *x, Object *y)
+{
+  int same = x == y;
+
+  if (!same && x && y && x->tag == y->tag) {
+    switch (x->tag) {
+    case X86_INT_TAG:
+    case X86_BOOL_TAG:
+      same = x->attr[0] == y->attr[0];
+      break;
+    case X86_STRING_TAG:
+      same = ((String *) x)->len == ((String *) y)->len &&
+        memcmp(((String *) x)->chars, ((String *) y)->chars,
+               ((String *) x)->len) == 0;
+      break;
+    }
+  }
+  return same;
+}
+
+void cool_dispatch_void(const char *filename, int line)
+{
+  error(filename, line, "Dispatch to void.");
+}
+
+void cool_case_void(const char *filename, int line)
+{
+  error(filename, line, "Match on void in case statement.");
+}
+
+void cool_case_abort(const char *filename, int line, Object *o)
+{
+  char msg[1024];
+
+  snprintf(msg, sizeof(msg), "No match in case statement for Class %s.",
+           class_name(o));
+  error(filename, line, msg);
+}
+
+void cool_divide_by_zero(const char *filename, int line)
+{
+  error(filename, line, "Division by zero.");
+}
+
+void cool_stack_overflow(const char *filename, int line)
+{
+  error(filename, line, "Stack overflow.");
+}
+
+void cool_no_method(Object *self, const char *name)
+{
+  char msg[1024];
+
+  snprintf(msg, sizeof(msg), "Undefined method %s in class %s.", name,
+           class_name(self));
+  error(NULL, 0, msg);
+}
+
+/* The built-in methods */
+
+void cool_abort(Object *self)
+{
+  fflush(stdout);
+  fprintf(stderr, "Abort called from class %s\n", class_name(self));
+  exit(1);
+}
+
+Object *cool_copy(Object *self)
+{
+  Object *copy;
+
+  if (self->tag == X86_BOOL_TAG)        /* one of the two Bools */
+    return self;
+  copy = cool_alloc(self->size);
+  memcpy(copy, self, self->size);
+  return copy;
+}
+
+Object *cool_out_string(Object *self, String *s)
+{
+  fwrite(s->chars, 1, s->len, stdout);
+  return self;
+}
+
+Object *cool_out_int(Object *self, Object *i)
+{
+  printf("%d", (int) i->attr[0]);
+  return self;
+}
+
+/*
+ * A line of input, without its newline.  The program's output is
+ * written out first, in case it is a prompt.
+ */
+static char *read_line(ssize_t *len)
+{
+  static char *line;
+  static size_t cap;
+  ssize_t n;
+
+  fflush(stdout);
+  n = getline(&line, &cap, stdin);
+  if (n <= 0) {
+    *len = 0;
+    return "";
+  }
+  if (line[n - 1] == '\n')
+    line[--n] = '\0';
+  *len = n;
+  return line;
+}
+
+String *cool_in_string(void)
+{
+  ssize_t len;
+  char *line = read_line(&len);
+
+  if ((ssize_t) strlen(line) != len)    /* a null in the line */
+    len = 0;
+  return new_string(line, len);
+}
+
+int cool_in_int(void)
+{
+  ssize_t len;
+  return (int) strtol(read_line(&len), NULL, 10);
+}
+
+String *cool_concat(String *s, String *t)
+{
+  String *r = new_string(NULL, s->len + t->len);
+
+  memcpy(r->chars, s->chars, s->len);
+  memcpy(r->chars + s->len, t->chars, t->len);
+  return r;
+}
+
+String *cool_substr(String *s, Object *i, Object *l)
+{
+  int64_t start = (int) i->attr[0], len = (int) l->attr[0];
+
+  if (start < 0 || len < 0 || start > s->len || len > s->len - start)
+    error(NULL, 0, "Index to substr is out of range");
+  return new_string(s->chars + start, len);
+}
+
+int main(void)
+{
+  struct rlimit rl;
+  size_t stack = STACK_MAX;
+
+  stack_base = __builtin_frame_address(0);
+  if (getrlimit(RLIMIT_STACK, &rl) == 0 && rl.rlim_cur != RLIM_INFINITY &&
+      rl.rlim_cur < STACK_MAX)
+    stack = rl.rlim_cur;
+  cool_stack_limit = stack_base - stack + STACK_MARGIN;
+  gc_test = getenv("COOL_GC_TEST") != NULL;
+  cool_start();
+  fflush(stdout);
+  return 0;
+}